@@ -3,3 +3,4 @@ using System.Runtime.CompilerServices;
 
 [assembly:InternalsVisibleTo("MonoGame.Effect")]
 [assembly:InternalsVisibleTo("MonoGame.Tools.Tests")]
+[assembly:InternalsVisibleTo("mgcb")]
@@ -0,0 +1,66 @@
+//-----------------------------------------------------------------------------
+// YUVToRGBEffect.fx
+//
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+//-----------------------------------------------------------------------------
+
+#include "Macros.fxh"
+
+
+// This isn't built into the framework like the other effects
+// here, so games add it to their content to use planar video.
+//
+// The planes from a planar video decoder.  Each is an Alpha8
+// texture and the chroma planes can be smaller than the luma.
+DECLARE_TEXTURE(Texture, 0);
+DECLARE_TEXTURE(TextureU, 1);
+DECLARE_TEXTURE(TextureV, 2);
+
+
+BEGIN_CONSTANTS
+MATRIX_CONSTANTS
+
+    float4x4 MatrixTransform    _vs(c0) _cb(c0);
+
+END_CONSTANTS
+
+
+struct VSOutput
+{
+	float4 position		: SV_Position;
+	float4 color		: COLOR0;
+    float2 texCoord		: TEXCOORD0;
+};
+
+VSOutput SpriteVertexShader(	float4 position	: POSITION0,
+								float4 color	: COLOR0,
+								float2 texCoord	: TEXCOORD0)
+{
+	VSOutput output;
+    output.position = mul(position, MatrixTransform);
+	output.color = color;
+	output.texCoord = texCoord;
+	return output;
+}
+
+
+// BT.601 video range which is what Theora and most H.264 use.
+float4 YUVPixelShader(VSOutput input) : SV_Target0
+{
+    float y = SAMPLE_TEXTURE(Texture, input.texCoord).a - (16.0 / 255.0);
+    float u = SAMPLE_TEXTURE(TextureU, input.texCoord).a - (128.0 / 255.0);
+    float v = SAMPLE_TEXTURE(TextureV, input.texCoord).a - (128.0 / 255.0);
+
+    y *= 1.164;
+
+    float3 rgb;
+    rgb.r = y + (1.596 * v);
+    rgb.g = y - (0.392 * u) - (0.813 * v);
+    rgb.b = y + (2.017 * u);
+
+    return float4(saturate(rgb), 1) * input.color;
+}
+
+TECHNIQUE( SpriteBatch, SpriteVertexShader, YUVPixelShader );
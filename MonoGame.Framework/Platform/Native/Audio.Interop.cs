@@ -88,6 +88,18 @@ internal static unsafe partial class MGA
     [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGA_System_SetReverbSettings", ExactSpelling = true)]
     public static extern void System_SetReverbSettings(MGA_System* system, in ReverbSettings settings);
 
+    /// <summary>
+    /// Sets how many of the most audible voices are mixed, the rest play silently.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGA_System_SetVoiceBudget", ExactSpelling = true)]
+    public static extern void System_SetVoiceBudget(MGA_System* system, int voices);
+
+    /// <summary>
+    /// Returns how many voices were playing and how many of those were mixed in the last block.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGA_System_GetVoiceStats", ExactSpelling = true)]
+    public static extern void System_GetVoiceStats(MGA_System* system, out int playing, out int mixed);
+
     #endregion
 
     #region Buffer
@@ -131,6 +143,12 @@ internal static unsafe partial class MGA
         int loopStart,
         int loopLength);
 
+    /// <summary>
+    /// Uses decoded PCM from the cache which the buffer holds a reference to until it is destroyed.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGA_Buffer_InitializeCached", ExactSpelling = true)]
+    public static extern void Buffer_InitializeCached(MGA_Buffer* buffer, MGM_PCMBlock* block);
+
     [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGA_Buffer_GetDuration", ExactSpelling = true)]
     public static extern ulong Buffer_GetDuration(MGA_Buffer* buffer);
 
@@ -180,6 +198,12 @@ internal static unsafe partial class MGA
     [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGA_Voice_SetVolume", ExactSpelling = true)]
     public static extern void Voice_SetVolume(MGA_Voice* voice, float volume);
 
+    /// <summary>
+    /// Scales how audible the voice is considered when picking which voices to mix, 1 by default.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGA_Voice_SetPriority", ExactSpelling = true)]
+    public static extern void Voice_SetPriority(MGA_Voice* voice, float priority);
+
     [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGA_Voice_SetReverbMix", ExactSpelling = true)]
     public static extern void Voice_SetReverbMix(MGA_Voice* voice, float mix);
 
@@ -192,6 +216,12 @@ internal static unsafe partial class MGA
     [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGA_Voice_Apply3D", ExactSpelling = true)]
     public static extern void Voice_Apply3D(MGA_Voice* voice, in Listener listener, in Emitter emitter, float distanceScale);
 
+    /// <summary>
+    /// Applies 3D positioning to each voice from the matching emitter, all around the one listener.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGA_Voice_Apply3DBatch", ExactSpelling = true)]
+    public static extern void Voice_Apply3DBatch(MGA_Voice** voices, Emitter* emitters, int count, in Listener listener, float distanceScale);
+
     #endregion
 }
 
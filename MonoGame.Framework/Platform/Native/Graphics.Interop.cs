@@ -27,6 +27,8 @@ internal struct PtrTo<T>
 [MGHandle] internal readonly struct MGG_Shader { }
 [MGHandle] internal readonly struct MGG_InputLayout { }
 [MGHandle] internal readonly struct MGG_OcclusionQuery { }
+[MGHandle] internal readonly struct MGG_Readback { }
+[MGHandle] internal readonly struct MGG_Capture { }
 
 
 [StructLayout(LayoutKind.Sequential)]
@@ -143,6 +145,38 @@ internal enum BufferType
     Constant,
 }
 
+internal enum CaptureFormat
+{
+    Png,
+    Jpg,
+}
+
+[StructLayout(LayoutKind.Sequential)]
+internal unsafe struct MGG_Capture_Result
+{
+    /// <summary>
+    /// The capture number in the order they were queued.
+    /// </summary>
+    public ulong Sequence;
+
+    /// <summary>
+    /// The time passed to MGG_Capture_Update when the frame was queued.
+    /// </summary>
+    public ulong TimeMS;
+
+    public int Width;
+    public int Height;
+
+    /// <summary>
+    /// The encoded image or null if it was written to a file.
+    /// </summary>
+    /// <remarks>This is valid until the next call to MGG_Capture_Poll.</remarks>
+    public byte* Data;
+    public int DataBytes;
+
+    public byte Succeeded;
+}
+
 
 internal static unsafe partial class MGG
 {
@@ -383,6 +417,99 @@ internal static unsafe partial class MGG
 
     #endregion
 
+    #region Readback
+
+    /// <summary>
+    /// Creates a persistently mapped buffer for asynchronous texture readback.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGG_Readback_Create", ExactSpelling = true)]
+    public static extern MGG_Readback* Readback_Create(MGG_GraphicsDevice* device, int dataBytes);
+
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGG_Readback_Destroy", ExactSpelling = true)]
+    public static extern void Readback_Destroy(MGG_GraphicsDevice* device, MGG_Readback* readback);
+
+    /// <summary>
+    /// Records a copy of the texture into the current frame without stalling it.
+    /// </summary>
+    /// <remarks>A null texture copies the current backbuffer.</remarks>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGG_Readback_Queue", ExactSpelling = true)]
+    public static extern void Readback_Queue(
+        MGG_GraphicsDevice* device,
+        MGG_Readback* readback,
+        MGG_Texture* texture,
+        int level,
+        int slice,
+        int x,
+        int y,
+        int width,
+        int height);
+
+    /// <summary>
+    /// Returns true once the GPU has finished the copy.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGG_Readback_GetData", ExactSpelling = true)]
+    public static extern byte Readback_GetData(
+        MGG_GraphicsDevice* device,
+        MGG_Readback* readback,
+        out byte* data,
+        out int dataBytes,
+        out SurfaceFormat format);
+
+    #endregion
+
+    #region Capture
+
+    /// <summary>
+    /// Creates a capture pipeline which reads back frames and encodes them on worker threads.
+    /// </summary>
+    /// <param name="device">The graphics device.</param>
+    /// <param name="format">The image format to encode.</param>
+    /// <param name="quality">The JPEG quality from 1 to 100.</param>
+    /// <param name="maxPending">The maximum captures in flight before frames are dropped.</param>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGG_Capture_Create", ExactSpelling = true)]
+    public static extern MGG_Capture* Capture_Create(MGG_GraphicsDevice* device, CaptureFormat format, int quality, int maxPending);
+
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGG_Capture_Destroy", ExactSpelling = true)]
+    public static extern void Capture_Destroy(MGG_Capture* capture);
+
+    /// <summary>
+    /// Request a single capture on the next update.
+    /// </summary>
+    /// <param name="capture">The capture.</param>
+    /// <param name="path">The file to write or null to return the encoded data from MGG_Capture_Poll.</param>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGG_Capture_Request", ExactSpelling = true)]
+    public static extern void Capture_Request(MGG_Capture* capture, string path);
+
+    /// <summary>
+    /// Enables periodic capture for recording.
+    /// </summary>
+    /// <param name="capture">The capture.</param>
+    /// <param name="fps">The captures per second or zero to disable.</param>
+    /// <param name="pathPattern">A pattern with one printf style integer conversion like "frame_%05d.png" for the capture sequence number or null to return the encoded data from MGG_Capture_Poll. Periodic capture stays off for any other pattern.</param>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGG_Capture_SetPeriodic", ExactSpelling = true)]
+    public static extern void Capture_SetPeriodic(MGG_Capture* capture, float fps, string pathPattern);
+
+    /// <summary>
+    /// Call once per frame before present to queue new captures and hand finished readbacks to the encoders.
+    /// </summary>
+    /// <remarks>A null texture captures the backbuffer.</remarks>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGG_Capture_Update", ExactSpelling = true)]
+    public static extern void Capture_Update(MGG_Capture* capture, MGG_Texture* texture, int width, int height, ulong timeMS);
+
+    /// <summary>
+    /// Returns true if a completed capture was returned.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGG_Capture_Poll", ExactSpelling = true)]
+    public static extern byte Capture_Poll(MGG_Capture* capture, out MGG_Capture_Result result);
+
+    /// <summary>
+    /// Returns the number of captures skipped because all the slots were busy.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGG_Capture_GetDroppedCount", ExactSpelling = true)]
+    public static extern int Capture_GetDroppedCount(MGG_Capture* capture);
+
+    #endregion
+
     #region Input Layout
 
     [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGG_InputLayout_Create", ExactSpelling = true)]
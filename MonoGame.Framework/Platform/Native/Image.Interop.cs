@@ -2,12 +2,71 @@
 // This file is subject to the terms and conditions defined in
 // file 'LICENSE.txt', which is part of this source code package.
 
+using System;
 using System.Runtime.InteropServices;
+using Microsoft.Xna.Framework.Graphics;
 
 
 namespace MonoGame.Interop;
 
 
+/// <summary>
+/// Post-decode transforms applied natively in a single pass over the image.
+/// </summary>
+[Flags]
+internal enum ImageReadFlags : byte
+{
+    None = 0,
+
+    /// <summary>
+    /// Set the RGB values to zero for pixels with zero alpha (XNA behavior).
+    /// </summary>
+    ZeroTransparentPixels = 1 << 0,
+
+    /// <summary>
+    /// Premultiply the RGB values by the alpha value.
+    /// </summary>
+    PremultiplyAlpha = 1 << 1,
+
+    /// <summary>
+    /// Return the pixels in BGRA order instead of RGBA.
+    /// </summary>
+    SwizzleBGRA = 1 << 2,
+}
+
+[MGHandle]
+internal readonly struct MGI_Encoder { }
+
+/// <summary>
+/// Describes a texture stored in a DDS or KTX2 container.
+/// </summary>
+internal struct MGI_ContainerInfo
+{
+    public TextureType Type;
+    public SurfaceFormat Format;
+    public int Width;
+    public int Height;
+    public int Depth;
+    public int Mipmaps;
+    public int Slices;
+}
+
+/// <summary>
+/// The location of one level of one slice within the container data.
+/// </summary>
+internal unsafe struct MGI_ContainerLevel
+{
+    public int Level;
+    public int Slice;
+    public int Width;
+    public int Height;
+    public int Depth;
+    public int Offset;
+    public byte* Data;
+    public int DataBytes;
+}
+
+
 /// <summary>
 /// MonoGame native calls for high performance reading and writing of images.
 /// </summary>
@@ -17,11 +76,40 @@ internal static unsafe partial class MGI
     public static extern void ReadRGBA(
         byte* data,
         int dataBytes,
-        byte zeroTransparentPixels,
+        ImageReadFlags flags,
+        out int width,
+        out int height,
+        out byte* rgba);
+
+    /// <summary>
+    /// Decodes at 1/2, 1/4 or 1/8 of the full resolution without holding the full image when possible.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGI_ReadRGBAScaled", ExactSpelling = true)]
+    public static extern void ReadRGBAScaled(
+        byte* data,
+        int dataBytes,
+        ImageReadFlags flags,
+        int scale,
         out int width,
         out int height,
         out byte* rgba);
 
+    /// <summary>
+    /// Parses a DDS or KTX2 container without decoding it.
+    /// </summary>
+    /// <remarks>
+    /// Pass null levels to only read the info, then call again with room for
+    /// Mipmaps * Slices levels indexed by slice * Mipmaps + level.  The level data
+    /// points into the source buffer and can be passed directly to Texture_SetData.
+    /// </remarks>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGI_ReadContainer", ExactSpelling = true)]
+    public static extern byte ReadContainer(
+        byte* data,
+        int dataBytes,
+        out MGI_ContainerInfo info,
+        MGI_ContainerLevel* levels,
+        int levelCount);
+
     [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGI_WriteJpg", ExactSpelling = true)]
     public static extern void WriteJpg(
         byte* data,
@@ -40,6 +128,42 @@ internal static unsafe partial class MGI
         int height,
         out byte* png,
         out int pngBytes);
-}
 
+    /// <summary>
+    /// Creates a reusable encoder whose output buffer persists across calls.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGI_Encoder_Create", ExactSpelling = true)]
+    public static extern MGI_Encoder* Encoder_Create();
+
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGI_Encoder_Destroy", ExactSpelling = true)]
+    public static extern void Encoder_Destroy(MGI_Encoder* encoder);
 
+    /// <summary>
+    /// Encodes a JPEG into the encoder's buffer.
+    /// </summary>
+    /// <remarks>The returned buffer is owned by the encoder and is valid until the next call.</remarks>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGI_Encoder_WriteJpg", ExactSpelling = true)]
+    public static extern void Encoder_WriteJpg(
+        MGI_Encoder* encoder,
+        byte* data,
+        int dataBytes,
+        int width,
+        int height,
+        int quality,
+        out byte* jpg,
+        out int jpgBytes);
+
+    /// <summary>
+    /// Encodes a PNG into the encoder's buffer.
+    /// </summary>
+    /// <remarks>The returned buffer is owned by the encoder and is valid until the next call.</remarks>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGI_Encoder_WritePng", ExactSpelling = true)]
+    public static extern void Encoder_WritePng(
+        MGI_Encoder* encoder,
+        byte* data,
+        int dataBytes,
+        int width,
+        int height,
+        out byte* png,
+        out int pngBytes);
+}
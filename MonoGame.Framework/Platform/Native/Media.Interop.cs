@@ -15,6 +15,12 @@ internal readonly struct MGM_AudioDecoder{ }
 [MGHandle]
 internal readonly struct MGM_VideoDecoder { }
 
+[MGHandle]
+internal readonly struct MGM_AudioStream { }
+
+[MGHandle]
+internal readonly struct MGM_PCMBlock { }
+
 struct MGM_AudioDecoderInfo
 {
     /// <summary>
@@ -97,6 +103,143 @@ internal static unsafe partial class MGM
 
     #endregion
 
+    #region Audio Stream
+
+    /// <summary>
+    /// Starts a thread which keeps a ring of PCM data decoded ahead of playback.
+    /// </summary>
+    /// <param name="decoder">The decoder which must outlive the stream.</param>
+    /// <param name="samplerate">The sample rate of the decoder.</param>
+    /// <param name="channels">The channel count of the decoder.</param>
+    /// <param name="latencyMS">How far ahead in milliseconds to decode.</param>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_AudioStream_Create", ExactSpelling = true)]
+    public static extern MGM_AudioStream* AudioStream_Create(MGM_AudioDecoder* decoder, int samplerate, int channels, int latencyMS);
+
+    /// <summary>
+    /// Stops the decode thread and destroys the stream, but not the decoder.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_AudioStream_Destroy", ExactSpelling = true)]
+    public static extern void AudioStream_Destroy(MGM_AudioStream* stream);
+
+    /// <summary>
+    /// Moves the decoder and drops everything already in the ring.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_AudioStream_Seek", ExactSpelling = true)]
+    public static extern void AudioStream_Seek(MGM_AudioStream* stream, ulong timeMS);
+
+    /// <summary>
+    /// Returns the next decoded PCM data in the ring without copying it.
+    /// </summary>
+    /// <remarks>
+    /// This never blocks.
+    /// </remarks>
+    /// <returns>Returns false if nothing is ready.</returns>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_AudioStream_Acquire", ExactSpelling = true)]
+    public static extern byte AudioStream_Acquire(MGM_AudioStream* stream, out byte* buffer, out uint size);
+
+    /// <summary>
+    /// Hands the space used by acquired data back to the decode thread.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_AudioStream_Release", ExactSpelling = true)]
+    public static extern void AudioStream_Release(MGM_AudioStream* stream, uint size);
+
+    /// <summary>
+    /// Returns true once the decoder has reached the end and the ring is empty.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_AudioStream_IsFinished", ExactSpelling = true)]
+    public static extern byte AudioStream_IsFinished(MGM_AudioStream* stream);
+
+    /// <summary>
+    /// Tells the stream that playback ran out of data.
+    /// </summary>
+    /// <remarks>
+    /// Counts as an underrun if the ring is empty and the decoder isn't waiting on a seek or at the end.
+    /// Calls made before more data is acquired count as the same underrun.
+    /// </remarks>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_AudioStream_Starved", ExactSpelling = true)]
+    public static extern void AudioStream_Starved(MGM_AudioStream* stream);
+
+    /// <summary>
+    /// Returns how many times playback has run out of data.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_AudioStream_GetUnderruns", ExactSpelling = true)]
+    public static extern int AudioStream_GetUnderruns(MGM_AudioStream* stream);
+
+    #endregion
+
+    #region Seek Index
+
+    /// <summary>
+    /// Sets where decoders save the seek index sidecar files built when first opening a file.
+    /// </summary>
+    /// <remarks>
+    /// Nothing is saved until this is set, so without it the index is built each time a file is opened.
+    /// A sidecar shipped next to the file as "name.mgseek" is always used.
+    /// </remarks>
+    /// <param name="directory">The absolute path to an existing directory or null to stop saving.</param>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_SeekIndex_SetCacheDirectory", ExactSpelling = true)]
+    public static extern void SeekIndex_SetCacheDirectory(byte* directory);
+
+    #endregion
+
+    #region PCM Cache
+
+    /// <summary>
+    /// Returns the fully decoded PCM of an audio file, decoding it only if it isn't already cached.
+    /// </summary>
+    /// <remarks>
+    /// The block is shared and never changes.  It stays in memory until every reference
+    /// is released, then waits in a size limited LRU in case it gets used again.
+    /// </remarks>
+    /// <param name="filepath">The absolute file path to the audio file.</param>
+    /// <param name="info">Returns information about the decoded audio.</param>
+    /// <returns>Returns the block with a reference added or null if the format is unsupported.</returns>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_PCMCache_Acquire", ExactSpelling = true)]
+    public static extern MGM_PCMBlock* PCMCache_Acquire(byte* filepath, out MGM_AudioDecoderInfo info);
+
+    /// <summary>
+    /// Releases a reference returned from PCMCache_Acquire.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_PCMCache_Release", ExactSpelling = true)]
+    public static extern void PCMCache_Release(MGM_PCMBlock* block);
+
+    /// <summary>
+    /// Returns the 16bit interleaved PCM data which is valid while the block is referenced.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_PCMBlock_GetData", ExactSpelling = true)]
+    public static extern void PCMBlock_GetData(MGM_PCMBlock* block, out byte* data, out uint size);
+
+    /// <summary>
+    /// Decodes an audio file into the cache ahead of it being used.
+    /// </summary>
+    /// <remarks>
+    /// This blocks while decoding, so call it while loading or from a worker thread.
+    /// </remarks>
+    /// <returns>Returns false if the format is unsupported.</returns>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_PCMCache_Prefetch", ExactSpelling = true)]
+    public static extern byte PCMCache_Prefetch(byte* filepath);
+
+    /// <summary>
+    /// Keeps an audio file in the cache regardless of the budget, decoding it if needed.
+    /// </summary>
+    /// <returns>Returns false if the file couldn't be decoded or wasn't pinned.</returns>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_PCMCache_SetPinned", ExactSpelling = true)]
+    public static extern byte PCMCache_SetPinned(byte* filepath, byte pinned);
+
+    /// <summary>
+    /// Sets how many bytes of decoded PCM the cache keeps, which defaults to 16MB.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_PCMCache_SetBudget", ExactSpelling = true)]
+    public static extern void PCMCache_SetBudget(ulong bytes);
+
+    /// <summary>
+    /// Returns the bytes of PCM held and how many requests were served from the cache or decoded.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_PCMCache_GetStats", ExactSpelling = true)]
+    public static extern void PCMCache_GetStats(out ulong bytes, out ulong hits, out ulong misses);
+
+    #endregion
+
 
     #region Video
 
@@ -115,6 +258,24 @@ internal static unsafe partial class MGM
     [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_VideoDecoder_SetLooped", ExactSpelling = true)]
     public static extern void VideoDecoder_SetLooped(MGM_VideoDecoder* decoder, byte looped);
 
+    /// <summary>
+    /// Switches the decoder to output separate Y, U and V textures.
+    /// </summary>
+    /// <remarks>
+    /// The planes are Alpha8 textures with the chroma at its coded size, so
+    /// 4:2:0 video uploads half the bytes of RGBA and skips the CPU conversion.
+    /// Decode then returns the Y texture.  Draw it with an effect built from
+    /// YUVToRGBEffect.fx, which isn't a stock effect so it goes thru the content pipeline.
+    /// </remarks>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_VideoDecoder_SetPlanar", ExactSpelling = true)]
+    public static extern void VideoDecoder_SetPlanar(MGM_VideoDecoder* decoder, byte planar);
+
+    /// <summary>
+    /// Returns the planes of the last frame from Decode or nulls if it wasn't planar.
+    /// </summary>
+    [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_VideoDecoder_GetPlanes", ExactSpelling = true)]
+    public static extern void VideoDecoder_GetPlanes(MGM_VideoDecoder* decoder, out MGG_Texture* y, out MGG_Texture* u, out MGG_Texture* v);
+
     [DllImport(MGP.MonoGameNativeDLL, EntryPoint = "MGM_VideoDecoder_Decode", ExactSpelling = true)]
     public static extern MGG_Texture* VideoDecoder_Decode(MGM_VideoDecoder* decoder);
 
@@ -13,6 +13,7 @@ namespace Microsoft.Xna.Framework.Media;
 public sealed partial class Song : IEquatable<Song>, IDisposable
 {
     private unsafe MGM_AudioDecoder* _decoder;
+    private unsafe MGM_AudioStream* _stream;
     private unsafe MGA_Voice* _voice;
 
     private MGM_AudioDecoderInfo _info;
@@ -22,6 +23,9 @@ public sealed partial class Song : IEquatable<Song>, IDisposable
 
     private float _volume = 1.0f;
 
+    // How far ahead the native thread decodes.
+    private const int StreamLatencyMS = 250;
+
     private unsafe void DecoderStream()
     {
         bool start_voice = true;
@@ -44,27 +48,42 @@ public sealed partial class Song : IEquatable<Song>, IDisposable
                 continue;
             }
 
+            // The decoding happens on a native thread, here
+            // we only pass along what is ready in the ring.
             uint size;
             byte* buffer;
-            finished = MGM.AudioDecoder_Decode(_decoder, out buffer, out size) == 0 ? false : true;
-
-            if (size > 0)
+            if (MGM.AudioStream_Acquire(_stream, out buffer, out size) != 0)
             {
                 MGA.Voice_AppendBuffer(_voice, buffer, size);
+                MGM.AudioStream_Release(_stream, size);
 
                 if (start_voice)
                 {
                     MGA.Voice_Play(_voice, 0);
                     start_voice = false;
                 }
+
+                continue;
             }
 
+            finished = MGM.AudioStream_IsFinished(_stream) != 0;
+
             if (finished)
             {
                 // Signal on the main thread.
                 Threading.OnUIThread(() => DonePlaying(this, EventArgs.Empty));
                 break;
             }
+
+            // Only running dry while playing is an underrun,
+            // not while paused or before the voice starts.
+            if (!start_voice &&
+                MGA.Voice_GetState(_voice) == SoundState.Playing &&
+                MGA.Voice_GetBufferCount(_voice) == 0)
+                MGM.AudioStream_Starved(_stream);
+
+            // Give the decode thread time to catch up.
+            Thread.Sleep(10);
         }
 
         // We're done streaming.
@@ -156,8 +175,10 @@ public sealed partial class Song : IEquatable<Song>, IDisposable
         // Stop the current playback which cleans stuff up.
         Stop();
         
-        // Move the decoder to the new position.
-        MGM.AudioDecoder_SetPosition(_decoder, milliseconds);
+        // The stream has its own decode thread, so it only
+        // exists while playing and not for every loaded song.
+        _stream = MGM.AudioStream_Create(_decoder, _info.samplerate, _info.channels, StreamLatencyMS);
+        MGM.AudioStream_Seek(_stream, milliseconds);
 
         // The thread does the rest of the work.
         _stop.Reset();
@@ -186,15 +207,23 @@ public sealed partial class Song : IEquatable<Song>, IDisposable
 
     internal unsafe void Stop()
     {
-        if (_thread == null)
-            return;
+        if (_thread != null)
+        {
+            MGA.Voice_Stop(_voice, 0);
 
-        MGA.Voice_Stop(_voice, 0);
+            // Halt the thread.
+            _stop.Set();
+            _thread.Join();
+            _thread = null;
+        }
 
-        // Halt the thread.
-        _stop.Set();
-        _thread.Join();
-        _thread = null;        
+        // Stops the decode thread, the decoder
+        // itself lives as long as the song.
+        if (_stream != null)
+        {
+            MGM.AudioStream_Destroy(_stream);
+            _stream = null;
+        }
     }
 
 
@@ -119,9 +119,20 @@ public partial class Texture2D : Texture
 
     private static unsafe Texture2D PlatformFromStream(GraphicsDevice graphicsDevice, Stream stream, Action<byte[]> colorProcessor)
     {
-        // HACK: Clear the default zero action as we do this natively.
+        // HACK: Clear the default actions as we do these natively.
+        var flags = ImageReadFlags.None;
         if (colorProcessor == DefaultColorProcessors.ZeroTransparentPixels)
+        {
+            flags = ImageReadFlags.ZeroTransparentPixels;
             colorProcessor = null;
+        }
+        else if (colorProcessor == DefaultColorProcessors.PremultiplyAlpha)
+        {
+            flags = ImageReadFlags.PremultiplyAlpha;
+            colorProcessor = null;
+        }
+        else if (colorProcessor == null)
+            flags = ImageReadFlags.ZeroTransparentPixels;
 
         // Simply read it all into memory as it will be fast
         // for most cases and simplifies the native API.
@@ -140,7 +151,7 @@ public partial class Texture2D : Texture
             MGI.ReadRGBA(
                 (byte*)handle.AddrOfPinnedObject(),
                 dataLength,
-                (byte)(colorProcessor == null ? 1 : 0),
+                flags,
                 out width,
                 out height,
                 out rgba);
@@ -205,7 +216,11 @@ public partial class Texture2D : Texture
 
             MGI.WriteJpg((byte*)ptr, data.Length, width, height, 90, out jpg, out jpgBytes);
 
+            if (jpg == null)
+                return;
+
             stream.Write(new ReadOnlySpan<byte>(jpg, jpgBytes));
+            Marshal.FreeHGlobal((nint)jpg);
         }
     }
 
@@ -220,7 +235,11 @@ public partial class Texture2D : Texture
 
             MGI.WritePng((byte*)ptr, data.Length, width, height, out png, out pngBytes);
 
+            if (png == null)
+                return;
+
             stream.Write(new ReadOnlySpan<byte>(png, pngBytes));
+            Marshal.FreeHGlobal((nint)png);
         }
     }
 
@@ -240,7 +259,7 @@ public partial class Texture2D : Texture
             MGI.ReadRGBA(
                 (byte*)handle.AddrOfPinnedObject(),
                 dataLength,
-                1,
+                ImageReadFlags.ZeroTransparentPixels,
                 out width,
                 out height,
                 out rgba);
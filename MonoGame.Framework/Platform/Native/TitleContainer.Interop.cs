@@ -6,6 +6,7 @@ using System.Runtime.InteropServices;
 internal unsafe class ReadOnlyAssetStream : Stream
 {
     private MG_Asset* _asset;
+    private byte* _data;
     private long _length;
     private long _position;
 
@@ -33,6 +34,10 @@ internal unsafe class ReadOnlyAssetStream : Stream
     {
         if (MG.AssetOpen(assetname, out _asset, out _length) == 0)
             throw new FileNotFoundException("Asset not found", assetname);
+
+        // Read straight from a mapping of the file when we can.
+        if (MG.AssetMap(_asset, out _data) == 0)
+            _data = null;
     }
 
     public override void Flush()
@@ -41,10 +46,24 @@ internal unsafe class ReadOnlyAssetStream : Stream
 
     public override int Read(byte[] buffer, int offset, int count)
     {
-        if (_position + count > _length)
-            count = (int)(_length - _position);
+        return Read(new Span<byte>(buffer, offset, count));
+    }
 
-        if (count == 0)
+    public override int Read(Span<byte> buffer)
+    {
+        var count = (int)Math.Min(buffer.Length, _length - _position);
+        if (count <= 0)
+            return 0;
+
+        if (_data != null)
+        {
+            new ReadOnlySpan<byte>(_data + _position, count).CopyTo(buffer);
+            _position += count;
+            return count;
+        }
+
+        // The native file position is only kept in sync when not mapped.
+        if (MG.AssetSeek(_asset, _position, (int)SeekOrigin.Begin) < 0)
             return 0;
 
         int bytesRead;
@@ -55,9 +74,35 @@ internal unsafe class ReadOnlyAssetStream : Stream
         return bytesRead;
     }
 
+    public override int ReadByte()
+    {
+        if (_data == null)
+            return base.ReadByte();
+
+        if (_position >= _length)
+            return -1;
+
+        return _data[_position++];
+    }
+
     public override long Seek(long offset, SeekOrigin origin)
     {
-        var newPosition = MG.AssetSeek(_asset, offset, (int)origin);
+        long newPosition;
+        switch (origin)
+        {
+            case SeekOrigin.Begin:
+                newPosition = offset;
+                break;
+            case SeekOrigin.Current:
+                newPosition = _position + offset;
+                break;
+            case SeekOrigin.End:
+                newPosition = _length + offset;
+                break;
+            default:
+                throw new ArgumentException(nameof(origin));
+        }
+
         if (newPosition < 0 || newPosition > _length)
             throw new ArgumentOutOfRangeException();
 
@@ -82,6 +127,7 @@ internal unsafe class ReadOnlyAssetStream : Stream
         {
             MG.AssetClose(_asset);
             _asset = null;
+            _data = null;
         }
 
         base.Dispose(disposing);
@@ -93,10 +139,114 @@ internal readonly struct MG_Asset
 {
 }
 
+[MGHandle]
+internal readonly struct MG_AssetReader
+{
+}
+
+[MGHandle]
+internal readonly struct MG_AssetScheduler
+{
+}
+
+/// <summary>
+/// The order the scheduler serves requests in, most urgent first.
+/// </summary>
+internal enum MGAssetPriority : int
+{
+    Critical,
+    High,
+    Normal,
+    Background,
+}
+
+internal enum MGAssetStatus : int
+{
+    Completed,
+    Failed,
+    Cancelled,
+}
+
+/// <summary>
+/// A single read request for <see cref="MG.AssetReaderSubmit"/>.
+/// </summary>
+internal unsafe struct MG_AssetRead
+{
+    public MG_Asset* Asset;
+    public long Offset;
+    public byte* Buffer;
+    public int Length;
+    public ulong UserData;
+}
+
+/// <summary>
+/// A finished read, where BytesRead is -1 on failure.
+/// </summary>
+internal struct MG_AssetReadResult
+{
+    public ulong UserData;
+    public int BytesRead;
+}
+
+/// <summary>
+/// A prioritized read for <see cref="MG.AssetSchedulerSubmit"/>, where a
+/// DeadlineMS of zero means there is no deadline.
+/// </summary>
+internal unsafe struct MG_AssetRequest
+{
+    public MG_Asset* Asset;
+    public long Offset;
+    public byte* Buffer;
+    public long Length;
+    public ulong UserData;
+    public MGAssetPriority Priority;
+    public int DeadlineMS;
+}
+
+/// <summary>
+/// A finished request, where Late is set if it missed its deadline.
+/// </summary>
+internal struct MG_AssetRequestResult
+{
+    public ulong UserData;
+    public long BytesRead;
+    public MGAssetStatus Status;
+    public byte Late;
+}
+
+/// <summary>
+/// Asset I/O counters, where ReadHistogram[N] counts reads
+/// taking under 2^N microseconds and the last one the rest.
+/// </summary>
+internal unsafe struct MG_AssetStats
+{
+    public long Opens;
+    public long FailedOpens;
+    public long Reads;
+    public long BytesRead;
+    public long Seeks;
+    public long Maps;
+    public long OpenTimeNS;
+    public long ReadTimeNS;
+    public fixed long ReadHistogram[16];
+}
+
+internal unsafe struct MG_AssetPathStats
+{
+    public byte* Path;
+    public MG_AssetStats Stats;
+}
+
 internal static unsafe partial class MG
 {
     public const string MonoGameNativeDLL = "monogame.native";
 
+    /// <summary>
+    /// Mounts a pack file so assets under the mount point are opened from it.
+    /// </summary>
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_Asset_Mount", ExactSpelling = true)]
+    public static extern byte AssetMount(string packPath, string mountPoint);
+
     [DllImport(MonoGameNativeDLL, EntryPoint = "MG_Asset_Open", ExactSpelling = true)]
     public static extern byte AssetOpen(string assetname, out MG_Asset* file, out long length);
 
@@ -106,9 +256,115 @@ internal static unsafe partial class MG
     [DllImport(MonoGameNativeDLL, EntryPoint = "MG_Asset_Seek", ExactSpelling = true)]
     public static extern long AssetSeek(MG_Asset* file, long offset, int origin);
 
+    /// <summary>
+    /// Maps the whole asset into memory, falling back to reading it into a buffer.
+    /// </summary>
+    /// <remarks>
+    /// The data stays valid until the asset is unmapped or closed.  This fails
+    /// for chunk compressed assets, which are read a chunk at a time instead.
+    /// </remarks>
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_Asset_Map", ExactSpelling = true)]
+    public static extern byte AssetMap(MG_Asset* file, out byte* data);
+
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_Asset_Unmap", ExactSpelling = true)]
+    public static extern void AssetUnmap(MG_Asset* file);
+
     [DllImport(MonoGameNativeDLL, EntryPoint = "MG_Asset_Close", ExactSpelling = true)]
     public static extern void AssetClose(MG_Asset* file);
 
+    /// <summary>
+    /// Starts or stops counting I/O for assets opened afterwards, optionally writing the stats as JSON at exit.
+    /// </summary>
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_Asset_SetStatsEnabled", ExactSpelling = true)]
+    public static extern void AssetSetStatsEnabled(byte enabled, string dumpPath);
+
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_Asset_GetStats", ExactSpelling = true)]
+    public static extern void AssetGetStats(out MG_AssetStats stats);
+
+    /// <summary>
+    /// Copies the stats for each path and returns how many paths there are.
+    /// </summary>
+    /// <remarks>The paths stay valid for the life of the process.</remarks>
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_Asset_GetPathStats", ExactSpelling = true)]
+    public static extern int AssetGetPathStats(MG_AssetPathStats* stats, int maxStats);
+
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_Asset_ResetStats", ExactSpelling = true)]
+    public static extern void AssetResetStats();
+
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_Asset_WriteStats", ExactSpelling = true)]
+    public static extern byte AssetWriteStats(string path);
+
+    /// <summary>
+    /// Creates an async reader backed by io_uring where available, else a small thread pool.
+    /// </summary>
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_AssetReader_Create", ExactSpelling = true)]
+    public static extern MG_AssetReader* AssetReaderCreate(int maxInFlight);
+
+    /// <summary>
+    /// Waits for all outstanding reads before destroying the reader.
+    /// </summary>
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_AssetReader_Destroy", ExactSpelling = true)]
+    public static extern void AssetReaderDestroy(MG_AssetReader* reader);
+
+    /// <summary>
+    /// Queues a batch of reads, merging those near each other in the same file.
+    /// </summary>
+    /// <remarks>The buffers must stay pinned until their result is returned.</remarks>
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_AssetReader_Submit", ExactSpelling = true)]
+    public static extern void AssetReaderSubmit(MG_AssetReader* reader, MG_AssetRead* reads, int count);
+
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_AssetReader_Poll", ExactSpelling = true)]
+    public static extern int AssetReaderPoll(MG_AssetReader* reader, MG_AssetReadResult* results, int maxResults);
+
+    /// <summary>
+    /// Blocks until at least one read finishes, returning zero only when none are outstanding.
+    /// </summary>
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_AssetReader_Wait", ExactSpelling = true)]
+    public static extern int AssetReaderWait(MG_AssetReader* reader, MG_AssetReadResult* results, int maxResults);
+
+    /// <summary>
+    /// Creates a scheduler which serves reads by priority and deadline on its own workers.
+    /// </summary>
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_AssetScheduler_Create", ExactSpelling = true)]
+    public static extern MG_AssetScheduler* AssetSchedulerCreate(int workers);
+
+    /// <summary>
+    /// Drops any queued requests without results and waits for the reads in progress.
+    /// </summary>
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_AssetScheduler_Destroy", ExactSpelling = true)]
+    public static extern void AssetSchedulerDestroy(MG_AssetScheduler* scheduler);
+
+    /// <summary>
+    /// Limits the background priority reads, where zero removes the limit.
+    /// </summary>
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_AssetScheduler_SetBackgroundBandwidth", ExactSpelling = true)]
+    public static extern void AssetSchedulerSetBackgroundBandwidth(MG_AssetScheduler* scheduler, long bytesPerSecond);
+
+    /// <summary>
+    /// Queues a read and returns an id for changing its priority or cancelling it.
+    /// </summary>
+    /// <remarks>The buffer must stay pinned until its result is returned.</remarks>
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_AssetScheduler_Submit", ExactSpelling = true)]
+    public static extern ulong AssetSchedulerSubmit(MG_AssetScheduler* scheduler, ref MG_AssetRequest request);
+
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_AssetScheduler_SetPriority", ExactSpelling = true)]
+    public static extern byte AssetSchedulerSetPriority(MG_AssetScheduler* scheduler, ulong id, MGAssetPriority priority);
+
+    /// <summary>
+    /// Cancels a request, returning once its buffer is no longer written to.
+    /// </summary>
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_AssetScheduler_Cancel", ExactSpelling = true)]
+    public static extern byte AssetSchedulerCancel(MG_AssetScheduler* scheduler, ulong id);
+
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_AssetScheduler_Poll", ExactSpelling = true)]
+    public static extern int AssetSchedulerPoll(MG_AssetScheduler* scheduler, MG_AssetRequestResult* results, int maxResults);
+
+    /// <summary>
+    /// Blocks until at least one request finishes, returning zero only when none are outstanding.
+    /// </summary>
+    [DllImport(MonoGameNativeDLL, EntryPoint = "MG_AssetScheduler_Wait", ExactSpelling = true)]
+    public static extern int AssetSchedulerWait(MG_AssetScheduler* scheduler, MG_AssetRequestResult* results, int maxResults);
+
     public static Stream OpenRead(string path)
     {
         return new ReadOnlyAssetStream(path);
@@ -13,6 +13,22 @@ partial class TitleContainer
 
     static partial void PlatformInit()
     {
+        // Setting this to a file path records asset I/O
+        // stats and writes them there as JSON at exit.
+        var statsPath = Environment.GetEnvironmentVariable("MONOGAME_ASSET_STATS");
+        if (!string.IsNullOrEmpty(statsPath))
+            MG.AssetSetStatsEnabled(1, statsPath);
+
+        // Any packs found next to the game are mounted using their name,
+        // so Content.mgpack serves every asset under Content.
+        try
+        {
+            foreach (var pack in Directory.EnumerateFiles(".", "*.mgpack"))
+                MG.AssetMount(pack, Path.GetFileNameWithoutExtension(pack));
+        }
+        catch
+        {
+        }
     }
 
     private static Stream PlatformOpenStream(string safeName)
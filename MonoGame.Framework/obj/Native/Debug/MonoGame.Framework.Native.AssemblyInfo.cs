@@ -0,0 +1,24 @@
+//------------------------------------------------------------------------------
+// <auto-generated>
+//     This code was generated by a tool.
+//
+//     Changes to this file may cause incorrect behavior and will be lost if
+//     the code is regenerated.
+// </auto-generated>
+//------------------------------------------------------------------------------
+
+using System;
+using System.Reflection;
+
+[assembly: System.Reflection.AssemblyCompanyAttribute("MonoGame Team")]
+[assembly: System.Reflection.AssemblyConfigurationAttribute("Debug")]
+[assembly: System.Reflection.AssemblyDescriptionAttribute("The MonoGame Native platform.")]
+[assembly: System.Reflection.AssemblyFileVersionAttribute("3.8.3.1")]
+[assembly: System.Reflection.AssemblyInformationalVersionAttribute("3.8.3.1+6188c97d3a585ba9c575c65c80dcfb9920eb92bf")]
+[assembly: System.Reflection.AssemblyProductAttribute("MonoGame.Framework")]
+[assembly: System.Reflection.AssemblyTitleAttribute("MonoGame.Framework")]
+[assembly: System.Reflection.AssemblyVersionAttribute("3.8.3.1")]
+[assembly: System.Reflection.AssemblyMetadataAttribute("RepositoryUrl", "https://github.com/MonoGame/MonoGame")]
+
+// Generated by the MSBuild WriteCodeFragment class.
+
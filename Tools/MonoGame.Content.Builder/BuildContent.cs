@@ -251,6 +251,17 @@ namespace MonoGame.Content.Builder
             Description = "Compress the XNB files for smaller file sizes.")]
         public bool CompressContent = false;
 
+        [CommandLineParameter(
+            Name = "pack",
+            ValueName = "packFile",
+            Description = "Write all the content in the output directory into a single pack file.  Native platforms mount it using its file name, so Content.mgpack replaces the Content directory.")]
+        public string PackFile = null;
+
+        [CommandLineParameter(
+            Name = "packCompress",
+            Description = "Compress the files in the pack in small chunks which the runtime decompresses as they are read, so seeking stays cheap.")]
+        public bool CompressPack = false;
+
         public class ContentItem
         {
             public string SourceFile;
@@ -509,6 +520,26 @@ namespace MonoGame.Content.Builder
                 }
             }
 
+            // Gather everything we built into a pack.
+            if (!string.IsNullOrEmpty(PackFile) && errorCount == 0)
+            {
+                var packFile = ReplaceSymbols(PackFile);
+                if (!Path.IsPathRooted(packFile))
+                    packFile = PathHelper.Normalize(Path.GetFullPath(Path.Combine(projectDirectory, packFile)));
+
+                try
+                {
+                    var count = ContentPack.Write(outputPath, packFile, CompressPack);
+                    if (!Quiet)
+                        Console.WriteLine("Packed {0} files into {1}", count, packFile);
+                }
+                catch (Exception ex)
+                {
+                    Console.Error.WriteLine("{0}: error: {1}", packFile, ex.Message);
+                    ++errorCount;
+                }
+            }
+
             // Dump the content build stats.
             _manager.ContentStats.Write(intermediatePath);
         }
@@ -0,0 +1,218 @@
+// MonoGame - Copyright (C) MonoGame Foundation, Inc
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Text;
+using Microsoft.Xna.Framework.Content.Pipeline.Utilities.LZ4;
+
+namespace MonoGame.Content.Builder
+{
+    /// <summary>
+    /// Writes a directory of built content into a single pack file
+    /// which the native platforms mount in place of the directory.
+    /// </summary>
+    /// <remarks>
+    /// The layout must match MG_Asset.cpp in the native library.
+    /// </remarks>
+    static class ContentPack
+    {
+        public const string Extension = ".mgpack";
+
+        const uint Magic = 0x4B50474D; // MGPK
+        const uint Version = 1;
+        const int HeaderSize = 16;
+        const int EntrySize = 32;
+        const int DataAlignment = 16;
+
+        const uint ChunksMagic = 0x5A43474D; // MGCZ
+        const uint ChunksVersion = 1;
+        const uint ChunksCodecLZ4 = 1;
+        const int ChunksHeaderSize = 32;
+        const int ChunkSize = 64 * 1024;
+
+        class Entry
+        {
+            public string SourceFile;
+            public byte[] Name;
+            public uint Hash;
+            public uint NameOffset;
+            public ulong Offset;
+            public ulong Length;
+            public byte[] Compressed;
+        }
+
+        // Lookups ignore ASCII case and use '/' separators.
+        static byte[] NormalizeName(string name)
+        {
+            var bytes = Encoding.UTF8.GetBytes(name.Replace('\\', '/'));
+            for (var i = 0; i < bytes.Length; i++)
+            {
+                if (bytes[i] >= 'A' && bytes[i] <= 'Z')
+                    bytes[i] = (byte)(bytes[i] + ('a' - 'A'));
+            }
+            return bytes;
+        }
+
+        // The same 32-bit FNV-1a as MG_ComputeHash.
+        static uint ComputeHash(byte[] value)
+        {
+            var hash = 0x811c9dc5;
+            foreach (var b in value)
+            {
+                hash ^= b;
+                hash *= 16777619;
+            }
+            return hash;
+        }
+
+        static int CompareNames(byte[] a, byte[] b)
+        {
+            var length = Math.Min(a.Length, b.Length);
+            for (var i = 0; i < length; i++)
+            {
+                if (a[i] != b[i])
+                    return a[i] < b[i] ? -1 : 1;
+            }
+            return a.Length.CompareTo(b.Length);
+        }
+
+        /// <summary>
+        /// Compresses the data in independent chunks so the runtime can
+        /// seek within it, returning null if it doesn't get any smaller.
+        /// </summary>
+        static byte[] CompressChunks(byte[] data)
+        {
+            var count = (data.Length + ChunkSize - 1) / ChunkSize;
+            var offsets = new ulong[count + 1];
+
+            using (var stream = new MemoryStream())
+            using (var writer = new BinaryWriter(stream))
+            {
+                writer.Write(ChunksMagic);
+                writer.Write(ChunksVersion);
+                writer.Write(ChunksCodecLZ4);
+                writer.Write((uint)ChunkSize);
+                writer.Write((ulong)data.Length);
+                writer.Write((uint)count);
+                writer.Write(0u);
+
+                // Leave room for the offsets which we fill in at the end.
+                stream.Position += offsets.Length * sizeof(ulong);
+
+                var output = new byte[LZ4Codec.MaximumOutputLength(ChunkSize)];
+                for (var i = 0; i < count; i++)
+                {
+                    offsets[i] = (ulong)stream.Position;
+
+                    var start = i * ChunkSize;
+                    var length = Math.Min(ChunkSize, data.Length - start);
+
+                    // Chunks which don't shrink are stored as is.
+                    var compressed = LZ4Codec.Encode32HC(data, start, length, output, 0, output.Length);
+                    if (compressed > 0 && compressed < length)
+                        writer.Write(output, 0, compressed);
+                    else
+                        writer.Write(data, start, length);
+                }
+                offsets[count] = (ulong)stream.Position;
+
+                if (stream.Length >= data.Length)
+                    return null;
+
+                stream.Position = ChunksHeaderSize;
+                foreach (var offset in offsets)
+                    writer.Write(offset);
+
+                return stream.ToArray();
+            }
+        }
+
+        public static int Write(string contentDirectory, string packFile, bool compress = false)
+        {
+            var fullPackFile = Path.GetFullPath(packFile);
+
+            var entries = Directory.EnumerateFiles(contentDirectory, "*", SearchOption.AllDirectories)
+                .Where(f => !string.Equals(Path.GetFullPath(f), fullPackFile, StringComparison.OrdinalIgnoreCase))
+                .Select(f =>
+                {
+                    var name = NormalizeName(Path.GetRelativePath(contentDirectory, f));
+                    return new Entry { SourceFile = f, Name = name, Hash = ComputeHash(name) };
+                })
+                .ToList();
+
+            // The directory is sorted by hash so the runtime can
+            // binary search it, with the name breaking any ties.
+            entries.Sort((a, b) =>
+            {
+                var result = a.Hash.CompareTo(b.Hash);
+                return result != 0 ? result : CompareNames(a.Name, b.Name);
+            });
+
+            var nameBytes = 0;
+            foreach (var e in entries)
+            {
+                e.NameOffset = (uint)nameBytes;
+                nameBytes += e.Name.Length;
+            }
+
+            var offset = (ulong)(HeaderSize + (entries.Count * EntrySize) + nameBytes);
+            foreach (var e in entries)
+            {
+                offset = (offset + DataAlignment - 1) & ~(ulong)(DataAlignment - 1);
+                e.Offset = offset;
+                if (compress)
+                    e.Compressed = CompressChunks(File.ReadAllBytes(e.SourceFile));
+                e.Length = e.Compressed != null ? (ulong)e.Compressed.Length : (ulong)new FileInfo(e.SourceFile).Length;
+                offset += e.Length;
+            }
+
+            var directory = Path.GetDirectoryName(fullPackFile);
+            if (!string.IsNullOrEmpty(directory))
+                Directory.CreateDirectory(directory);
+
+            using (var stream = new FileStream(fullPackFile, FileMode.Create, FileAccess.Write))
+            using (var writer = new BinaryWriter(stream))
+            {
+                writer.Write(Magic);
+                writer.Write(Version);
+                writer.Write((uint)entries.Count);
+                writer.Write((uint)nameBytes);
+
+                foreach (var e in entries)
+                {
+                    writer.Write(e.Hash);
+                    writer.Write(e.NameOffset);
+                    writer.Write((uint)e.Name.Length);
+                    writer.Write(0u);
+                    writer.Write(e.Offset);
+                    writer.Write(e.Length);
+                }
+
+                foreach (var e in entries)
+                    writer.Write(e.Name);
+
+                foreach (var e in entries)
+                {
+                    while ((ulong)stream.Position < e.Offset)
+                        writer.Write((byte)0);
+
+                    if (e.Compressed != null)
+                    {
+                        writer.Write(e.Compressed);
+                        e.Compressed = null;
+                        continue;
+                    }
+
+                    using (var source = File.OpenRead(e.SourceFile))
+                        source.CopyTo(stream);
+                }
+            }
+
+            return entries.Count;
+        }
+    }
+}
@@ -0,0 +1,23 @@
+//------------------------------------------------------------------------------
+// <auto-generated>
+//     This code was generated by a tool.
+//
+//     Changes to this file may cause incorrect behavior and will be lost if
+//     the code is regenerated.
+// </auto-generated>
+//------------------------------------------------------------------------------
+
+using System;
+using System.Reflection;
+
+[assembly: System.Reflection.AssemblyCompanyAttribute("MonoGame Team")]
+[assembly: System.Reflection.AssemblyConfigurationAttribute("Debug")]
+[assembly: System.Reflection.AssemblyFileVersionAttribute("3.8.3.1")]
+[assembly: System.Reflection.AssemblyInformationalVersionAttribute("3.8.3.1+1b8256c9cf5fcd66bbcd52d09813e3b0718edbac")]
+[assembly: System.Reflection.AssemblyProductAttribute("MonoGame.Generator.CTypes")]
+[assembly: System.Reflection.AssemblyTitleAttribute("MonoGame.Generator.CTypes")]
+[assembly: System.Reflection.AssemblyVersionAttribute("3.8.3.1")]
+[assembly: System.Reflection.AssemblyMetadataAttribute("RepositoryUrl", "https://github.com/MonoGame/MonoGame")]
+
+// Generated by the MSBuild WriteCodeFragment class.
+
@@ -0,0 +1,44 @@
+#!/bin/sh
+# Generates the media corpus for mgmbench and images for mgicompare.
+#
+#   ./make_corpus.sh <output directory>
+#
+# The output depends on the encoders in your ffmpeg build, so record
+# the checksums with 'mgmbench <directory> --update' after generating.
+
+set -e
+
+OUT="${1:-corpus}"
+mkdir -p "$OUT"
+
+FF="ffmpeg -hide_banner -loglevel error -y"
+
+# A sweep plus noise exercises more of the codec than a pure tone.
+AUDIO="aevalsrc=0.4*sin(2*PI*(220+110*t)*t)+0.05*(random(0)-0.5)|0.4*sin(2*PI*330*t):s=44100:d=600"
+SHORT="sine=frequency=1000:sample_rate=22050:duration=2"
+
+$FF -f lavfi -i "$AUDIO" -c:a libvorbis -q:a 4 "$OUT/music_10min.ogg"
+$FF -f lavfi -i "$AUDIO" -c:a libmp3lame -b:a 192k "$OUT/music_10min.mp3"
+$FF -f lavfi -i "$SHORT" -ac 1 -c:a libvorbis "$OUT/click_mono.ogg"
+$FF -f lavfi -i "$SHORT" -ac 1 -c:a libmp3lame -b:a 64k "$OUT/click_mono.mp3"
+
+# Odd sizes check the cropping and the SIMD tails.
+VIDEO="testsrc2=size=1280x720:rate=30:duration=20"
+SMALL="testsrc2=size=322x182:rate=24:duration=5"
+
+$FF -f lavfi -i "$VIDEO" -an -c:v libtheora -q:v 7 "$OUT/video_720p.ogv"
+$FF -f lavfi -i "$SMALL" -an -c:v libtheora -q:v 7 "$OUT/video_small.ogv"
+$FF -f lavfi -i "$VIDEO" -an -c:v libx264 -profile:v baseline -bsf:v h264_mp4toannexb -f h264 "$OUT/video_720p.h264"
+$FF -f lavfi -i "$SMALL" -an -c:v libx264 -profile:v high -pix_fmt yuv420p -bsf:v h264_mp4toannexb -f h264 "$OUT/video_small.h264"
+
+# Images for mgicompare, in formats stb_image_write can't produce.
+mkdir -p "$OUT/images"
+IMAGE="testsrc2=size=333x211:rate=1:duration=1"
+
+for FMT in rgb24 rgba pal8 gray ya8 rgb48be rgba64be gray16be; do
+	$FF -f lavfi -i "$IMAGE" -frames:v 1 -pix_fmt $FMT "$OUT/images/image_$FMT.png"
+done
+
+for FMT in yuvj420p yuvj422p yuvj444p gray; do
+	$FF -f lavfi -i "$IMAGE" -frames:v 1 -pix_fmt $FMT -q:v 3 "$OUT/images/image_$FMT.jpg"
+done
@@ -0,0 +1,239 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+// Checks MGI_ReadRGBA against stb_image, which is the reference
+// the optional libspng and libjpeg-turbo decoders must match.
+// PNG output must be identical.  JPEG decoders are allowed to
+// round differently, so those only have to be within a tolerance.
+//
+//   mgicompare [image directory]
+//
+// A set of generated images is always checked.  The images made
+// by bench/make_corpus.sh cover formats stb can't write, so pass
+// its images directory to check those too.  Build with the
+// --with-libspng and --with-libjpeg-turbo options, else both
+// sides are stb and the comparison is trivially exact.
+
+#include "api_MGI.h"
+
+#include "stb_image.h"
+#include "stb_image_write.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// libjpeg-turbo's accurate IDCT, fancy upsampling and color
+// conversion differ from stb only in rounding.  A swapped channel,
+// wrong upsampling or a color space mistake is far outside this.
+static const int MGI_Compare_JpgMaxError = 8;
+static const double MGI_Compare_JpgMeanError = 1.0;
+
+
+struct MGI_CompareImage
+{
+	std::string name;
+	std::vector<mgbyte> data;
+};
+
+static void MGI_Compare_Write(void* context, void* data, int size)
+{
+	auto output = (std::vector<mgbyte>*)context;
+	output->insert(output->end(), (mgbyte*)data, (mgbyte*)data + size);
+}
+
+static bool MGI_Compare_IsJpg(const std::vector<mgbyte>& data)
+{
+	return data.size() > 2 && data[0] == 0xFF && data[1] == 0xD8;
+}
+
+// Smooth gradients, hard edges and noise in every channel
+// with odd sizes to reach the SIMD tails and partial blocks.
+static std::vector<mgbyte> MGI_Compare_Pattern(int width, int height, int components, int seed)
+{
+	std::vector<mgbyte> pixels((size_t)width * height * components);
+	srand(seed);
+
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			for (int c = 0; c < components; c++)
+			{
+				int value;
+				if (y < height / 3)
+					value = (x * 255 / width + c * 64) & 255;
+				else if (y < height * 2 / 3)
+					value = ((x / 7 + y / 5 + c) % 2) ? 235 : 16;
+				else
+					value = 128 + (int)(90 * sin(x * 0.21 + c) * cos(y * 0.17)) + (rand() % 33 - 16);
+
+				pixels[((size_t)y * width + x) * components + c] = (mgbyte)std::min(255, std::max(0, value));
+			}
+		}
+	}
+
+	return pixels;
+}
+
+static std::vector<MGI_CompareImage> MGI_Compare_Generate()
+{
+	std::vector<MGI_CompareImage> images;
+
+	const int sizes[][2] = { { 1, 1 }, { 17, 9 }, { 123, 77 }, { 640, 361 } };
+
+	for (auto& size : sizes)
+	{
+		auto width = size[0];
+		auto height = size[1];
+
+		// Gray, gray alpha, RGB and RGBA.
+		for (int components = 1; components <= 4; components++)
+		{
+			auto pixels = MGI_Compare_Pattern(width, height, components, width + components);
+
+			MGI_CompareImage image;
+			image.name = "gen_" + std::to_string(width) + "x" + std::to_string(height) + "_c" + std::to_string(components) + ".png";
+			stbi_write_png_to_func(MGI_Compare_Write, &image.data, width, height, components, pixels.data(), width * components);
+			images.push_back(image);
+		}
+
+		// stb subsamples the chroma below quality 91.
+		for (int components : { 1, 3 })
+		{
+			for (int quality : { 50, 90, 100 })
+			{
+				auto pixels = MGI_Compare_Pattern(width, height, components, width * quality);
+
+				MGI_CompareImage image;
+				image.name = "gen_" + std::to_string(width) + "x" + std::to_string(height) + "_c" + std::to_string(components) + "_q" + std::to_string(quality) + ".jpg";
+				stbi_write_jpg_to_func(MGI_Compare_Write, &image.data, width, height, components, pixels.data(), quality);
+				images.push_back(image);
+			}
+		}
+	}
+
+	return images;
+}
+
+static std::vector<MGI_CompareImage> MGI_Compare_Load(const std::filesystem::path& directory)
+{
+	std::vector<MGI_CompareImage> images;
+
+	for (auto& entry : std::filesystem::directory_iterator(directory))
+	{
+		if (!entry.is_regular_file())
+			continue;
+
+		auto extension = entry.path().extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+		if (extension != ".png" && extension != ".jpg" && extension != ".jpeg")
+			continue;
+
+		MGI_CompareImage image;
+		image.name = entry.path().filename().string();
+
+		std::ifstream file(entry.path(), std::ios::binary);
+		image.data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		images.push_back(image);
+	}
+
+	std::sort(images.begin(), images.end(), [](const MGI_CompareImage& a, const MGI_CompareImage& b) { return a.name < b.name; });
+	return images;
+}
+
+// Returns false and prints why when the decoders disagree.
+static bool MGI_Compare_Check(MGI_CompareImage& image)
+{
+	auto data = image.data.data();
+	auto dataBytes = (mgint)image.data.size();
+	auto jpg = MGI_Compare_IsJpg(image.data);
+
+	int expectedWidth, expectedHeight, components;
+	auto expected = stbi_load_from_memory(data, dataBytes, &expectedWidth, &expectedHeight, &components, 4);
+
+	mgint width, height;
+	mgbyte* actual;
+	MGI_ReadRGBA(data, dataBytes, MGImageReadFlags::None, width, height, actual);
+
+	auto ok = true;
+	char detail[128] = "";
+
+	if (expected == nullptr)
+	{
+		// Nothing to compare against.
+		snprintf(detail, sizeof(detail), "skipped, stb can't decode");
+	}
+	else if (actual == nullptr)
+	{
+		snprintf(detail, sizeof(detail), "MGI failed to decode");
+		ok = false;
+	}
+	else if (width != expectedWidth || height != expectedHeight)
+	{
+		snprintf(detail, sizeof(detail), "size %dx%d expected %dx%d", width, height, expectedWidth, expectedHeight);
+		ok = false;
+	}
+	else
+	{
+		auto bytes = (size_t)width * height * 4;
+		auto maxError = 0;
+		double totalError = 0;
+
+		for (size_t i = 0; i < bytes; i++)
+		{
+			auto error = abs((int)actual[i] - (int)expected[i]);
+			maxError = std::max(maxError, error);
+			totalError += error;
+		}
+
+		auto meanError = totalError / bytes;
+		snprintf(detail, sizeof(detail), "max %d mean %.3f", maxError, meanError);
+
+		if (jpg)
+			ok = maxError <= MGI_Compare_JpgMaxError && meanError <= MGI_Compare_JpgMeanError;
+		else
+			ok = maxError == 0;
+	}
+
+	printf("%-32s %-4s %-22s %s\n", image.name.c_str(), jpg ? "jpg" : "png", detail, ok ? "ok" : "MISMATCH");
+
+	stbi_image_free(expected);
+	free(actual);
+
+	return ok;
+}
+
+int main(int argc, char** argv)
+{
+#if !defined(MG_LIBSPNG) && !defined(MG_LIBJPEG_TURBO)
+	printf("Built without libspng or libjpeg-turbo, both sides are stb.\n");
+#endif
+
+	auto images = MGI_Compare_Generate();
+
+	if (argc > 1)
+	{
+		auto loaded = MGI_Compare_Load(argv[1]);
+		images.insert(images.end(), loaded.begin(), loaded.end());
+	}
+
+	auto failures = 0;
+	for (auto& image : images)
+	{
+		if (!MGI_Compare_Check(image))
+			failures++;
+	}
+
+	printf("%d images, %d failed\n", (int)images.size(), failures);
+
+	return failures > 0 ? 1 : 0;
+}
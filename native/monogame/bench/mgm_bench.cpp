@@ -0,0 +1,353 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+// Runs every file in a corpus thru the MGM decoders and reports
+// the real-time factor, Decode latency and a checksum of the
+// output compared with the reference checksums.  It needs no
+// audio device or GPU, so it can run on any CI machine.
+//
+//   mgmbench <corpus directory> [--update]
+//
+// The bench/make_corpus.sh script generates a corpus.  Run with
+// --update on a known good build to record the checksums.
+
+#include "api_MGM.h"
+#include "api_MGG.h"
+
+#include "MGM_common.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// How far a sample may be off after a seek, which allows
+// for decoders that don't rebuild their state exactly.
+static const mgint MGM_Bench_SeekTolerance = 2;
+
+static const char* MGM_Bench_ChecksumFile = "checksums.txt";
+
+typedef std::chrono::steady_clock MGM_BenchClock;
+
+
+// The video decoders upload to textures, so this stands
+// in for the graphics device and keeps frames on the CPU.
+struct MGG_GraphicsDevice
+{
+	mgulong checksum;
+	mgint uploads;
+};
+
+struct MGG_Texture
+{
+	mgint width;
+	mgint height;
+	std::vector<mgbyte> pixels;
+};
+
+MGG_Texture* MGG_Texture_Create(MGG_GraphicsDevice* device, MGTextureType type, MGSurfaceFormat format, mgint width, mgint height, mgint depth, mgint mipmaps, mgint slices)
+{
+	auto texture = new MGG_Texture();
+	texture->width = width;
+	texture->height = height;
+	texture->pixels.resize((size_t)width * height * (format == MGSurfaceFormat::Alpha8 ? 1 : 4));
+	return texture;
+}
+
+void MGG_Texture_Destroy(MGG_GraphicsDevice* device, MGG_Texture* texture)
+{
+	delete texture;
+}
+
+
+// 64bit FNV-1a which doesn't depend on how the output is split up.
+static mgulong MGM_Bench_Hash(mgulong hash, const mgbyte* data, size_t bytes)
+{
+	for (size_t i = 0; i < bytes; i++)
+	{
+		hash ^= data[i];
+		hash *= 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+static const mgulong MGM_Bench_HashBasis = 0xcbf29ce484222325ull;
+
+void MGG_Texture_SetData(MGG_GraphicsDevice* device, MGG_Texture* texture, mgint level, mgint slice, mgint x, mgint y, mgint z, mgint width, mgint height, mgint depth, mgbyte* data, mgint dataBytes)
+{
+	assert((size_t)dataBytes <= texture->pixels.size());
+
+	memcpy(texture->pixels.data(), data, dataBytes);
+	device->checksum = MGM_Bench_Hash(device->checksum, data, dataBytes);
+	device->uploads++;
+}
+
+
+struct MGM_BenchResult
+{
+	std::string name;
+	const char* kind;
+	double mediaSeconds = 0;
+	double wallSeconds = 0;
+	std::vector<double> latencies;
+	double worstSeekMS = 0;
+	bool seekFailed = false;
+	mgulong checksum = MGM_Bench_HashBasis;
+};
+
+static double MGM_Bench_ElapsedMS(MGM_BenchClock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(MGM_BenchClock::now() - start).count();
+}
+
+static double MGM_Bench_Percentile(std::vector<double>& sorted, double percent)
+{
+	if (sorted.empty())
+		return 0;
+
+	auto index = (size_t)((percent / 100.0) * (sorted.size() - 1) + 0.5);
+	return sorted[std::min(index, sorted.size() - 1)];
+}
+
+// Seeks to a few points and checks the output matches what
+// we got there when decoding straight thru the file.
+static void MGM_Bench_CheckSeeks(MGM_AudioDecoder* decoder, const MGM_AudioDecoderInfo& info, const std::vector<mgshort>& pcm, MGM_BenchResult& result)
+{
+	auto frames = pcm.size() / info.channels;
+
+	for (auto percent : { 10, 50, 90 })
+	{
+		auto timeMS = (info.duration * percent) / 100;
+		auto frame = (size_t)((timeMS * info.samplerate) / 1000);
+		if (frame >= frames)
+			continue;
+
+		auto start = MGM_BenchClock::now();
+
+		mgbyte* buffer;
+		mguint size;
+		MGM_AudioDecoder_SetPosition(decoder, timeMS);
+		MGM_AudioDecoder_Decode(decoder, buffer, size);
+
+		result.worstSeekMS = std::max(result.worstSeekMS, MGM_Bench_ElapsedMS(start));
+
+		auto samples = (const mgshort*)buffer;
+		auto count = std::min<size_t>(size / sizeof(mgshort), pcm.size() - (frame * info.channels));
+		for (size_t i = 0; i < count; i++)
+		{
+			if (abs(samples[i] - pcm[(frame * info.channels) + i]) > MGM_Bench_SeekTolerance)
+			{
+				result.seekFailed = true;
+				break;
+			}
+		}
+	}
+}
+
+static bool MGM_Bench_Audio(const std::string& path, MGM_BenchResult& result)
+{
+	MGM_AudioDecoderInfo info;
+	auto decoder = MGM_AudioDecoder_Create((mgbyte*)path.c_str(), info);
+	if (decoder == nullptr)
+		return false;
+
+	result.kind = "audio";
+
+	// Keep it all to check the seeks against.
+	std::vector<mgshort> pcm;
+
+	auto start = MGM_BenchClock::now();
+	while (true)
+	{
+		auto call = MGM_BenchClock::now();
+
+		mgbyte* buffer;
+		mguint size;
+		auto ended = MGM_AudioDecoder_Decode(decoder, buffer, size);
+
+		result.latencies.push_back(MGM_Bench_ElapsedMS(call));
+		result.checksum = MGM_Bench_Hash(result.checksum, buffer, size);
+		pcm.insert(pcm.end(), (const mgshort*)buffer, (const mgshort*)(buffer + size));
+
+		if (ended)
+			break;
+	}
+
+	result.wallSeconds = MGM_Bench_ElapsedMS(start) / 1000.0;
+	result.mediaSeconds = (double)(pcm.size() / info.channels) / info.samplerate;
+
+	MGM_Bench_CheckSeeks(decoder, info, pcm, result);
+
+	MGM_AudioDecoder_Destroy(decoder);
+	return true;
+}
+
+static bool MGM_Bench_Video(const std::string& path, MGM_BenchResult& result)
+{
+	MGG_GraphicsDevice device = { MGM_Bench_HashBasis, 0 };
+
+	MGM_VideoDecoderInfo info;
+	auto decoder = MGM_VideoDecoder_Create(&device, (mgbyte*)path.c_str(), info);
+	if (decoder == nullptr)
+		return false;
+
+	result.kind = "video";
+
+	// Take every frame as fast as it decodes.
+	auto threaded = dynamic_cast<MGM_VideoDecoder_Threaded*>(decoder);
+	if (threaded)
+		threaded->SetPaced(false);
+
+	mgint frames = 0;
+	MGG_Texture* last = nullptr;
+
+	auto start = MGM_BenchClock::now();
+	while (true)
+	{
+		auto call = MGM_BenchClock::now();
+		auto texture = MGM_VideoDecoder_Decode(decoder);
+		result.latencies.push_back(MGM_Bench_ElapsedMS(call));
+
+		if (texture == nullptr)
+			break;
+
+		// Paced decoders return the same frame until the next is due.
+		if (texture != last || threaded)
+			frames++;
+		last = texture;
+	}
+
+	result.wallSeconds = MGM_Bench_ElapsedMS(start) / 1000.0;
+	result.mediaSeconds = info.fps > 0 ? frames / info.fps : 0;
+	result.checksum = device.checksum;
+
+	MGM_VideoDecoder_Destroy(decoder);
+	return true;
+}
+
+static std::map<std::string, std::string> MGM_Bench_ReadChecksums(const std::filesystem::path& path)
+{
+	std::map<std::string, std::string> checksums;
+
+	std::ifstream file(path);
+	std::string name, checksum;
+	while (file >> name >> checksum)
+		checksums[name] = checksum;
+
+	return checksums;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: mgmbench <corpus directory> [--update]\n");
+		return 2;
+	}
+
+	std::filesystem::path corpus(argv[1]);
+	auto update = argc > 2 && strcmp(argv[2], "--update") == 0;
+
+	// Keep the seek index sidecars out of the corpus.
+	auto sidecars = std::filesystem::temp_directory_path() / "mgmbench";
+	std::filesystem::create_directories(sidecars);
+	MGM_SeekIndex_SetCacheDirectory((mgbyte*)sidecars.string().c_str());
+
+	auto checksumPath = corpus / MGM_Bench_ChecksumFile;
+	auto expected = MGM_Bench_ReadChecksums(checksumPath);
+
+	std::vector<std::string> names;
+	for (auto& entry : std::filesystem::directory_iterator(corpus))
+	{
+		if (entry.is_regular_file() && entry.path().filename() != MGM_Bench_ChecksumFile)
+			names.push_back(entry.path().filename().string());
+	}
+	std::sort(names.begin(), names.end());
+
+	printf("%-28s %-5s %8s %8s %7s %8s %8s %8s %8s %8s  %-16s %s\n",
+		"file", "kind", "media-s", "wall-s", "rtf", "p50-ms", "p90-ms", "p99-ms", "max-ms", "seek-ms", "checksum", "result");
+
+	auto failures = 0;
+	std::map<std::string, std::string> recorded;
+
+	for (auto& name : names)
+	{
+		auto path = (corpus / name).string();
+
+		MGM_BenchResult result;
+		result.name = name;
+
+		if (!MGM_Bench_Audio(path, result) && !MGM_Bench_Video(path, result))
+		{
+			// A file with a reference used to decode, so losing
+			// it is a failure and its reference is kept.
+			auto found = expected.find(name);
+			if (found == expected.end())
+			{
+				printf("%-28s skipped, no decoder\n", name.c_str());
+				continue;
+			}
+
+			printf("%-28s FAILED, no decoder\n", name.c_str());
+			recorded[name] = found->second;
+			failures++;
+			continue;
+		}
+
+		char checksum[17];
+		snprintf(checksum, sizeof(checksum), "%016llx", (unsigned long long)result.checksum);
+		recorded[name] = checksum;
+
+		const char* status = "ok";
+		auto found = expected.find(name);
+		if (update)
+			status = "recorded";
+		else if (found == expected.end())
+			status = "no reference";
+		else if (found->second != checksum)
+			status = "CHECKSUM MISMATCH";
+
+		if (result.seekFailed)
+			status = "SEEK MISMATCH";
+
+		if (strcmp(status, "CHECKSUM MISMATCH") == 0 || result.seekFailed)
+			failures++;
+
+		auto& latencies = result.latencies;
+		std::sort(latencies.begin(), latencies.end());
+
+		printf("%-28s %-5s %8.2f %8.3f %7.1f %8.3f %8.3f %8.3f %8.3f %8.3f  %s %s\n",
+			name.c_str(),
+			result.kind,
+			result.mediaSeconds,
+			result.wallSeconds,
+			result.wallSeconds > 0 ? result.mediaSeconds / result.wallSeconds : 0,
+			MGM_Bench_Percentile(latencies, 50),
+			MGM_Bench_Percentile(latencies, 90),
+			MGM_Bench_Percentile(latencies, 99),
+			latencies.empty() ? 0 : latencies.back(),
+			result.worstSeekMS,
+			checksum,
+			status);
+	}
+
+	if (update)
+	{
+		std::ofstream file(checksumPath);
+		for (auto& pair : recorded)
+			file << pair.first << " " << pair.second << "\n";
+	}
+
+	if (failures > 0)
+		printf("%d failed\n", failures);
+
+	return failures > 0 ? 1 : 0;
+}
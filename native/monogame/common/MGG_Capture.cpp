@@ -0,0 +1,453 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "api_MGG.h"
+#include "api_MGI.h"
+
+#include "mg_common.h"
+#include "MGI_common.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+
+
+enum class MGG_CaptureState
+{
+	Free,
+	Readback,
+	Encoding,
+};
+
+struct MGG_CaptureSlot
+{
+	std::atomic<MGG_CaptureState> state = { MGG_CaptureState::Free };
+
+	MGG_Readback* readback = nullptr;
+	mgint readbackBytes = 0;
+
+	std::string path;
+
+	mgulong sequence = 0;
+	mgulong timeMS = 0;
+	mgint width = 0;
+	mgint height = 0;
+
+	// Filled in before the slot is handed to a worker.
+	mgbyte* pixels = nullptr;
+	mgint pixelBytes = 0;
+	MGSurfaceFormat format = MGSurfaceFormat::Color;
+};
+
+struct MGG_CaptureDone
+{
+	mgulong sequence = 0;
+	mgulong timeMS = 0;
+	mgint width = 0;
+	mgint height = 0;
+	bool succeeded = false;
+	std::vector<mgbyte> encoded;
+};
+
+// Results beyond this are discarded oldest first
+// if the caller never polls for them.
+static const size_t MGG_CaptureMaxDone = 1024;
+
+struct MGG_Capture
+{
+	MGG_GraphicsDevice* device = nullptr;
+
+	MGCaptureFormat format = MGCaptureFormat::Png;
+	mgint quality = 90;
+
+	std::vector<MGG_CaptureSlot*> slots;
+
+	// Single requests waiting for the next update.
+	std::deque<std::string> requests;
+
+	// Periodic capture state.
+	mgfloat fps = 0.0f;
+	std::string pattern;
+	mgulong nextTimeMS = 0;
+	bool periodicStarted = false;
+
+	mgulong sequence = 0;
+	mgint dropped = 0;
+
+	// The result last returned from poll which
+	// is kept alive until the next call.
+	MGG_CaptureDone polled;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<MGG_CaptureSlot*> encodeQueue;
+	std::deque<MGG_CaptureDone> doneQueue;
+	std::vector<std::thread> workers;
+	bool quit = false;
+};
+
+
+static bool MGG_Capture_IsBGRA(MGSurfaceFormat format)
+{
+	return	format == MGSurfaceFormat::Bgra32 ||
+			format == MGSurfaceFormat::Bgr32 ||
+			format == MGSurfaceFormat::Bgra32SRgb ||
+			format == MGSurfaceFormat::Bgr32SRgb;
+}
+
+static bool MGG_Capture_IsRGBA(MGSurfaceFormat format)
+{
+	return	format == MGSurfaceFormat::Color ||
+			format == MGSurfaceFormat::ColorSRgb;
+}
+
+static void MGG_Capture_Encode(MGG_Capture* capture, MGI_Encoder* encoder, MGG_CaptureSlot* slot, MGG_CaptureDone& done)
+{
+	done.sequence = slot->sequence;
+	done.timeMS = slot->timeMS;
+	done.width = slot->width;
+	done.height = slot->height;
+	done.succeeded = false;
+
+	if (MGG_Capture_IsBGRA(slot->format))
+		MGI_ProcessPixels(slot->pixels, slot->width * slot->height, 0, 0, 1);
+	else if (!MGG_Capture_IsRGBA(slot->format))
+		return;
+
+	mgbyte* output;
+	mgint outputBytes;
+
+	if (capture->format == MGCaptureFormat::Jpg)
+		MGI_Encoder_WriteJpg(encoder, slot->pixels, slot->pixelBytes, slot->width, slot->height, capture->quality, output, outputBytes);
+	else
+		MGI_Encoder_WritePng(encoder, slot->pixels, slot->pixelBytes, slot->width, slot->height, output, outputBytes);
+
+	if (output == nullptr)
+		return;
+
+	if (slot->path.empty())
+	{
+		done.encoded.assign(output, output + outputBytes);
+		done.succeeded = true;
+		return;
+	}
+
+	FILE* file = fopen(slot->path.c_str(), "wb");
+	if (file == nullptr)
+		return;
+
+	done.succeeded = fwrite(output, 1, outputBytes, file) == (size_t)outputBytes;
+	fclose(file);
+}
+
+static void MGG_Capture_Worker(MGG_Capture* capture)
+{
+	// Each worker keeps its own encoder so the
+	// output buffers are reused across captures.
+	auto encoder = MGI_Encoder_Create();
+
+	while (true)
+	{
+		MGG_CaptureSlot* slot;
+		{
+			std::unique_lock<std::mutex> lock(capture->mutex);
+			capture->wake.wait(lock, [capture] { return capture->quit || !capture->encodeQueue.empty(); });
+
+			if (capture->encodeQueue.empty())
+				break;
+
+			slot = capture->encodeQueue.front();
+			capture->encodeQueue.pop_front();
+		}
+
+		MGG_CaptureDone done;
+		MGG_Capture_Encode(capture, encoder, slot, done);
+
+		// The pixels are no longer needed, so the
+		// slot can take another capture right away.
+		slot->state = MGG_CaptureState::Free;
+
+		{
+			std::lock_guard<std::mutex> lock(capture->mutex);
+			if (capture->doneQueue.size() >= MGG_CaptureMaxDone)
+				capture->doneQueue.pop_front();
+			capture->doneQueue.push_back(std::move(done));
+		}
+	}
+
+	MGI_Encoder_Destroy(encoder);
+}
+
+MGG_Capture* MGG_Capture_Create(MGG_GraphicsDevice* device, MGCaptureFormat format, mgint quality, mgint maxPending)
+{
+	assert(device != nullptr);
+	assert(maxPending > 0);
+
+	auto capture = new MGG_Capture();
+	capture->device = device;
+	capture->format = format;
+	capture->quality = quality;
+
+	for (int i = 0; i < maxPending; i++)
+		capture->slots.push_back(new MGG_CaptureSlot());
+
+	// Leave a core for the game thread.
+	auto cores = (mgint)std::thread::hardware_concurrency();
+	auto count = std::max(1, std::min(cores - 1, std::min(maxPending, 4)));
+	for (int i = 0; i < count; i++)
+		capture->workers.emplace_back(MGG_Capture_Worker, capture);
+
+	return capture;
+}
+
+void MGG_Capture_Destroy(MGG_Capture* capture)
+{
+	assert(capture != nullptr);
+
+	{
+		std::lock_guard<std::mutex> lock(capture->mutex);
+		capture->quit = true;
+	}
+	capture->wake.notify_all();
+
+	// The workers finish what is already queued.
+	for (auto& worker : capture->workers)
+		worker.join();
+
+	for (auto slot : capture->slots)
+	{
+		if (slot->readback)
+			MGG_Readback_Destroy(capture->device, slot->readback);
+		delete slot;
+	}
+
+	delete capture;
+}
+
+void MGG_Capture_Request(MGG_Capture* capture, const char* path)
+{
+	assert(capture != nullptr);
+	capture->requests.push_back(path ? path : "");
+}
+
+// The pattern comes from the caller, so rather than hand it to
+// printf we fill in its one integer conversion ourselves.  Only
+// '%%' and a single '%d' style conversion with an optional zero
+// flag, width and length are allowed.
+static bool MGG_Capture_FormatPath(const std::string& pattern, mgulong sequence, std::string& path)
+{
+	path.clear();
+
+	int conversions = 0;
+	for (size_t i = 0; i < pattern.size(); i++)
+	{
+		if (pattern[i] != '%')
+		{
+			path += pattern[i];
+			continue;
+		}
+
+		if (++i < pattern.size() && pattern[i] == '%')
+		{
+			path += '%';
+			continue;
+		}
+
+		auto zero = i < pattern.size() && pattern[i] == '0';
+		if (zero)
+			i++;
+
+		size_t width = 0;
+		while (i < pattern.size() && pattern[i] >= '0' && pattern[i] <= '9' && width < 100)
+			width = (width * 10) + (pattern[i++] - '0');
+
+		while (i < pattern.size() && pattern[i] == 'l')
+			i++;
+
+		if (i >= pattern.size() || (pattern[i] != 'd' && pattern[i] != 'i' && pattern[i] != 'u') || ++conversions > 1)
+			return false;
+
+		auto digits = std::to_string((unsigned long long)sequence);
+		if (digits.size() < width)
+			path.append(width - digits.size(), zero ? '0' : ' ');
+		path += digits;
+	}
+
+	return conversions == 1;
+}
+
+void MGG_Capture_SetPeriodic(MGG_Capture* capture, mgfloat fps, const char* pathPattern)
+{
+	assert(capture != nullptr);
+	assert(fps >= 0.0f);
+
+	capture->fps = fps;
+	capture->pattern = pathPattern ? pathPattern : "";
+	capture->periodicStarted = false;
+
+	// A pattern we can't fill in leaves periodic capture off.
+	std::string path;
+	if (!capture->pattern.empty() && !MGG_Capture_FormatPath(capture->pattern, 0, path))
+	{
+		capture->fps = 0.0f;
+		capture->pattern.clear();
+	}
+}
+
+static void MGG_Capture_Harvest(MGG_Capture* capture)
+{
+	bool queued = false;
+
+	for (auto slot : capture->slots)
+	{
+		if (slot->state != MGG_CaptureState::Readback)
+			continue;
+
+		mgbyte* data;
+		mgint dataBytes;
+		MGSurfaceFormat format;
+		if (!MGG_Readback_GetData(capture->device, slot->readback, data, dataBytes, format))
+			continue;
+
+		// The workers read straight from the mapped readback
+		// memory which isn't reused until the slot is free.
+		slot->pixels = data;
+		slot->pixelBytes = dataBytes;
+		slot->format = format;
+		slot->state = MGG_CaptureState::Encoding;
+
+		std::lock_guard<std::mutex> lock(capture->mutex);
+		capture->encodeQueue.push_back(slot);
+		queued = true;
+	}
+
+	if (queued)
+		capture->wake.notify_all();
+}
+
+static bool MGG_Capture_Queue(MGG_Capture* capture, MGG_Texture* texture, mgint width, mgint height, mgulong timeMS, const std::string& path)
+{
+	MGG_CaptureSlot* slot = nullptr;
+	for (auto s : capture->slots)
+	{
+		if (s->state == MGG_CaptureState::Free)
+		{
+			slot = s;
+			break;
+		}
+	}
+
+	if (slot == nullptr)
+	{
+		capture->dropped++;
+		return false;
+	}
+
+	auto dataBytes = width * height * 4;
+	if (slot->readback == nullptr || slot->readbackBytes < dataBytes)
+	{
+		if (slot->readback)
+			MGG_Readback_Destroy(capture->device, slot->readback);
+		slot->readback = MGG_Readback_Create(capture->device, dataBytes);
+		slot->readbackBytes = dataBytes;
+	}
+
+	MGG_Readback_Queue(capture->device, slot->readback, texture, 0, 0, 0, 0, width, height);
+
+	slot->state = MGG_CaptureState::Readback;
+	slot->sequence = capture->sequence++;
+	slot->timeMS = timeMS;
+	slot->width = width;
+	slot->height = height;
+	slot->path = path;
+
+	return true;
+}
+
+void MGG_Capture_Update(MGG_Capture* capture, MGG_Texture* texture, mgint width, mgint height, mgulong timeMS)
+{
+	assert(capture != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// Pass any finished readbacks to the encoders first
+	// so their slots can be reused as soon as possible.
+	MGG_Capture_Harvest(capture);
+
+	while (!capture->requests.empty())
+	{
+		if (!MGG_Capture_Queue(capture, texture, width, height, timeMS, capture->requests.front()))
+			break;
+		capture->requests.pop_front();
+	}
+
+	if (capture->fps <= 0.0f)
+		return;
+
+	if (!capture->periodicStarted)
+	{
+		capture->nextTimeMS = timeMS;
+		capture->periodicStarted = true;
+	}
+
+	if (timeMS < capture->nextTimeMS)
+		return;
+
+	std::string path;
+	if (!capture->pattern.empty())
+		MGG_Capture_FormatPath(capture->pattern, capture->sequence, path);
+
+	MGG_Capture_Queue(capture, texture, width, height, timeMS, path);
+
+	// Advance on a fixed schedule so the recording keeps a steady
+	// rate, but don't try to catch up after a long hitch.
+	auto interval = (mgulong)(1000.0f / capture->fps);
+	capture->nextTimeMS += interval;
+	if (capture->nextTimeMS + interval < timeMS)
+		capture->nextTimeMS = timeMS;
+}
+
+mgbyte MGG_Capture_Poll(MGG_Capture* capture, MGG_Capture_Result& result)
+{
+	assert(capture != nullptr);
+
+	memset(&result, 0, sizeof(result));
+
+	std::lock_guard<std::mutex> lock(capture->mutex);
+
+	if (capture->doneQueue.empty())
+	{
+		capture->polled = MGG_CaptureDone();
+		return false;
+	}
+
+	// This releases the data from the previous poll.
+	capture->polled = std::move(capture->doneQueue.front());
+	capture->doneQueue.pop_front();
+
+	auto& done = capture->polled;
+	result.Sequence = done.sequence;
+	result.TimeMS = done.timeMS;
+	result.Width = done.width;
+	result.Height = done.height;
+	result.Succeeded = done.succeeded;
+
+	if (!done.encoded.empty())
+	{
+		result.Data = done.encoded.data();
+		result.DataBytes = (mgint)done.encoded.size();
+	}
+
+	return true;
+}
+
+mgint MGG_Capture_GetDroppedCount(MGG_Capture* capture)
+{
+	assert(capture != nullptr);
+	return capture->dropped;
+}
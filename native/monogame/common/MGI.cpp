@@ -3,6 +3,10 @@
 // file 'LICENSE.txt', which is part of this source code package.
 
 #include "api_MGI.h"
+#include "MGI_common.h"
+#include "mg_simd.h"
+
+#include <algorithm>
 
 #define STBI_NO_PSD
 #define STBI_NO_BMP
@@ -15,82 +19,674 @@
 #define __STDC_LIB_EXT1__
 #endif
 
+// stb only uses NEON when asked, SSE2 is detected on its own.
+#if defined(MG_SIMD_NEON)
+#define STBI_NEON
+#endif
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
 
+// Optional faster decoders which are enabled by the build.  Both
+// use SIMD for the hot paths and select the instruction set at
+// runtime.  Anything they reject is still decoded by stb_image.
+#if defined(MG_LIBJPEG_TURBO)
+#include <turbojpeg.h>
+#endif
 
-void MGI_ReadRGBA(mgbyte* data, mgint dataBytes, mgbyte zeroTransparentPixels, mgint& width, mgint& height, mgbyte*& rgba)
+#if defined(MG_LIBSPNG)
+#include <spng.h>
+#endif
+
+
+// Fixed point divide by 255 that truncates exactly like
+// the managed DefaultColorProcessors.PremultiplyAlpha.
+static inline mguint MGI_Div255(mguint t)
 {
-	width = 0;
-	height = 0;
-	rgba = nullptr;
+	return (t + 1 + (t >> 8)) >> 8;
+}
 
-	int c, w, h;
-	auto image = stbi_load_from_memory(data, dataBytes, &w, &h, &c, 4);
-	if (image == nullptr)
+static void MGI_ProcessPixels_Scalar(mgbyte* pixels, mgint count, mgbyte zero, mgbyte premultiply, mgbyte swizzle)
+{
+	for (mgint i = 0; i < count; i++, pixels += 4)
+	{
+		mguint r = pixels[0];
+		mguint g = pixels[1];
+		mguint b = pixels[2];
+		mguint a = pixels[3];
+
+		if (zero && a == 0)
+			r = g = b = 0;
+
+		if (premultiply)
+		{
+			r = MGI_Div255(r * a);
+			g = MGI_Div255(g * a);
+			b = MGI_Div255(b * a);
+		}
+
+		pixels[0] = (mgbyte)(swizzle ? b : r);
+		pixels[1] = (mgbyte)g;
+		pixels[2] = (mgbyte)(swizzle ? r : b);
+	}
+}
+
+#if defined(MG_SIMD_SSE2)
+
+static inline __m128i MGI_Premultiply_SSE2(__m128i pixels, __m128i alphaOne, __m128i rgbMask, __m128i one)
+{
+	auto zero = _mm_setzero_si128();
+	auto lo = _mm_unpacklo_epi8(pixels, zero);
+	auto hi = _mm_unpackhi_epi8(pixels, zero);
+
+	// Broadcast alpha to all channels, but multiply alpha itself by 255.
+	auto alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	auto ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	alo = _mm_or_si128(_mm_and_si128(alo, rgbMask), alphaOne);
+	ahi = _mm_or_si128(_mm_and_si128(ahi, rgbMask), alphaOne);
+
+	lo = _mm_mullo_epi16(lo, alo);
+	hi = _mm_mullo_epi16(hi, ahi);
+	lo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(lo, one), _mm_srli_epi16(lo, 8)), 8);
+	hi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(hi, one), _mm_srli_epi16(hi, 8)), 8);
+
+	return _mm_packus_epi16(lo, hi);
+}
+
+static void MGI_ProcessPixels_SSE2(mgbyte* pixels, mgint count, mgbyte zero, mgbyte premultiply, mgbyte swizzle)
+{
+	const auto alphaMask = _mm_set1_epi32((int)0xFF000000);
+	const auto greenAlphaMask = _mm_set1_epi32((int)0xFF00FF00);
+	const auto redMask = _mm_set1_epi32(0x000000FF);
+	const auto alphaOne = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+	const auto rgbMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+	const auto one = _mm_set1_epi16(1);
+
+	mgint i = 0;
+	for (; i + 4 <= count; i += 4, pixels += 16)
+	{
+		auto v = _mm_loadu_si128((const __m128i*)pixels);
+
+		if (zero)
+		{
+			auto transparent = _mm_cmpeq_epi32(_mm_and_si128(v, alphaMask), _mm_setzero_si128());
+			v = _mm_andnot_si128(transparent, v);
+		}
+
+		if (premultiply)
+			v = MGI_Premultiply_SSE2(v, alphaOne, rgbMask, one);
+
+		if (swizzle)
+		{
+			auto ga = _mm_and_si128(v, greenAlphaMask);
+			auto r = _mm_slli_epi32(_mm_and_si128(v, redMask), 16);
+			auto b = _mm_and_si128(_mm_srli_epi32(v, 16), redMask);
+			v = _mm_or_si128(ga, _mm_or_si128(r, b));
+		}
+
+		_mm_storeu_si128((__m128i*)pixels, v);
+	}
+
+	MGI_ProcessPixels_Scalar(pixels, count - i, zero, premultiply, swizzle);
+}
+
+MG_TARGET_AVX2 static void MGI_ProcessPixels_AVX2(mgbyte* pixels, mgint count, mgbyte zero, mgbyte premultiply, mgbyte swizzle)
+{
+	const auto alphaMask = _mm256_set1_epi32((int)0xFF000000);
+	const auto alphaOne = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+	const auto one = _mm256_set1_epi16(1);
+	const auto alphaShuffle = _mm256_setr_epi8(
+		6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15,
+		6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15);
+	const auto bgraShuffle = _mm256_setr_epi8(
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	const auto rgbMask = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+
+	mgint i = 0;
+	for (; i + 8 <= count; i += 8, pixels += 32)
+	{
+		auto v = _mm256_loadu_si256((const __m256i*)pixels);
+
+		if (zero)
+		{
+			auto transparent = _mm256_cmpeq_epi32(_mm256_and_si256(v, alphaMask), _mm256_setzero_si256());
+			v = _mm256_andnot_si256(transparent, v);
+		}
+
+		if (premultiply)
+		{
+			auto lo = _mm256_unpacklo_epi8(v, _mm256_setzero_si256());
+			auto hi = _mm256_unpackhi_epi8(v, _mm256_setzero_si256());
+			auto alo = _mm256_or_si256(_mm256_and_si256(_mm256_shuffle_epi8(lo, alphaShuffle), rgbMask), alphaOne);
+			auto ahi = _mm256_or_si256(_mm256_and_si256(_mm256_shuffle_epi8(hi, alphaShuffle), rgbMask), alphaOne);
+			lo = _mm256_mullo_epi16(lo, alo);
+			hi = _mm256_mullo_epi16(hi, ahi);
+			lo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(lo, one), _mm256_srli_epi16(lo, 8)), 8);
+			hi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(hi, one), _mm256_srli_epi16(hi, 8)), 8);
+			v = _mm256_packus_epi16(lo, hi);
+		}
+
+		if (swizzle)
+			v = _mm256_shuffle_epi8(v, bgraShuffle);
+
+		_mm256_storeu_si256((__m256i*)pixels, v);
+	}
+
+	MGI_ProcessPixels_SSE2(pixels, count - i, zero, premultiply, swizzle);
+}
+
+#elif defined(MG_SIMD_NEON)
+
+static inline uint8x8_t MGI_Div255_NEON(uint16x8_t t)
+{
+	return vshrn_n_u16(vaddq_u16(vaddq_u16(t, vdupq_n_u16(1)), vshrq_n_u16(t, 8)), 8);
+}
+
+static inline uint8x16_t MGI_Premultiply_NEON(uint8x16_t c, uint8x16_t a)
+{
+	auto lo = MGI_Div255_NEON(vmull_u8(vget_low_u8(c), vget_low_u8(a)));
+	auto hi = MGI_Div255_NEON(vmull_u8(vget_high_u8(c), vget_high_u8(a)));
+	return vcombine_u8(lo, hi);
+}
+
+static void MGI_ProcessPixels_NEON(mgbyte* pixels, mgint count, mgbyte zero, mgbyte premultiply, mgbyte swizzle)
+{
+	mgint i = 0;
+	for (; i + 16 <= count; i += 16, pixels += 64)
 	{
-		width = 0;
-		height = 0;
+		auto v = vld4q_u8(pixels);
+
+		if (zero)
+		{
+			auto transparent = vceqq_u8(v.val[3], vdupq_n_u8(0));
+			v.val[0] = vbicq_u8(v.val[0], transparent);
+			v.val[1] = vbicq_u8(v.val[1], transparent);
+			v.val[2] = vbicq_u8(v.val[2], transparent);
+		}
+
+		if (premultiply)
+		{
+			v.val[0] = MGI_Premultiply_NEON(v.val[0], v.val[3]);
+			v.val[1] = MGI_Premultiply_NEON(v.val[1], v.val[3]);
+			v.val[2] = MGI_Premultiply_NEON(v.val[2], v.val[3]);
+		}
+
+		if (swizzle)
+		{
+			auto r = v.val[0];
+			v.val[0] = v.val[2];
+			v.val[2] = r;
+		}
+
+		vst4q_u8(pixels, v);
+	}
+
+	MGI_ProcessPixels_Scalar(pixels, count - i, zero, premultiply, swizzle);
+}
+
+#endif
+
+void MGI_ProcessPixels(mgbyte* pixels, mgint count, mgbyte zero, mgbyte premultiply, mgbyte swizzle)
+{
+	if (!zero && !premultiply && !swizzle)
 		return;
+
+#if defined(MG_SIMD_SSE2)
+	if (MG_CPU_HasAVX2())
+		MGI_ProcessPixels_AVX2(pixels, count, zero, premultiply, swizzle);
+	else
+		MGI_ProcessPixels_SSE2(pixels, count, zero, premultiply, swizzle);
+#elif defined(MG_SIMD_NEON)
+	MGI_ProcessPixels_NEON(pixels, count, zero, premultiply, swizzle);
+#else
+	MGI_ProcessPixels_Scalar(pixels, count, zero, premultiply, swizzle);
+#endif
+}
+
+// Box filtering is split into accumulating rows and resolving
+// them so a decoder can stream rows in without ever holding the
+// full resolution image.
+//
+// The color is weighted by alpha so transparent pixels don't bleed
+// their color into the result.  The output is still straight alpha
+// and premultiplying it gives the average of the premultiplied pixels.
+static void MGI_Box_AccumulateRow(const mgbyte* row, int width, int scale, mguint* sums)
+{
+	for (int x = 0; x < width; x++, row += 4)
+	{
+		auto sum = sums + (x / scale) * 4;
+		mguint a = row[3];
+		sum[0] += row[0] * a;
+		sum[1] += row[1] * a;
+		sum[2] += row[2] * a;
+		sum[3] += a;
 	}
+}
 
-	// If the original image before conversion had alpha,
-	// black out pixels with an alpha of zero (XNA behavior).
-	if (zeroTransparentPixels && c == 4)
+static void MGI_Box_ResolveRow(mguint* sums, int width, int scale, int rows, mgbyte* output)
+{
+	auto outputWidth = (width + scale - 1) / scale;
+
+	for (int x = 0; x < outputWidth; x++, sums += 4, output += 4)
 	{
-		auto byteCount = w * h * 4;
-		for (int i = 0; i < byteCount; i += 4)
+		// The last column and row may cover fewer pixels.
+		auto columns = std::min(scale, width - x * scale);
+		auto count = (mguint)(columns * rows);
+		auto alpha = sums[3];
+
+		if (alpha == 0)
 		{
-			if (image[i + 3] == 0)
-			{
-				image[i + 0] = 0;
-				image[i + 1] = 0;
-				image[i + 2] = 0;
-			}
+			output[0] = output[1] = output[2] = 0;
+		}
+		else
+		{
+			auto half = alpha / 2;
+			output[0] = (mgbyte)((sums[0] + half) / alpha);
+			output[1] = (mgbyte)((sums[1] + half) / alpha);
+			output[2] = (mgbyte)((sums[2] + half) / alpha);
 		}
+
+		output[3] = (mgbyte)((alpha + count / 2) / count);
+
+		sums[0] = sums[1] = sums[2] = sums[3] = 0;
 	}
+}
 
-	rgba = image;
+static mgbyte* MGI_Box_Downsample(const mgbyte* image, int width, int height, int scale, int& outputWidth, int& outputHeight)
+{
+	outputWidth = (width + scale - 1) / scale;
+	outputHeight = (height + scale - 1) / scale;
+
+	auto output = (mgbyte*)malloc((size_t)outputWidth * outputHeight * 4);
+	if (output == nullptr)
+		return nullptr;
+
+	std::vector<mguint> sums(outputWidth * 4);
+
+	for (int y = 0; y < outputHeight; y++)
+	{
+		auto rows = std::min(scale, height - y * scale);
+		for (int r = 0; r < rows; r++)
+			MGI_Box_AccumulateRow(image + ((size_t)(y * scale + r) * width * 4), width, scale, sums.data());
+
+		MGI_Box_ResolveRow(sums.data(), width, scale, rows, output + (size_t)y * outputWidth * 4);
+	}
+
+	return output;
+}
+
+#if defined(MG_LIBJPEG_TURBO)
+
+static mgbyte* MGI_DecodeJpg_Turbo(mgbyte* data, mgint dataBytes, int scale, int& width, int& height, int& components)
+{
+	auto handle = tjInitDecompress();
+	if (handle == nullptr)
+		return nullptr;
+
+	int w, h, subsamp, colorspace;
+	mgbyte* image = nullptr;
+
+	if (tjDecompressHeader3(handle, data, dataBytes, &w, &h, &subsamp, &colorspace) == 0)
+	{
+		// Scaling happens in the DCT domain, so a smaller
+		// image is cheaper to decode and never expanded.
+		tjscalingfactor factor = { 1, scale };
+		w = TJSCALED(w, factor);
+		h = TJSCALED(h, factor);
+
+		image = (mgbyte*)malloc((size_t)w * h * 4);
+
+		// The accurate IDCT keeps us as close as possible to stb.
+		if (image && tjDecompress2(handle, data, dataBytes, image, w, 0, h, TJPF_RGBA, TJFLAG_ACCURATEDCT) != 0)
+		{
+			free(image);
+			image = nullptr;
+		}
+	}
+
+	tjDestroy(handle);
+
+	if (image == nullptr)
+		return nullptr;
+
+	// JPEG never has alpha.
 	width = w;
 	height = h;
+	components = 3;
+	return image;
+}
+
+#endif
+
+#if defined(MG_LIBSPNG)
+
+static mgbyte* MGI_DecodePng_SpngRows(spng_ctx* ctx, const spng_ihdr& ihdr, int scale)
+{
+	if (spng_decode_image(ctx, nullptr, 0, SPNG_FMT_RGBA8, SPNG_DECODE_TRNS | SPNG_DECODE_PROGRESSIVE) != 0)
+		return nullptr;
+
+	int width = ihdr.width;
+	int height = ihdr.height;
+	auto outputWidth = (width + scale - 1) / scale;
+	auto outputHeight = (height + scale - 1) / scale;
+
+	auto image = (mgbyte*)malloc((size_t)outputWidth * outputHeight * 4);
+	if (image == nullptr)
+		return nullptr;
+
+	std::vector<mgbyte> row(width * 4);
+	std::vector<mguint> sums(outputWidth * 4);
+
+	// Only a single decoded row is ever held in memory.
+	for (int y = 0; y < height; y++)
+	{
+		auto error = spng_decode_row(ctx, row.data(), row.size());
+		if (error != 0 && !(error == SPNG_EOI && y == height - 1))
+		{
+			free(image);
+			return nullptr;
+		}
+
+		MGI_Box_AccumulateRow(row.data(), width, scale, sums.data());
+
+		auto rows = (y % scale) + 1;
+		if (rows == scale || y == height - 1)
+			MGI_Box_ResolveRow(sums.data(), width, scale, rows, image + (size_t)(y / scale) * outputWidth * 4);
+	}
+
+	return image;
 }
 
-struct mem_image
+static mgbyte* MGI_DecodePng_Spng(mgbyte* data, mgint dataBytes, int scale, int& width, int& height, int& components)
 {
-	static const size_t grow = 4096;
+	auto ctx = spng_ctx_new(0);
+	if (ctx == nullptr)
+		return nullptr;
 
-	mem_image()
+	// stb_image doesn't check CRCs, so neither do we.
+	spng_set_crc_action(ctx, SPNG_CRC_USE, SPNG_CRC_USE);
+	spng_set_png_buffer(ctx, data, dataBytes);
+
+	mgbyte* image = nullptr;
+	spng_ihdr ihdr;
+	size_t imageBytes;
+
+	if (spng_get_ihdr(ctx, &ihdr) == 0)
+	{
+		width = ihdr.width;
+		height = ihdr.height;
+
+		// Interlaced images arrive a pass at a time, so
+		// those are decoded in full and then downsampled.
+		if (scale > 1 && ihdr.interlace_method == SPNG_INTERLACE_NONE)
+		{
+			image = MGI_DecodePng_SpngRows(ctx, ihdr, scale);
+			width = (width + scale - 1) / scale;
+			height = (height + scale - 1) / scale;
+		}
+		else if (spng_decoded_image_size(ctx, SPNG_FMT_RGBA8, &imageBytes) == 0)
+		{
+			image = (mgbyte*)malloc(imageBytes);
+			if (image && spng_decode_image(ctx, image, imageBytes, SPNG_FMT_RGBA8, SPNG_DECODE_TRNS) != 0)
+			{
+				free(image);
+				image = nullptr;
+			}
+
+			if (image && scale > 1)
+			{
+				auto full = image;
+				image = MGI_Box_Downsample(full, width, height, scale, width, height);
+				free(full);
+			}
+		}
+	}
+
+	if (image != nullptr)
 	{
-		dataBytes = grow;
-		data = (mgbyte*)malloc(grow);
-		offset = 0;
+		// Report the same component count stb_image would so the
+		// alpha processing matches.  It only counts a tRNS chunk
+		// as alpha when the image is paletted.
+		spng_trns trns;
+		auto hasTrns = spng_get_trns(ctx, &trns) == 0;
+
+		components = 3;
+		if (ihdr.color_type == SPNG_COLOR_TYPE_TRUECOLOR_ALPHA ||
+			(ihdr.color_type == SPNG_COLOR_TYPE_INDEXED && hasTrns))
+			components = 4;
 	}
 
-	mgbyte* data;
-	mgint dataBytes;
-	size_t offset;
+	spng_ctx_free(ctx);
+
+	return image;
+}
+
+#endif
+
+static mgbyte* MGI_Decode(mgbyte* data, mgint dataBytes, int scale, int& width, int& height, int& components)
+{
+	mgbyte* image = nullptr;
+
+#if defined(MG_LIBJPEG_TURBO)
+	if (dataBytes > 2 && data[0] == 0xFF && data[1] == 0xD8)
+		image = MGI_DecodeJpg_Turbo(data, dataBytes, scale, width, height, components);
+#endif
+
+#if defined(MG_LIBSPNG)
+	static const mgbyte signature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+	if (dataBytes > 8 && memcmp(data, signature, 8) == 0)
+		image = MGI_DecodePng_Spng(data, dataBytes, scale, width, height, components);
+#endif
+
+	if (image != nullptr)
+		return image;
+
+	image = stbi_load_from_memory(data, dataBytes, &width, &height, &components, 4);
+
+	// stb can't decode at a lower resolution, so
+	// the best we can do is free the full image early.
+	if (image != nullptr && scale > 1)
+	{
+		auto full = image;
+		image = MGI_Box_Downsample(full, width, height, scale, width, height);
+		stbi_image_free(full);
+	}
+
+	return image;
+}
+
+void MGI_ReadRGBAScaled(mgbyte* data, mgint dataBytes, MGImageReadFlags flags, mgint scale, mgint& width, mgint& height, mgbyte*& rgba)
+{
+	assert(scale == 1 || scale == 2 || scale == 4 || scale == 8);
+
+	width = 0;
+	height = 0;
+	rgba = nullptr;
+
+	int c, w, h;
+	auto image = MGI_Decode(data, dataBytes, scale, w, h, c);
+	if (image == nullptr)
+		return;
+
+	auto bits = (mgbyte)flags;
+
+	// If the original image before conversion had alpha,
+	// black out pixels with an alpha of zero (XNA behavior).
+	//
+	// Premultiplying is only needed when there was alpha, but
+	// the swizzle must always be applied.
+	//
+	// All of these are done in a single pass over the pixels.
+	mgbyte hasAlpha = c == 4;
+	mgbyte zero = hasAlpha && (bits & (mgbyte)MGImageReadFlags::ZeroTransparentPixels);
+	mgbyte premultiply = hasAlpha && (bits & (mgbyte)MGImageReadFlags::PremultiplyAlpha);
+	mgbyte swizzle = (bits & (mgbyte)MGImageReadFlags::SwizzleBGRA) != 0;
+	MGI_ProcessPixels(image, w * h, zero, premultiply, swizzle);
+
+	rgba = image;
+	width = w;
+	height = h;
+}
+
+void MGI_ReadRGBA(mgbyte* data, mgint dataBytes, MGImageReadFlags flags, mgint& width, mgint& height, mgbyte*& rgba)
+{
+	MGI_ReadRGBAScaled(data, dataBytes, flags, 1, width, height, rgba);
+}
+
+struct MGI_Encoder
+{
+	mgbyte* data = nullptr;
+	size_t capacity = 0;
+	size_t offset = 0;
+	bool failed = false;
 };
 
-static void mem_image_write(void* context, void* data, int size)
+static bool MGI_Encoder_Reserve(MGI_Encoder* encoder, size_t capacity)
 {
-	mem_image* image = (mem_image*)context;
+	if (capacity <= encoder->capacity)
+		return true;
 
-	size_t offset = image->offset + size;
+	auto data = (mgbyte*)realloc(encoder->data, capacity);
+	if (data == nullptr)
+		return false;
+
+	encoder->data = data;
+	encoder->capacity = capacity;
+	return true;
+}
+
+static void MGI_Encoder_Begin(MGI_Encoder* encoder, size_t estimate)
+{
+	encoder->offset = 0;
+	encoder->failed = !MGI_Encoder_Reserve(encoder, estimate);
+}
+
+static void MGI_Encoder_Write(void* context, void* data, int size)
+{
+	auto encoder = (MGI_Encoder*)context;
+	if (encoder->failed)
+		return;
 
+	size_t offset = encoder->offset + size;
 
-	if (offset > image->dataBytes)
+	if (offset > encoder->capacity)
 	{
-		// TODO:  Need a better strategy for memory growth.
-		// TODO:  Need to handle allocation failure gracefully.
-		image->dataBytes = (mgint)(offset + mem_image::grow); // Need a better algo!
-		image->data = (mgbyte*)realloc(image->data, image->dataBytes);
+		// Grow geometrically so that the total copying
+		// stays linear with the size of the output.
+		auto capacity = encoder->capacity * 2;
+		if (capacity < offset)
+			capacity = offset;
+
+		if (!MGI_Encoder_Reserve(encoder, capacity))
+		{
+			encoder->failed = true;
+			return;
+		}
 	}
 
-	memcpy(image->data + image->offset, data, size);
-	image->offset = offset;
+	memcpy(encoder->data + encoder->offset, data, size);
+	encoder->offset = offset;
+}
+
+static size_t MGI_EstimateJpgBytes(mgint width, mgint height, mgint quality)
+{
+	// Typical photographic content encodes to around 1 to 3 bits
+	// per pixel depending on quality, plus the fixed headers.
+	size_t pixels = (size_t)width * height;
+	size_t bits = quality >= 90 ? 4 : (quality >= 50 ? 2 : 1);
+	return 1024 + (pixels * bits) / 8;
+}
+
+static size_t MGI_EstimatePngBytes(mgint width, mgint height)
+{
+	// Stb emits the whole PNG in a single write, so reserve
+	// enough for a mostly incompressible image up front.
+	size_t raw = ((size_t)width * 4 + 1) * height;
+	return 1024 + raw + (raw / 64);
+}
+
+static bool MGI_Encoder_EncodeJpg(MGI_Encoder* encoder, mgbyte* data, mgint width, mgint height, mgint quality)
+{
+	MGI_Encoder_Begin(encoder, MGI_EstimateJpgBytes(width, height, quality));
+	if (encoder->failed)
+		return false;
+
+	auto result = stbi_write_jpg_to_func(MGI_Encoder_Write, encoder, width, height, 4, data, quality);
+	return result != 0 && !encoder->failed;
+}
+
+static bool MGI_Encoder_EncodePng(MGI_Encoder* encoder, mgbyte* data, mgint width, mgint height)
+{
+	MGI_Encoder_Begin(encoder, MGI_EstimatePngBytes(width, height));
+	if (encoder->failed)
+		return false;
+
+	auto result = stbi_write_png_to_func(MGI_Encoder_Write, encoder, width, height, 4, data, width * 4);
+	return result != 0 && !encoder->failed;
+}
+
+MGI_Encoder* MGI_Encoder_Create()
+{
+	return new MGI_Encoder();
+}
+
+void MGI_Encoder_Destroy(MGI_Encoder* encoder)
+{
+	assert(encoder != nullptr);
+	free(encoder->data);
+	delete encoder;
+}
+
+void MGI_Encoder_WriteJpg(MGI_Encoder* encoder, mgbyte* data, mgint dataBytes, mgint width, mgint height, mgint quality, mgbyte*& jpg, mgint& jpgBytes)
+{
+	assert(encoder != nullptr);
+
+	jpg = nullptr;
+	jpgBytes = 0;
+
+	if (!MGI_Encoder_EncodeJpg(encoder, data, width, height, quality))
+		return;
+
+	jpg = encoder->data;
+	jpgBytes = (mgint)encoder->offset;
+}
+
+void MGI_Encoder_WritePng(MGI_Encoder* encoder, mgbyte* data, mgint dataBytes, mgint width, mgint height, mgbyte*& png, mgint& pngBytes)
+{
+	assert(encoder != nullptr);
+
+	png = nullptr;
+	pngBytes = 0;
+
+	if (!MGI_Encoder_EncodePng(encoder, data, width, height))
+		return;
+
+	png = encoder->data;
+	pngBytes = (mgint)encoder->offset;
+}
+
+static void MGI_Encoder_Detach(MGI_Encoder& encoder, mgbyte*& output, mgint& outputBytes)
+{
+	// Nothing was encoded, so the caller frees the buffer.  A
+	// realloc to zero bytes may free it and return null.
+	if (encoder.offset == 0)
+		return;
+
+	// Hand the buffer over to the caller trimmed to the encoded
+	// size.  If the trim fails the untrimmed buffer is still good.
+	auto data = (mgbyte*)realloc(encoder.data, encoder.offset);
+	if (data != nullptr)
+		encoder.data = data;
+
+	output = encoder.data;
+	outputBytes = (mgint)encoder.offset;
+
+	encoder.data = nullptr;
+	encoder.capacity = 0;
 }
 
 void MGI_WriteJpg(mgbyte* data, mgint dataBytes, mgint width, mgint height, mgint quality, mgbyte*& jpg, mgint& jpgBytes)
@@ -98,11 +694,11 @@ void MGI_WriteJpg(mgbyte* data, mgint dataBytes, mgint width, mgint height, mgin
 	jpg = nullptr;
 	jpgBytes = 0;
 
-	mem_image image;
-	stbi_write_jpg_to_func(mem_image_write, &image, width, height, 4, data, quality);
+	MGI_Encoder encoder;
+	if (MGI_Encoder_EncodeJpg(&encoder, data, width, height, quality))
+		MGI_Encoder_Detach(encoder, jpg, jpgBytes);
 
-	jpg = (mgbyte*)realloc(image.data, image.offset);
-	jpgBytes = image.dataBytes;
+	free(encoder.data);
 }
 
 void MGI_WritePng(mgbyte* data, mgint dataBytes, mgint width, mgint height, mgbyte*& png, mgint& pngBytes)
@@ -110,9 +706,9 @@ void MGI_WritePng(mgbyte* data, mgint dataBytes, mgint width, mgint height, mgby
 	png = nullptr;
 	pngBytes = 0;
 
-	mem_image image;
-	stbi_write_png_to_func(mem_image_write, &image, width, height, 4, data, 4);
+	MGI_Encoder encoder;
+	if (MGI_Encoder_EncodePng(&encoder, data, width, height))
+		MGI_Encoder_Detach(encoder, png, pngBytes);
 
-	png = (mgbyte*)realloc(image.data, image.offset);
-	pngBytes = image.dataBytes;
+	free(encoder.data);
 }
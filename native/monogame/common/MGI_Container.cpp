@@ -0,0 +1,468 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "api_MGI.h"
+#include "mg_common.h"
+
+#include <string.h>
+#include <algorithm>
+
+
+// Parsing of DDS and KTX2 texture containers.
+//
+// Nothing is decoded here.  The caller gets the format and
+// the location of each subresource within the source buffer
+// which can be passed directly to MGG_Texture_SetData.
+
+
+static mguint MGI_Read32(const mgbyte* data)
+{
+	mguint value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static mgulong MGI_Read64(const mgbyte* data)
+{
+	mgulong value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static bool MGI_GetBlockInfo(MGSurfaceFormat format, mgint& blockSize, mgint& blockBytes)
+{
+	blockSize = 1;
+
+	switch (format)
+	{
+	case MGSurfaceFormat::Dxt1:
+	case MGSurfaceFormat::Dxt1SRgb:
+	case MGSurfaceFormat::Dxt1a:
+	case MGSurfaceFormat::Rgb8Etc2:
+	case MGSurfaceFormat::Srgb8Etc2:
+	case MGSurfaceFormat::Rgb8A1Etc2:
+	case MGSurfaceFormat::Srgb8A1Etc2:
+		blockSize = 4;
+		blockBytes = 8;
+		return true;
+	case MGSurfaceFormat::Dxt3:
+	case MGSurfaceFormat::Dxt3SRgb:
+	case MGSurfaceFormat::Dxt5:
+	case MGSurfaceFormat::Dxt5SRgb:
+	case MGSurfaceFormat::Rgba8Etc2:
+	case MGSurfaceFormat::SRgb8A8Etc2:
+	case MGSurfaceFormat::Astc4X4Rgba:
+		blockSize = 4;
+		blockBytes = 16;
+		return true;
+	case MGSurfaceFormat::Alpha8:
+		blockBytes = 1;
+		return true;
+	case MGSurfaceFormat::Bgr565:
+	case MGSurfaceFormat::Bgra4444:
+	case MGSurfaceFormat::Bgra5551:
+		blockBytes = 2;
+		return true;
+	case MGSurfaceFormat::Color:
+	case MGSurfaceFormat::ColorSRgb:
+	case MGSurfaceFormat::Single:
+	case MGSurfaceFormat::Rg32:
+	case MGSurfaceFormat::HalfVector2:
+	case MGSurfaceFormat::Rgba1010102:
+	case MGSurfaceFormat::Bgra32:
+	case MGSurfaceFormat::Bgra32SRgb:
+	case MGSurfaceFormat::Bgr32:
+	case MGSurfaceFormat::Bgr32SRgb:
+		blockBytes = 4;
+		return true;
+	case MGSurfaceFormat::HalfVector4:
+	case MGSurfaceFormat::Rgba64:
+	case MGSurfaceFormat::Vector2:
+		blockBytes = 8;
+		return true;
+	case MGSurfaceFormat::Vector4:
+		blockBytes = 16;
+		return true;
+	default:
+		return false;
+	}
+}
+
+static mgulong MGI_GetImageBytes(MGSurfaceFormat format, mgint width, mgint height, mgint depth)
+{
+	mgint blockSize, blockBytes;
+	MGI_GetBlockInfo(format, blockSize, blockBytes);
+
+	mgulong columns = (width + blockSize - 1) / blockSize;
+	mgulong rows = (height + blockSize - 1) / blockSize;
+	return columns * rows * blockBytes * depth;
+}
+
+// Reject anything larger than any device supports
+// before we start walking the subresources.
+static bool MGI_IsValidInfo(const MGI_ContainerInfo& info)
+{
+	return	info.Width > 0 && info.Width <= 16384 &&
+			info.Height > 0 && info.Height <= 16384 &&
+			info.Depth > 0 && info.Depth <= 2048 &&
+			info.Mipmaps > 0 && info.Mipmaps <= 15 &&
+			info.Slices > 0 && info.Slices <= 2048 * 6;
+}
+
+// Fills in the subresources in the order MGG_Texture_SetData
+// indexes them, slice major with each slice holding every level.
+struct MGI_ContainerLayout
+{
+	mgbyte* data;
+	mgulong dataBytes;
+	MGI_ContainerInfo& info;
+	MGI_ContainerLevel* levels;
+	mgint levelCount;
+
+	bool Add(mgint level, mgint slice, mgulong offset)
+	{
+		auto width = std::max(1, info.Width >> level);
+		auto height = std::max(1, info.Height >> level);
+		auto depth = std::max(1, info.Depth >> level);
+		auto bytes = MGI_GetImageBytes(info.Format, width, height, depth);
+
+		if (offset > dataBytes || bytes > dataBytes - offset)
+			return false;
+
+		auto index = slice * info.Mipmaps + level;
+		if (levels == nullptr || index >= levelCount)
+			return true;
+
+		auto& out = levels[index];
+		out.Level = level;
+		out.Slice = slice;
+		out.Width = width;
+		out.Height = height;
+		out.Depth = depth;
+		out.Offset = (mgint)offset;
+		out.Data = data + offset;
+		out.DataBytes = (mgint)bytes;
+		return true;
+	}
+};
+
+
+static const mguint DDS_MAGIC = 0x20534444;
+static const mguint DDS_HEADER_SIZE = 124;
+static const mguint DDS_DX10_HEADER_SIZE = 20;
+
+static const mguint DDSD_DEPTH = 0x800000;
+static const mguint DDSD_MIPMAPCOUNT = 0x20000;
+static const mguint DDPF_ALPHAPIXELS = 0x1;
+static const mguint DDPF_ALPHA = 0x2;
+static const mguint DDPF_FOURCC = 0x4;
+static const mguint DDPF_RGB = 0x40;
+static const mguint DDSCAPS2_CUBEMAP = 0x200;
+static const mguint DDSCAPS2_VOLUME = 0x200000;
+static const mguint DDS_RESOURCE_DIMENSION_TEXTURE3D = 4;
+static const mguint DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+static constexpr mguint MGI_FourCC(char a, char b, char c, char d)
+{
+	return (mguint)a | ((mguint)b << 8) | ((mguint)c << 16) | ((mguint)d << 24);
+}
+
+static MGSurfaceFormat MGI_DDS_FromDXGI(mguint format, bool& supported)
+{
+	supported = true;
+
+	switch (format)
+	{
+	case 2: return MGSurfaceFormat::Vector4;		// R32G32B32A32_FLOAT
+	case 10: return MGSurfaceFormat::HalfVector4;	// R16G16B16A16_FLOAT
+	case 11: return MGSurfaceFormat::Rgba64;		// R16G16B16A16_UNORM
+	case 16: return MGSurfaceFormat::Vector2;		// R32G32_FLOAT
+	case 24: return MGSurfaceFormat::Rgba1010102;	// R10G10B10A2_UNORM
+	case 28: return MGSurfaceFormat::Color;			// R8G8B8A8_UNORM
+	case 29: return MGSurfaceFormat::ColorSRgb;		// R8G8B8A8_UNORM_SRGB
+	case 34: return MGSurfaceFormat::HalfVector2;	// R16G16_FLOAT
+	case 35: return MGSurfaceFormat::Rg32;			// R16G16_UNORM
+	case 41: return MGSurfaceFormat::Single;		// R32_FLOAT
+	case 65: return MGSurfaceFormat::Alpha8;		// A8_UNORM
+	case 71: return MGSurfaceFormat::Dxt1;			// BC1_UNORM
+	case 72: return MGSurfaceFormat::Dxt1SRgb;		// BC1_UNORM_SRGB
+	case 74: return MGSurfaceFormat::Dxt3;			// BC2_UNORM
+	case 75: return MGSurfaceFormat::Dxt3SRgb;		// BC2_UNORM_SRGB
+	case 77: return MGSurfaceFormat::Dxt5;			// BC3_UNORM
+	case 78: return MGSurfaceFormat::Dxt5SRgb;		// BC3_UNORM_SRGB
+	case 85: return MGSurfaceFormat::Bgr565;		// B5G6R5_UNORM
+	case 86: return MGSurfaceFormat::Bgra5551;		// B5G5R5A1_UNORM
+	case 87: return MGSurfaceFormat::Bgra32;		// B8G8R8A8_UNORM
+	case 88: return MGSurfaceFormat::Bgr32;			// B8G8R8X8_UNORM
+	case 91: return MGSurfaceFormat::Bgra32SRgb;	// B8G8R8A8_UNORM_SRGB
+	case 93: return MGSurfaceFormat::Bgr32SRgb;		// B8G8R8X8_UNORM_SRGB
+	case 115: return MGSurfaceFormat::Bgra4444;		// B4G4R4A4_UNORM
+	}
+
+	supported = false;
+	return MGSurfaceFormat::Color;
+}
+
+static MGSurfaceFormat MGI_DDS_FromPixelFormat(const mgbyte* pf, bool& supported)
+{
+	auto flags = MGI_Read32(pf + 4);
+	auto fourCC = MGI_Read32(pf + 8);
+	auto bits = MGI_Read32(pf + 12);
+	auto r = MGI_Read32(pf + 16);
+	auto g = MGI_Read32(pf + 20);
+	auto b = MGI_Read32(pf + 24);
+	auto a = MGI_Read32(pf + 28);
+
+	supported = true;
+
+	if (flags & DDPF_FOURCC)
+	{
+		switch (fourCC)
+		{
+		case MGI_FourCC('D', 'X', 'T', '1'): return MGSurfaceFormat::Dxt1;
+		case MGI_FourCC('D', 'X', 'T', '3'): return MGSurfaceFormat::Dxt3;
+		case MGI_FourCC('D', 'X', 'T', '5'): return MGSurfaceFormat::Dxt5;
+
+		// Legacy D3DFORMAT values stored as the FourCC.
+		case 36: return MGSurfaceFormat::Rgba64;
+		case 112: return MGSurfaceFormat::HalfVector2;
+		case 113: return MGSurfaceFormat::HalfVector4;
+		case 114: return MGSurfaceFormat::Single;
+		case 115: return MGSurfaceFormat::Vector2;
+		case 116: return MGSurfaceFormat::Vector4;
+		}
+	}
+	else if (flags & DDPF_RGB)
+	{
+		if (bits == 32 && r == 0x000000FF && g == 0x0000FF00 && b == 0x00FF0000 && a == 0xFF000000)
+			return MGSurfaceFormat::Color;
+		if (bits == 32 && r == 0x00FF0000 && g == 0x0000FF00 && b == 0x000000FF)
+			return (flags & DDPF_ALPHAPIXELS) && a == 0xFF000000 ? MGSurfaceFormat::Bgra32 : MGSurfaceFormat::Bgr32;
+		if (bits == 16 && r == 0xF800 && g == 0x07E0 && b == 0x001F)
+			return MGSurfaceFormat::Bgr565;
+		if (bits == 16 && r == 0x7C00 && g == 0x03E0 && b == 0x001F && a == 0x8000)
+			return MGSurfaceFormat::Bgra5551;
+		if (bits == 16 && r == 0x0F00 && g == 0x00F0 && b == 0x000F && a == 0xF000)
+			return MGSurfaceFormat::Bgra4444;
+	}
+	else if ((flags & DDPF_ALPHA) && bits == 8 && a == 0xFF)
+		return MGSurfaceFormat::Alpha8;
+
+	supported = false;
+	return MGSurfaceFormat::Color;
+}
+
+static bool MGI_ReadDDS(mgbyte* data, mgint dataBytes, MGI_ContainerInfo& info, MGI_ContainerLevel* levels, mgint levelCount)
+{
+	if (dataBytes < (mgint)(4 + DDS_HEADER_SIZE) || MGI_Read32(data) != DDS_MAGIC)
+		return false;
+
+	auto header = data + 4;
+	if (MGI_Read32(header) != DDS_HEADER_SIZE)
+		return false;
+
+	auto flags = MGI_Read32(header + 4);
+	auto caps2 = MGI_Read32(header + 108);
+	auto pf = header + 72;
+
+	info.Type = MGTextureType::_2D;
+	info.Height = MGI_Read32(header + 8);
+	info.Width = MGI_Read32(header + 12);
+	info.Depth = (flags & DDSD_DEPTH) ? std::max<mgint>(1, MGI_Read32(header + 20)) : 1;
+	info.Mipmaps = (flags & DDSD_MIPMAPCOUNT) ? std::max<mgint>(1, MGI_Read32(header + 24)) : 1;
+	info.Slices = 1;
+
+	mgulong offset = 4 + DDS_HEADER_SIZE;
+	bool supported;
+
+	if ((MGI_Read32(pf + 4) & DDPF_FOURCC) && MGI_Read32(pf + 8) == MGI_FourCC('D', 'X', '1', '0'))
+	{
+		if (dataBytes < (mgint)(4 + DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE))
+			return false;
+
+		auto dx10 = header + DDS_HEADER_SIZE;
+		info.Format = MGI_DDS_FromDXGI(MGI_Read32(dx10), supported);
+
+		auto dimension = MGI_Read32(dx10 + 4);
+		auto miscFlag = MGI_Read32(dx10 + 8);
+		auto arraySize = std::max<mgint>(1, MGI_Read32(dx10 + 12));
+
+		if (dimension == DDS_RESOURCE_DIMENSION_TEXTURE3D)
+			info.Type = MGTextureType::_3D;
+		else
+			info.Depth = 1;
+
+		if (miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE)
+		{
+			info.Type = MGTextureType::Cube;
+			info.Slices = arraySize * 6;
+		}
+		else
+			info.Slices = arraySize;
+
+		offset += DDS_DX10_HEADER_SIZE;
+	}
+	else
+	{
+		info.Format = MGI_DDS_FromPixelFormat(pf, supported);
+
+		if (caps2 & DDSCAPS2_VOLUME)
+			info.Type = MGTextureType::_3D;
+		else
+			info.Depth = 1;
+
+		// We only support complete cube maps.
+		if (caps2 & DDSCAPS2_CUBEMAP)
+		{
+			if ((caps2 & 0xFC00) != 0xFC00)
+				return false;
+			info.Type = MGTextureType::Cube;
+			info.Slices = 6;
+		}
+	}
+
+	if (!supported || !MGI_IsValidInfo(info))
+		return false;
+
+	MGI_ContainerLayout layout = { data, (mgulong)dataBytes, info, levels, levelCount };
+
+	// Each slice is stored with its complete mip chain.
+	for (mgint slice = 0; slice < info.Slices; slice++)
+	{
+		for (mgint level = 0; level < info.Mipmaps; level++)
+		{
+			if (!layout.Add(level, slice, offset))
+				return false;
+
+			auto width = std::max(1, info.Width >> level);
+			auto height = std::max(1, info.Height >> level);
+			auto depth = std::max(1, info.Depth >> level);
+			offset += MGI_GetImageBytes(info.Format, width, height, depth);
+		}
+	}
+
+	return true;
+}
+
+
+static const mgbyte KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+static const mguint KTX2_HEADER_SIZE = 80;
+static const mguint KTX2_LEVEL_SIZE = 24;
+
+static MGSurfaceFormat MGI_KTX2_FromVkFormat(mguint format, bool& supported)
+{
+	supported = true;
+
+	// Vulkan names packed formats from the high bit down while
+	// our packed formats follow DXGI with blue in the low bits.
+	// R8 has no match as Alpha8 keeps its value in alpha.
+	switch (format)
+	{
+	case 4: return MGSurfaceFormat::Bgr565;			// R5G6B5_UNORM_PACK16
+	case 8: return MGSurfaceFormat::Bgra5551;		// A1R5G5B5_UNORM_PACK16
+	case 37: return MGSurfaceFormat::Color;			// R8G8B8A8_UNORM
+	case 43: return MGSurfaceFormat::ColorSRgb;		// R8G8B8A8_SRGB
+	case 44: return MGSurfaceFormat::Bgra32;		// B8G8R8A8_UNORM
+	case 50: return MGSurfaceFormat::Bgra32SRgb;	// B8G8R8A8_SRGB
+	case 64: return MGSurfaceFormat::Rgba1010102;	// A2B10G10R10_UNORM_PACK32
+	case 77: return MGSurfaceFormat::Rg32;			// R16G16_UNORM
+	case 83: return MGSurfaceFormat::HalfVector2;	// R16G16_SFLOAT
+	case 91: return MGSurfaceFormat::Rgba64;		// R16G16B16A16_UNORM
+	case 97: return MGSurfaceFormat::HalfVector4;	// R16G16B16A16_SFLOAT
+	case 100: return MGSurfaceFormat::Single;		// R32_SFLOAT
+	case 103: return MGSurfaceFormat::Vector2;		// R32G32_SFLOAT
+	case 109: return MGSurfaceFormat::Vector4;		// R32G32B32A32_SFLOAT
+	case 131: return MGSurfaceFormat::Dxt1;			// BC1_RGB_UNORM_BLOCK
+	case 132: return MGSurfaceFormat::Dxt1SRgb;		// BC1_RGB_SRGB_BLOCK
+	case 133: return MGSurfaceFormat::Dxt1a;		// BC1_RGBA_UNORM_BLOCK
+	case 135: return MGSurfaceFormat::Dxt3;			// BC2_UNORM_BLOCK
+	case 136: return MGSurfaceFormat::Dxt3SRgb;		// BC2_SRGB_BLOCK
+	case 137: return MGSurfaceFormat::Dxt5;			// BC3_UNORM_BLOCK
+	case 138: return MGSurfaceFormat::Dxt5SRgb;		// BC3_SRGB_BLOCK
+	case 147: return MGSurfaceFormat::Rgb8Etc2;		// ETC2_R8G8B8_UNORM_BLOCK
+	case 148: return MGSurfaceFormat::Srgb8Etc2;	// ETC2_R8G8B8_SRGB_BLOCK
+	case 149: return MGSurfaceFormat::Rgb8A1Etc2;	// ETC2_R8G8B8A1_UNORM_BLOCK
+	case 150: return MGSurfaceFormat::Srgb8A1Etc2;	// ETC2_R8G8B8A1_SRGB_BLOCK
+	case 151: return MGSurfaceFormat::Rgba8Etc2;	// ETC2_R8G8B8A8_UNORM_BLOCK
+	case 152: return MGSurfaceFormat::SRgb8A8Etc2;	// ETC2_R8G8B8A8_SRGB_BLOCK
+	case 157: return MGSurfaceFormat::Astc4X4Rgba;	// ASTC_4x4_UNORM_BLOCK
+	case 1000340000: return MGSurfaceFormat::Bgra4444;	// A4R4G4B4_UNORM_PACK16
+	}
+
+	supported = false;
+	return MGSurfaceFormat::Color;
+}
+
+static bool MGI_ReadKTX2(mgbyte* data, mgint dataBytes, MGI_ContainerInfo& info, MGI_ContainerLevel* levels, mgint levelCount)
+{
+	if (dataBytes < (mgint)KTX2_HEADER_SIZE || memcmp(data, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+		return false;
+
+	bool supported;
+	info.Format = MGI_KTX2_FromVkFormat(MGI_Read32(data + 12), supported);
+	info.Width = MGI_Read32(data + 20);
+	info.Height = std::max<mgint>(1, MGI_Read32(data + 24));
+	info.Depth = std::max<mgint>(1, MGI_Read32(data + 28));
+
+	auto layers = std::max<mgint>(1, std::min<mguint>(MGI_Read32(data + 32), 2048));
+	auto faces = MGI_Read32(data + 36);
+	auto levelsInFile = MGI_Read32(data + 40);
+	auto supercompression = MGI_Read32(data + 44);
+
+	// Supercompressed data like Basis needs transcoding first.
+	if (!supported || supercompression != 0)
+		return false;
+	if (faces != 1 && faces != 6)
+		return false;
+
+	info.Mipmaps = std::max<mgint>(1, levelsInFile);
+	info.Slices = layers * faces;
+	info.Type = faces == 6 ? MGTextureType::Cube : (info.Depth > 1 ? MGTextureType::_3D : MGTextureType::_2D);
+
+	if (!MGI_IsValidInfo(info))
+		return false;
+
+	if (dataBytes < (mgint)(KTX2_HEADER_SIZE + info.Mipmaps * KTX2_LEVEL_SIZE))
+		return false;
+
+	MGI_ContainerLayout layout = { data, (mgulong)dataBytes, info, levels, levelCount };
+
+	// Each level stores every layer and face together.
+	for (mgint level = 0; level < info.Mipmaps; level++)
+	{
+		auto entry = data + KTX2_HEADER_SIZE + level * KTX2_LEVEL_SIZE;
+		auto offset = MGI_Read64(entry);
+
+		auto width = std::max(1, info.Width >> level);
+		auto height = std::max(1, info.Height >> level);
+		auto depth = std::max(1, info.Depth >> level);
+		auto imageBytes = MGI_GetImageBytes(info.Format, width, height, depth);
+
+		for (mgint slice = 0; slice < info.Slices; slice++)
+		{
+			if (!layout.Add(level, slice, offset + slice * imageBytes))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+mgbyte MGI_ReadContainer(mgbyte* data, mgint dataBytes, MGI_ContainerInfo& info, MGI_ContainerLevel* levels, mgint levelCount)
+{
+	assert(data != nullptr);
+
+	memset(&info, 0, sizeof(info));
+
+	if (MGI_ReadDDS(data, dataBytes, info, levels, levelCount))
+		return true;
+
+	memset(&info, 0, sizeof(info));
+
+	if (MGI_ReadKTX2(data, dataBytes, info, levels, levelCount))
+		return true;
+
+	memset(&info, 0, sizeof(info));
+	return false;
+}
@@ -9,45 +9,26 @@ struct MGG_Texture;
 #include "MGM_common.h"
 #include "api_MGA.h"
 #include "api_MGG.h"
+#include "api_MG_Asset.h"
 
 #include <stdio.h>
+#include <string.h>
 
 
 void MGM_ReadSignature(mgbyte* filepath, MGM_SIGNATURE)
 {
 	memset(signature, 0, 16);
 
-	FILE* handle = fopen((const char*)filepath, "rb");
-	if (handle == nullptr)
+	// Go thru the asset API so media in packs works.
+	MG_Asset* handle;
+	mglong length;
+	if (!MG_Asset_Open((const char*)filepath, handle, length))
 		return;
 
-	fread(signature, 1, 16, handle);
-	fclose(handle);
+	MG_Asset_Read(handle, (mgbyte*)signature, 16);
+	MG_Asset_Close(handle);
 }
 
-MGM_AudioDecoder* MGM_AudioDecoder_TryCreate_Ogg(MGM_SIGNATURE)
-{
-	// TODO: Implement me!
-	//
-	// - This should be moved into its own CPP.
-	// - We need to add Ogg support to native build.
-	// - How do we compile Ogg for consoles?
-	// 
-	return nullptr;
-}
-
-MGM_AudioDecoder* MGM_AudioDecoder_TryCreate_Mp3(MGM_SIGNATURE)
-{
-	// TODO: Implement me!
-	//
-	// - This should be moved into its own CPP.
-	// - Should we use a single header mp3 decoder?
-	//
-	return nullptr;
-}
-
-#if defined(_WIN32)
-
 MGM_AudioDecoder* MGM_AudioDecoder_Create(mgbyte* filepath, MGM_AudioDecoderInfo& info)
 {
 	assert(filepath != nullptr);
@@ -69,11 +50,21 @@ MGM_AudioDecoder* MGM_AudioDecoder_Create(mgbyte* filepath, MGM_AudioDecoderInfo
 	}
 
 	decoder->Initialize(filepath, info);
+
+	// The signature matched, but the file
+	// itself is corrupt or unsupported.
+	if (info.samplerate <= 0 || info.channels <= 0)
+	{
+		delete decoder;
+		info.samplerate = 0;
+		info.channels = 0;
+		info.duration = 0;
+		return nullptr;
+	}
+
 	return decoder;
 }
 
-#endif
-
 void MGM_AudioDecoder_Destroy(MGM_AudioDecoder* decoder)
 {
 	assert(decoder != nullptr);
@@ -93,33 +84,6 @@ mgbyte MGM_AudioDecoder_Decode(MGM_AudioDecoder* decoder, mgbyte*& buffer, mguin
 }
 
 
-
-MGM_VideoDecoder* MGM_VideoDecoder_TryCreate_Theora(MGM_SIGNATURE)
-{
-	// TODO: Implement me!
-	//
-	// - This should be moved into its own CPP.
-	// - We need to add Theora support to native build.
-	// - How do we compile Theora for consoles?
-	// 
-	return nullptr;
-}
-
-MGM_VideoDecoder* MGM_VideoDecoder_TryCreate_OpenH264(MGM_SIGNATURE)
-{
-	// TODO: Implement me!
-	//
-	// See https://github.com/cisco/openh264
-	// 
-	// - This should be moved into its own CPP.
-	// - We need to add lib to native build.
-	// - How do we compile lib for consoles?
-	//
-	return nullptr;
-}
-
-#if defined(_WIN32)
-
 MGM_VideoDecoder* MGM_VideoDecoder_Create(MGG_GraphicsDevice* device, mgbyte* filepath, MGM_VideoDecoderInfo& info)
 {
 	assert(filepath != nullptr);
@@ -141,12 +105,24 @@ MGM_VideoDecoder* MGM_VideoDecoder_Create(MGG_GraphicsDevice* device, mgbyte* fi
 		return nullptr;
 	}
 
+	decoder->device = device;
 	decoder->Initialize(filepath, info);
+
+	// The signature matched, but the file
+	// itself is corrupt or unsupported.
+	if (info.width <= 0 || info.height <= 0)
+	{
+		delete decoder;
+		info.width = 0;
+		info.height = 0;
+		info.fps = 0;
+		info.duration = 0;
+		return nullptr;
+	}
+
 	return decoder;
 }
 
-#endif
-
 void MGM_VideoDecoder_Destroy(MGM_VideoDecoder* decoder)
 {
 	assert(decoder != nullptr);
@@ -171,6 +147,18 @@ void MGM_VideoDecoder_SetLooped(MGM_VideoDecoder* decoder, mgbyte looped)
 	decoder->SetLooped(looped);
 }
 
+void MGM_VideoDecoder_SetPlanar(MGM_VideoDecoder* decoder, mgbyte planar)
+{
+	assert(decoder != nullptr);
+	decoder->SetPlanar(planar);
+}
+
+void MGM_VideoDecoder_GetPlanes(MGM_VideoDecoder* decoder, MGG_Texture*& y, MGG_Texture*& u, MGG_Texture*& v)
+{
+	assert(decoder != nullptr);
+	decoder->GetPlanes(y, u, v);
+}
+
 MGG_Texture* MGM_VideoDecoder_Decode(MGM_VideoDecoder* decoder)
 {
 	assert(decoder != nullptr);
@@ -0,0 +1,285 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "api_MGM.h"
+
+#include "MGM_common.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <string.h>
+
+
+// A decode thread keeps a single producer, single consumer
+// ring of PCM filled ahead of playback.  The consumer side
+// never locks or allocates, so it is safe to drive from an
+// audio or game thread.
+struct MGM_AudioStream
+{
+	MGM_AudioDecoder* decoder;
+	mguint frameBytes;
+
+	std::vector<mgbyte> ring;
+	mgulong capacity;
+
+	// These only ever increase and each is
+	// only written by one side of the ring.
+	std::atomic<mgulong> writePos;
+	std::atomic<mgulong> readPos;
+
+	// The consumer asks for a seek and the producer answers
+	// with where the data for the new position starts.
+	std::atomic<mgulong> seekRequested;
+	std::atomic<mgulong> seekTimeMS;
+	std::atomic<mgulong> seekDone;
+	std::atomic<mgulong> seekPos;
+	mgulong seekSeen;
+
+	// The decoder has nothing more, but the last of
+	// its data may still be on the way to the ring.
+	std::atomic<bool> ended;
+	std::atomic<bool> finished;
+
+	// Only the consumer touches starved, so each time
+	// playback runs dry is counted once.
+	std::atomic<mgint> underruns;
+	bool starved;
+	std::atomic<bool> quit;
+
+	// Only the producer waits on this.
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::chrono::milliseconds idle;
+
+	std::thread thread;
+};
+
+
+static void MGM_AudioStream_Write(MGM_AudioStream* stream, mgulong position, const mgbyte* data, mgulong bytes)
+{
+	auto start = position % stream->capacity;
+	auto first = std::min(bytes, stream->capacity - start);
+
+	memcpy(stream->ring.data() + start, data, (size_t)first);
+	memcpy(stream->ring.data(), data + first, (size_t)(bytes - first));
+}
+
+static void MGM_AudioStream_Producer(MGM_AudioStream* stream)
+{
+	mgbyte* pending = nullptr;
+	mguint pendingBytes = 0;
+	bool ended = false;
+	mgulong seekHandled = 0;
+
+	while (!stream->quit)
+	{
+		auto seek = stream->seekRequested.load(std::memory_order_acquire);
+		if (seek != seekHandled)
+		{
+			stream->decoder->SetPosition(stream->seekTimeMS.load(std::memory_order_relaxed));
+			pendingBytes = 0;
+			ended = false;
+			stream->ended.store(false, std::memory_order_relaxed);
+			stream->finished.store(false, std::memory_order_relaxed);
+
+			// Everything written before this point is stale.
+			stream->seekPos.store(stream->writePos.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			stream->seekDone.store(seek, std::memory_order_release);
+			seekHandled = seek;
+		}
+
+		if (pendingBytes == 0 && !ended)
+		{
+			ended = stream->decoder->Decode(pending, pendingBytes);
+			pendingBytes -= pendingBytes % stream->frameBytes;
+			stream->ended.store(ended, std::memory_order_release);
+		}
+
+		if (pendingBytes > 0)
+		{
+			auto write = stream->writePos.load(std::memory_order_relaxed);
+			auto read = stream->readPos.load(std::memory_order_acquire);
+
+			auto space = stream->capacity - (write - read);
+			auto bytes = std::min<mgulong>(space, pendingBytes);
+			bytes -= bytes % stream->frameBytes;
+
+			if (bytes > 0)
+			{
+				MGM_AudioStream_Write(stream, write, pending, bytes);
+				stream->writePos.store(write + bytes, std::memory_order_release);
+
+				pending += bytes;
+				pendingBytes -= (mguint)bytes;
+				continue;
+			}
+		}
+		else if (ended)
+			stream->finished.store(true, std::memory_order_release);
+
+		// The ring is full or the decoder is done, so sleep until
+		// the consumer frees some space or asks for a seek.  The
+		// consumer doesn't lock to wake us, so we wake up on our
+		// own now and then in case we missed it.
+		std::unique_lock<std::mutex> lock(stream->mutex);
+		stream->wake.wait_for(lock, stream->idle, [stream, seekHandled, pendingBytes]
+		{
+			if (stream->quit || stream->seekRequested.load(std::memory_order_relaxed) != seekHandled)
+				return true;
+
+			auto used = stream->writePos.load(std::memory_order_relaxed) - stream->readPos.load(std::memory_order_relaxed);
+			return pendingBytes > 0 && stream->capacity - used >= stream->frameBytes;
+		});
+	}
+}
+
+MGM_AudioStream* MGM_AudioStream_Create(MGM_AudioDecoder* decoder, mgint samplerate, mgint channels, mgint latencyMS)
+{
+	assert(decoder != nullptr);
+	assert(samplerate > 0);
+	assert(channels > 0);
+	assert(latencyMS > 0);
+
+	auto stream = new MGM_AudioStream();
+	stream->decoder = decoder;
+	stream->frameBytes = channels * sizeof(mgshort);
+
+	// Keep the ring a whole number of frames so
+	// the consumer never gets a partial one.
+	auto frames = std::max<mgulong>(1, ((mgulong)samplerate * latencyMS) / 1000);
+	stream->capacity = frames * stream->frameBytes;
+	stream->ring.resize((size_t)stream->capacity);
+
+	stream->writePos = 0;
+	stream->readPos = 0;
+	stream->seekRequested = 0;
+	stream->seekTimeMS = 0;
+	stream->seekDone = 0;
+	stream->seekPos = 0;
+	stream->seekSeen = 0;
+	stream->ended = false;
+	stream->finished = false;
+	stream->underruns = 0;
+	stream->starved = false;
+	stream->quit = false;
+	stream->idle = std::chrono::milliseconds(std::max(2, std::min(50, latencyMS / 4)));
+
+	stream->thread = std::thread(MGM_AudioStream_Producer, stream);
+
+	return stream;
+}
+
+void MGM_AudioStream_Destroy(MGM_AudioStream* stream)
+{
+	assert(stream != nullptr);
+
+	{
+		std::lock_guard<std::mutex> lock(stream->mutex);
+		stream->quit = true;
+	}
+	stream->wake.notify_one();
+	stream->thread.join();
+
+	delete stream;
+}
+
+void MGM_AudioStream_Seek(MGM_AudioStream* stream, mgulong timeMS)
+{
+	assert(stream != nullptr);
+
+	stream->seekTimeMS.store(timeMS, std::memory_order_relaxed);
+	stream->seekRequested.fetch_add(1, std::memory_order_release);
+	stream->wake.notify_one();
+}
+
+mgbyte MGM_AudioStream_Acquire(MGM_AudioStream* stream, mgbyte*& buffer, mguint& size)
+{
+	assert(stream != nullptr);
+
+	buffer = nullptr;
+	size = 0;
+
+	// Nothing is returned until the decoder has
+	// moved, then we skip past the stale data.
+	auto seek = stream->seekRequested.load(std::memory_order_relaxed);
+	if (stream->seekDone.load(std::memory_order_acquire) != seek)
+		return false;
+
+	if (stream->seekSeen != seek)
+	{
+		stream->readPos.store(stream->seekPos.load(std::memory_order_relaxed), std::memory_order_release);
+		stream->seekSeen = seek;
+	}
+
+	auto write = stream->writePos.load(std::memory_order_acquire);
+	auto read = stream->readPos.load(std::memory_order_relaxed);
+
+	if (write == read)
+		return false;
+
+	stream->starved = false;
+
+	// Only up to the end of the ring, the rest comes next time.
+	auto start = read % stream->capacity;
+	buffer = stream->ring.data() + start;
+	size = (mguint)std::min(write - read, stream->capacity - start);
+	return true;
+}
+
+void MGM_AudioStream_Release(MGM_AudioStream* stream, mguint size)
+{
+	assert(stream != nullptr);
+	assert(size % stream->frameBytes == 0);
+
+	auto read = stream->readPos.load(std::memory_order_relaxed);
+	assert(read + size <= stream->writePos.load(std::memory_order_relaxed));
+
+	stream->readPos.store(read + size, std::memory_order_release);
+	stream->wake.notify_one();
+}
+
+mgbyte MGM_AudioStream_IsFinished(MGM_AudioStream* stream)
+{
+	assert(stream != nullptr);
+
+	auto seek = stream->seekRequested.load(std::memory_order_relaxed);
+	if (stream->seekDone.load(std::memory_order_acquire) != seek)
+		return false;
+
+	// A seek the consumer hasn't caught up with yet moves the read position.
+	auto read = stream->seekSeen != seek ? stream->seekPos.load(std::memory_order_relaxed) : stream->readPos.load(std::memory_order_relaxed);
+
+	return	stream->finished.load(std::memory_order_acquire) &&
+			read == stream->writePos.load(std::memory_order_acquire);
+}
+
+void MGM_AudioStream_Starved(MGM_AudioStream* stream)
+{
+	assert(stream != nullptr);
+
+	// Waiting on a seek or the end of the stream isn't an underrun.
+	auto seek = stream->seekRequested.load(std::memory_order_relaxed);
+	if (stream->seekDone.load(std::memory_order_acquire) != seek || stream->seekSeen != seek)
+		return;
+	if (stream->ended.load(std::memory_order_acquire))
+		return;
+
+	auto read = stream->readPos.load(std::memory_order_relaxed);
+	if (read == stream->seekPos.load(std::memory_order_relaxed) || read != stream->writePos.load(std::memory_order_acquire))
+		return;
+
+	if (!stream->starved)
+		stream->underruns.fetch_add(1, std::memory_order_relaxed);
+	stream->starved = true;
+}
+
+mgint MGM_AudioStream_GetUnderruns(MGM_AudioStream* stream)
+{
+	assert(stream != nullptr);
+	return stream->underruns.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,278 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "api_MGM.h"
+
+#include "MGM_common.h"
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+
+// Enough for a few hundred short 44.1kHz stereo clips.
+static const mgulong MGM_PCMCache_DefaultBudget = 16 * 1024 * 1024;
+
+// The decoded audio for one file.  Once ready the
+// PCM never changes so it is read without locking.
+struct MGM_PCMBlock
+{
+	std::string path;
+	std::vector<mgbyte> pcm;
+	MGM_AudioDecoderInfo info;
+
+	// These are all guarded by the cache mutex.
+	mgint refs = 0;
+	bool pinned = false;
+	bool ready = false;
+	bool failed = false;
+	bool cached = false;
+	std::list<MGM_PCMBlock*>::iterator lru;
+};
+
+struct MGM_PCMCache
+{
+	std::mutex mutex;
+	std::condition_variable decoded;
+
+	std::unordered_map<std::string, MGM_PCMBlock*> blocks;
+
+	// Blocks nothing is using, most recently used first.
+	std::list<MGM_PCMBlock*> unused;
+
+	mgulong budget = MGM_PCMCache_DefaultBudget;
+	mgulong bytes = 0;
+	mgulong hits = 0;
+	mgulong misses = 0;
+};
+
+static MGM_PCMCache s_PCMCache;
+
+
+static bool MGM_PCMCache_Decode(MGM_PCMBlock* block)
+{
+	auto decoder = MGM_AudioDecoder_Create((mgbyte*)block->path.c_str(), block->info);
+	if (decoder == nullptr)
+		return false;
+
+	// Reserve using the estimated duration so most
+	// clips decode without growing the block.
+	auto frameBytes = (mgulong)block->info.channels * sizeof(mgshort);
+	block->pcm.reserve((size_t)((block->info.duration * block->info.samplerate / 1000) * frameBytes));
+
+	while (true)
+	{
+		mgbyte* buffer;
+		mguint size;
+		auto ended = decoder->Decode(buffer, size);
+		block->pcm.insert(block->pcm.end(), buffer, buffer + size);
+		if (ended)
+			break;
+	}
+
+	MGM_AudioDecoder_Destroy(decoder);
+
+	block->pcm.shrink_to_fit();
+	return !block->pcm.empty();
+}
+
+static void MGM_PCMCache_Trim(MGM_PCMCache& cache)
+{
+	// Blocks in use can't be freed, so we can
+	// end up over budget until they're released.
+	while (cache.bytes > cache.budget && !cache.unused.empty())
+	{
+		auto block = cache.unused.back();
+		cache.unused.pop_back();
+
+		cache.bytes -= block->pcm.size();
+		cache.blocks.erase(block->path);
+		delete block;
+	}
+}
+
+static void MGM_PCMCache_AddRef(MGM_PCMCache& cache, MGM_PCMBlock* block)
+{
+	if (block->refs++ == 0 && block->cached)
+	{
+		cache.unused.erase(block->lru);
+		block->cached = false;
+	}
+}
+
+static void MGM_PCMCache_RemoveRef(MGM_PCMCache& cache, MGM_PCMBlock* block)
+{
+	assert(block->refs > 0);
+
+	if (--block->refs > 0 || block->pinned)
+		return;
+
+	cache.unused.push_front(block);
+	block->lru = cache.unused.begin();
+	block->cached = true;
+
+	MGM_PCMCache_Trim(cache);
+}
+
+// Returns the block with a reference added, decoding it
+// if needed.  Another thread asking for the same file at
+// the same time waits for the first decode to finish.
+static MGM_PCMBlock* MGM_PCMCache_Get(mgbyte* filepath)
+{
+	auto& cache = s_PCMCache;
+	std::unique_lock<std::mutex> lock(cache.mutex);
+
+	std::string path((const char*)filepath);
+	auto found = cache.blocks.find(path);
+	if (found != cache.blocks.end())
+	{
+		auto block = found->second;
+		MGM_PCMCache_AddRef(cache, block);
+
+		cache.decoded.wait(lock, [block] { return block->ready || block->failed; });
+		if (block->ready)
+		{
+			cache.hits++;
+			return block;
+		}
+
+		// The decoding thread removes it from the cache.
+		if (--block->refs == 0)
+			delete block;
+		return nullptr;
+	}
+
+	auto block = new MGM_PCMBlock();
+	block->path = path;
+	block->refs = 1;
+	cache.blocks[path] = block;
+	cache.misses++;
+
+	lock.unlock();
+	auto decoded = MGM_PCMCache_Decode(block);
+	lock.lock();
+
+	if (!decoded)
+	{
+		block->failed = true;
+		cache.blocks.erase(path);
+		cache.decoded.notify_all();
+
+		if (--block->refs == 0)
+			delete block;
+		return nullptr;
+	}
+
+	block->ready = true;
+	cache.bytes += block->pcm.size();
+	cache.decoded.notify_all();
+
+	MGM_PCMCache_Trim(cache);
+	return block;
+}
+
+
+MGM_PCMBlock* MGM_PCMCache_Acquire(mgbyte* filepath, MGM_AudioDecoderInfo& info)
+{
+	assert(filepath != nullptr);
+
+	auto block = MGM_PCMCache_Get(filepath);
+	if (block == nullptr)
+	{
+		info.samplerate = 0;
+		info.channels = 0;
+		info.duration = 0;
+		return nullptr;
+	}
+
+	info = block->info;
+	return block;
+}
+
+void MGM_PCMCache_Release(MGM_PCMBlock* block)
+{
+	assert(block != nullptr);
+
+	std::lock_guard<std::mutex> lock(s_PCMCache.mutex);
+	MGM_PCMCache_RemoveRef(s_PCMCache, block);
+}
+
+void MGM_PCMBlock_AddRef(MGM_PCMBlock* block, MGM_AudioDecoderInfo& info)
+{
+	assert(block != nullptr);
+
+	std::lock_guard<std::mutex> lock(s_PCMCache.mutex);
+	MGM_PCMCache_AddRef(s_PCMCache, block);
+	info = block->info;
+}
+
+void MGM_PCMBlock_GetData(MGM_PCMBlock* block, mgbyte*& data, mguint& size)
+{
+	assert(block != nullptr);
+	assert(block->ready);
+
+	data = block->pcm.data();
+	size = (mguint)block->pcm.size();
+}
+
+mgbyte MGM_PCMCache_Prefetch(mgbyte* filepath)
+{
+	assert(filepath != nullptr);
+
+	// Decoding and releasing it leaves it at
+	// the front of the LRU ready for later.
+	auto block = MGM_PCMCache_Get(filepath);
+	if (block == nullptr)
+		return false;
+
+	MGM_PCMCache_Release(block);
+	return true;
+}
+
+mgbyte MGM_PCMCache_SetPinned(mgbyte* filepath, mgbyte pinned)
+{
+	assert(filepath != nullptr);
+
+	auto& cache = s_PCMCache;
+
+	if (!pinned)
+	{
+		std::lock_guard<std::mutex> lock(cache.mutex);
+
+		auto found = cache.blocks.find((const char*)filepath);
+		if (found == cache.blocks.end() || !found->second->pinned)
+			return false;
+
+		// Goes back to the LRU once nothing is using it.
+		auto block = found->second;
+		block->pinned = false;
+		block->refs++;
+		MGM_PCMCache_RemoveRef(cache, block);
+		return true;
+	}
+
+	auto block = MGM_PCMCache_Get(filepath);
+	if (block == nullptr)
+		return false;
+
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	block->pinned = true;
+	block->refs--;
+	return true;
+}
+
+void MGM_PCMCache_SetBudget(mgulong bytes)
+{
+	std::lock_guard<std::mutex> lock(s_PCMCache.mutex);
+	s_PCMCache.budget = bytes;
+	MGM_PCMCache_Trim(s_PCMCache);
+}
+
+void MGM_PCMCache_GetStats(mgulong& bytes, mgulong& hits, mgulong& misses)
+{
+	std::lock_guard<std::mutex> lock(s_PCMCache.mutex);
+	bytes = s_PCMCache.bytes;
+	hits = s_PCMCache.hits;
+	misses = s_PCMCache.misses;
+}
@@ -0,0 +1,183 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "api_MGM.h"
+#include "api_MG_Asset.h"
+
+#include "MGM_common.h"
+
+#include <algorithm>
+#include <string>
+#include <stdio.h>
+#include <string.h>
+
+
+static const char MGM_SeekIndex_Magic[4] = { 'M', 'G', 'S', 'I' };
+static const mguint MGM_SeekIndex_Version = 3;
+
+// How much of each end of the file is hashed to
+// tell if the sidecar is still for the same file.
+static const mglong MGM_SeekIndex_HashBytes = 4096;
+
+struct MGM_SeekIndexHeader
+{
+	char magic[4];
+	mguint version;
+	mglong length;
+	mguint hash;
+	mgint channels;
+	mgint samplerate;
+	mguint count;
+	mgulong samples;
+};
+
+static std::mutex s_SeekIndexMutex;
+static std::string s_SeekIndexDirectory;
+
+
+static mguint MGM_SeekIndex_Hash(const mgbyte* data, mglong length)
+{
+	auto bytes = (mgint)std::min(length, MGM_SeekIndex_HashBytes);
+	auto head = MG_ComputeHash(data, bytes);
+	auto tail = MG_ComputeHash(data + length - bytes, bytes);
+	return MG_ComputeHash(tail, head);
+}
+
+// Sidecars shipped with the content sit next to the file.
+static std::string MGM_SeekIndex_GetShippedPath(mgbyte* filepath)
+{
+	return std::string((const char*)filepath) + ".mgseek";
+}
+
+// Built sidecars are only saved to the cache directory,
+// so this is empty when one hasn't been set.
+static std::string MGM_SeekIndex_GetCachePath(mgbyte* filepath)
+{
+	std::lock_guard<std::mutex> lock(s_SeekIndexMutex);
+
+	if (s_SeekIndexDirectory.empty())
+		return std::string();
+
+	auto hash = MG_ComputeHash(filepath, (mgint)strlen((const char*)filepath));
+
+	char name[16];
+	snprintf(name, sizeof(name), "%08x", hash);
+	return s_SeekIndexDirectory + "/" + name + ".mgseek";
+}
+
+
+void MGM_SeekIndex::Add(mgulong sample, mglong offset)
+{
+	if (points.empty() || sample >= points.back().sample + spacing)
+		points.push_back({ sample, offset });
+}
+
+MGM_SeekPoint MGM_SeekIndex::Find(mgulong sample) const
+{
+	assert(!points.empty());
+
+	auto found = std::upper_bound(points.begin(), points.end(), sample, [](mgulong sample, const MGM_SeekPoint& point)
+	{
+		return sample < point.sample;
+	});
+
+	return found == points.begin() ? points.front() : *(found - 1);
+}
+
+bool MGM_SeekIndex::Load(mgbyte* filepath, const mgbyte* data, mglong length)
+{
+	auto cachePath = MGM_SeekIndex_GetCachePath(filepath);
+	if (!cachePath.empty() && LoadPath(cachePath.c_str(), data, length))
+		return true;
+
+	return LoadPath(MGM_SeekIndex_GetShippedPath(filepath).c_str(), data, length);
+}
+
+bool MGM_SeekIndex::LoadPath(const char* path, const mgbyte* data, mglong length)
+{
+	// Read thru the asset API so sidecars shipped in packs work.
+	MG_Asset* handle;
+	mglong fileLength;
+	if (!MG_Asset_Open(path, handle, fileLength))
+		return false;
+
+	MGM_SeekIndexHeader header;
+	auto valid =
+		fileLength >= (mglong)sizeof(header) &&
+		MG_Asset_Read(handle, (mgbyte*)&header, sizeof(header)) == (mgint)sizeof(header) &&
+		memcmp(header.magic, MGM_SeekIndex_Magic, 4) == 0 &&
+		header.version == MGM_SeekIndex_Version &&
+		header.length == length &&
+		header.count > 0 &&
+		header.channels > 0 &&
+		header.samplerate > 0 &&
+		fileLength == (mglong)(sizeof(header) + ((mglong)header.count * sizeof(MGM_SeekPoint))) &&
+		header.hash == MGM_SeekIndex_Hash(data, length);
+
+	if (valid)
+	{
+		points.resize(header.count);
+		auto bytes = (mglong)(header.count * sizeof(MGM_SeekPoint));
+		valid = MG_Asset_Read(handle, (mgbyte*)points.data(), bytes) == bytes;
+	}
+
+	MG_Asset_Close(handle);
+
+	if (!valid)
+	{
+		points.clear();
+		return false;
+	}
+
+	channels = header.channels;
+	samplerate = header.samplerate;
+	samples = header.samples;
+	return true;
+}
+
+void MGM_SeekIndex::Save(mgbyte* filepath, const mgbyte* data, mglong length) const
+{
+	// Never write next to the content, which may be read only
+	// or shipped, so without a cache directory we scan each time.
+	auto path = MGM_SeekIndex_GetCachePath(filepath);
+	if (path.empty() || points.empty())
+		return;
+
+	MGM_SeekIndexHeader header;
+	memcpy(header.magic, MGM_SeekIndex_Magic, 4);
+	header.version = MGM_SeekIndex_Version;
+	header.length = length;
+	header.hash = MGM_SeekIndex_Hash(data, length);
+	header.channels = channels;
+	header.samplerate = samplerate;
+	header.count = (mguint)points.size();
+	header.samples = samples;
+
+	// The sidecar is only a cache, so failing
+	// to write it just means we scan next time.
+	auto file = fopen(path.c_str(), "wb");
+	if (file == nullptr)
+		return;
+
+	auto written =
+		fwrite(&header, sizeof(header), 1, file) == 1 &&
+		fwrite(points.data(), sizeof(MGM_SeekPoint), points.size(), file) == points.size();
+
+	fclose(file);
+
+	// Don't leave a partial sidecar behind.
+	if (!written)
+		remove(path.c_str());
+}
+
+
+void MGM_SeekIndex_SetCacheDirectory(mgbyte* directory)
+{
+	std::lock_guard<std::mutex> lock(s_SeekIndexMutex);
+
+	if (directory == nullptr)
+		s_SeekIndexDirectory.clear();
+	else
+		s_SeekIndexDirectory = (const char*)directory;
+}
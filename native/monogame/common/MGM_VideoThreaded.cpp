@@ -0,0 +1,275 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "api_MGM.h"
+#include "api_MGG.h"
+
+#include "MGM_common.h"
+
+#include <algorithm>
+#include <string.h>
+
+
+// How many converted frames the worker keeps ready ahead
+// of playback and how many textures we cycle through so
+// the one being drawn is never the one being updated.
+static const int MGM_Video_FramesAhead = 4;
+static const int MGM_Video_Textures = 3;
+
+// Longer gaps between calls to Decode are from the video
+// being paused, so the clock only moves a little.
+static const mgulong MGM_Video_MaxStepMS = 100;
+
+
+static mgbyte* MGM_Video_CopyPlane(const mgbyte* src, mgint stride, mgint width, mgint height, mgbyte* dst)
+{
+	for (mgint row = 0; row < height; row++, src += stride, dst += width)
+		memcpy(dst, src, width);
+
+	return dst;
+}
+
+MGM_VideoDecoder_Threaded::~MGM_VideoDecoder_Threaded()
+{
+	// The decoder must have stopped the worker
+	// before it destroyed its own state.
+	assert(!thread.joinable());
+
+	for (auto texture : textures)
+		MGG_Texture_Destroy(device, texture);
+
+	for (auto texture : planes)
+	{
+		if (texture)
+			MGG_Texture_Destroy(device, texture);
+	}
+}
+
+void MGM_VideoDecoder_Threaded::StartWorker()
+{
+	assert(width > 0 && height > 0 && fps > 0);
+
+	chromaWidth = (width + shiftX) >> shiftX;
+	chromaHeight = (height + shiftY) >> shiftY;
+
+	// The planar textures are only created if they get used.
+	textures.resize(MGM_Video_Textures);
+	for (auto& texture : textures)
+		texture = MGG_Texture_Create(device, MGTextureType::_2D, MGSurfaceFormat::Color, width, height, 1, 1, 1);
+	planes.resize(MGM_Video_Textures * 3);
+
+	frames.resize(MGM_Video_FramesAhead);
+	for (auto& frame : frames)
+	{
+		frame.pixels.resize((size_t)width * height * 4);
+		free.push_back(&frame);
+	}
+
+	thread = std::thread(&MGM_VideoDecoder_Threaded::Worker, this);
+}
+
+void MGM_VideoDecoder_Threaded::StopWorker()
+{
+	if (!thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	thread.join();
+}
+
+void MGM_VideoDecoder_Threaded::WriteFrame(MGM_VideoFrame* frame, const mgbyte* y, mgint yStride, const mgbyte* u, mgint uStride, const mgbyte* v, mgint vStride)
+{
+	// The shader does the conversion, so the planes are only cropped.
+	frame->planar = planar;
+	if (frame->planar)
+	{
+		auto out = frame->pixels.data();
+		out = MGM_Video_CopyPlane(y, yStride, width, height, out);
+		out = MGM_Video_CopyPlane(u, uStride, chromaWidth, chromaHeight, out);
+		MGM_Video_CopyPlane(v, vStride, chromaWidth, chromaHeight, out);
+		return;
+	}
+
+	MGM_YUV_ToRGBA(
+		y, yStride,
+		u, uStride,
+		v, vStride,
+		shiftX, shiftY,
+		width, height,
+		frame->pixels.data());
+}
+
+void MGM_VideoDecoder_Threaded::Worker()
+{
+	while (true)
+	{
+		MGM_VideoFrame* frame;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this] { return quit || !free.empty(); });
+			if (quit)
+				return;
+
+			frame = free.back();
+			free.pop_back();
+		}
+
+		auto decoded = DecodeFrame(frame);
+
+		// Start over and keep the clock going
+		// from where the last frame was.
+		if (!decoded && looped && Rewind())
+		{
+			loopMS = lastMS + (mgulong)(1000.0f / fps);
+			decoded = DecodeFrame(frame);
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (!decoded)
+		{
+			free.push_back(frame);
+			ended = true;
+			produced.notify_one();
+			return;
+		}
+
+		frame->clockMS = loopMS + frame->positionMS;
+		lastMS = frame->clockMS;
+		ready.push_back(frame);
+		produced.notify_one();
+	}
+}
+
+mgulong MGM_VideoDecoder_Threaded::GetPosition()
+{
+	return position;
+}
+
+void MGM_VideoDecoder_Threaded::SetLooped(mgbool looped)
+{
+	this->looped = looped != 0;
+}
+
+void MGM_VideoDecoder_Threaded::SetPlanar(mgbool planar)
+{
+	this->planar = planar != 0;
+}
+
+void MGM_VideoDecoder_Threaded::GetPlanes(MGG_Texture*& y, MGG_Texture*& u, MGG_Texture*& v)
+{
+	y = currentPlanes[0];
+	u = currentPlanes[1];
+	v = currentPlanes[2];
+}
+
+void MGM_VideoDecoder_Threaded::Upload(MGM_VideoFrame* frame)
+{
+	if (!frame->planar)
+	{
+		current = textures[nextTexture];
+		MGG_Texture_SetData(device, current, 0, 0, 0, 0, 0, width, height, 1, frame->pixels.data(), width * height * 4);
+		currentPlanes[0] = currentPlanes[1] = currentPlanes[2] = nullptr;
+		return;
+	}
+
+	// The Y texture is returned as the frame and the
+	// chroma textures are fetched with GetPlanes.
+	auto slot = planes.data() + (nextTexture * 3);
+	if (slot[0] == nullptr)
+	{
+		slot[0] = MGG_Texture_Create(device, MGTextureType::_2D, MGSurfaceFormat::Alpha8, width, height, 1, 1, 1);
+		slot[1] = MGG_Texture_Create(device, MGTextureType::_2D, MGSurfaceFormat::Alpha8, chromaWidth, chromaHeight, 1, 1, 1);
+		slot[2] = MGG_Texture_Create(device, MGTextureType::_2D, MGSurfaceFormat::Alpha8, chromaWidth, chromaHeight, 1, 1, 1);
+	}
+
+	auto lumaBytes = width * height;
+	auto chromaBytes = chromaWidth * chromaHeight;
+	auto data = frame->pixels.data();
+	MGG_Texture_SetData(device, slot[0], 0, 0, 0, 0, 0, width, height, 1, data, lumaBytes);
+	MGG_Texture_SetData(device, slot[1], 0, 0, 0, 0, 0, chromaWidth, chromaHeight, 1, data + lumaBytes, chromaBytes);
+	MGG_Texture_SetData(device, slot[2], 0, 0, 0, 0, 0, chromaWidth, chromaHeight, 1, data + lumaBytes + chromaBytes, chromaBytes);
+
+	current = slot[0];
+	currentPlanes[0] = slot[0];
+	currentPlanes[1] = slot[1];
+	currentPlanes[2] = slot[2];
+}
+
+void MGM_VideoDecoder_Threaded::SetPaced(bool paced)
+{
+	this->paced = paced;
+}
+
+MGM_VideoFrame* MGM_VideoDecoder_Threaded::NextFrame()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	produced.wait(lock, [this] { return quit || ended || !ready.empty(); });
+
+	if (ready.empty())
+		return nullptr;
+
+	auto frame = ready.front();
+	ready.pop_front();
+	return frame;
+}
+
+MGM_VideoFrame* MGM_VideoDecoder_Threaded::DueFrame()
+{
+	auto now = std::chrono::steady_clock::now();
+	if (started)
+	{
+		auto elapsed = (mgulong)std::chrono::duration_cast<std::chrono::milliseconds>(now - lastDecode).count();
+		clockMS += std::min(elapsed, MGM_Video_MaxStepMS);
+	}
+	started = true;
+	lastDecode = now;
+
+	MGM_VideoFrame* show = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		// If we've fallen behind skip to the newest frame that is due.
+		while (!ready.empty() && ready.front()->clockMS <= clockMS)
+		{
+			if (show)
+				free.push_back(show);
+			show = ready.front();
+			ready.pop_front();
+		}
+	}
+
+	return show;
+}
+
+bool MGM_VideoDecoder_Threaded::Finished()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return ended && ready.empty();
+}
+
+MGG_Texture* MGM_VideoDecoder_Threaded::Decode()
+{
+	auto show = paced ? DueFrame() : NextFrame();
+	if (show == nullptr)
+		return Finished() ? nullptr : current;
+
+	// The frame is in neither list, so the
+	// worker won't touch it during the upload.
+	Upload(show);
+	nextTexture = (nextTexture + 1) % MGM_Video_Textures;
+	position = show->positionMS;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		free.push_back(show);
+	}
+	wake.notify_one();
+
+	return current;
+}
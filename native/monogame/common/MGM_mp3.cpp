@@ -0,0 +1,362 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "api_MGM.h"
+#include "api_MG_Asset.h"
+#include "MG_Asset_common.h"
+
+#include "MGM_common.h"
+
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <string.h>
+
+// minimp3 uses SSE2 or NEON when the target has it.
+#define MINIMP3_IMPLEMENTATION
+#include "minimp3.h"
+
+
+// This is about 185ms at 44.1Khz which keeps the
+// voice fed between the streaming thread wakeups.
+static const int MGM_Mp3_FramesPerDecode = 8192;
+
+// The bit reservoir lets a frame use data from the ones
+// before it, so seeks start decoding a few frames early.
+static const int MGM_Mp3_SeekPreroll = 4;
+static const int MGM_Mp3_SamplesPerFrame = 1152;
+
+// The index counts every frame from its header, so frames missing
+// their bit reservoir or changing the channel count, which we can't
+// mix in, play as silence to keep the position in step with it.
+static int MGM_Mp3_Silence(const mgbyte* header, int count, int frameChannels, int channels, mp3d_sample_t* output)
+{
+	if (count > 0 && frameChannels == channels)
+		return count;
+
+	count = hdr_frame_samples(header);
+	memset(output, 0, count * channels * sizeof(mp3d_sample_t));
+	return count;
+}
+
+struct MGM_AudioDecoder_Mp3 : MGM_AudioDecoder
+{
+	MG_Asset* asset = nullptr;
+	const mgbyte* data = nullptr;
+	mglong length = 0;
+
+	mp3dec_t decoder;
+
+	mgint channels = 0;
+	mgint samplerate = 0;
+
+	MGM_SeekIndex index;
+
+	// The first frame after any ID3 tag.
+	mglong start = 0;
+
+	// The next frame to decode and its first sample.
+	mglong position = 0;
+	mgulong sample = 0;
+	mgulong seekSample = 0;
+
+	std::vector<mp3d_sample_t> pcm;
+
+	~MGM_AudioDecoder_Mp3() override
+	{
+		if (asset)
+			MG_Asset_Close(asset);
+	}
+
+	static mglong SkipID3(const mgbyte* data, mglong length)
+	{
+		// The tag size is stored as a 28bit syncsafe integer.
+		if (length < 10 || memcmp(data, "ID3", 3) != 0)
+			return 0;
+
+		auto size = ((data[6] & 0x7F) << 21) | ((data[7] & 0x7F) << 14) | ((data[8] & 0x7F) << 7) | (data[9] & 0x7F);
+		auto footer = (data[5] & 0x10) ? 10 : 0;
+		return std::min<mglong>(length, 10 + size + footer);
+	}
+
+	int Remaining(mglong offset) const
+	{
+		return (int)std::min<mglong>(length - offset, INT_MAX);
+	}
+
+	void BuildIndex(mgbyte* filepath)
+	{
+		// Passing no output only parses the frame headers,
+		// which is cheap enough to index the whole file.
+		// Decode plays frames that don't decode as silence
+		// so it stays in step with the header counts.
+		mp3dec_init(&decoder);
+
+		mp3dec_frame_info_t frame;
+		for (auto offset = start; offset < length; offset += frame.frame_bytes)
+		{
+			auto count = mp3dec_decode_frame(&decoder, data + offset, Remaining(offset), nullptr, &frame);
+			if (frame.frame_bytes == 0)
+				break;
+			if (count == 0)
+				continue;
+
+			// Keep a point about every 100ms.
+			if (index.points.empty())
+			{
+				index.channels = frame.channels;
+				index.samplerate = frame.hz;
+				index.spacing = frame.hz / 10;
+			}
+
+			index.Add(index.samples, offset + frame.frame_offset);
+			index.samples += count;
+		}
+
+		index.Save(filepath, data, length);
+	}
+
+	void Initialize(mgbyte* filepath, MGM_AudioDecoderInfo& info) override
+	{
+		info.samplerate = 0;
+		info.channels = 0;
+		info.duration = 0;
+
+		if (!MG_Asset_Open((const char*)filepath, asset, length))
+		{
+			asset = nullptr;
+			return;
+		}
+
+		mgbyte* mapped;
+		if (!MG_Asset_Load(asset, mapped) || mapped == nullptr)
+			return;
+		data = mapped;
+
+		start = SkipID3(data, length);
+
+		// A 10 minute track is tens of thousands of frames, so
+		// a shipped or cached index is used when there is one.
+		if (!index.Load(filepath, data, length))
+			BuildIndex(filepath);
+
+		if (index.points.empty())
+			return;
+
+		channels = index.channels;
+		samplerate = index.samplerate;
+
+		mp3dec_init(&decoder);
+		position = start;
+
+		pcm.resize((MGM_Mp3_FramesPerDecode * channels) + MINIMP3_MAX_SAMPLES_PER_FRAME);
+
+		info.samplerate = samplerate;
+		info.channels = channels;
+		info.duration = (index.samples * 1000) / samplerate;
+	}
+
+	void SetPosition(mgulong timeMS) override
+	{
+		if (index.points.empty())
+			return;
+
+		auto target = std::min((timeMS * samplerate) / 1000, index.samples);
+
+		// Start far enough back to fill the bit reservoir.
+		auto preroll = (mgulong)MGM_Mp3_SeekPreroll * MGM_Mp3_SamplesPerFrame;
+		auto point = index.Find(target - std::min(target, preroll));
+
+		mp3dec_init(&decoder);
+		position = point.offset;
+		sample = point.sample;
+		seekSample = target;
+	}
+
+	bool Decode(mgbyte*& buffer, mguint& size) override
+	{
+		buffer = (mgbyte*)pcm.data();
+		size = 0;
+
+		if (index.points.empty())
+			return true;
+
+		mgint decoded = 0;
+
+		while (decoded < MGM_Mp3_FramesPerDecode && position < length)
+		{
+			auto output = pcm.data() + (decoded * channels);
+
+			mp3dec_frame_info_t frame = {};
+			auto count = mp3dec_decode_frame(&decoder, data + position, Remaining(position), output, &frame);
+			if (frame.frame_bytes == 0)
+			{
+				position = length;
+				break;
+			}
+
+			auto header = data + position + frame.frame_offset;
+			position += frame.frame_bytes;
+
+			// Junk between frames has no header and isn't indexed.
+			if (frame.hz == 0)
+				continue;
+
+			count = MGM_Mp3_Silence(header, count, frame.channels, channels, output);
+
+			auto first = sample;
+			sample += count;
+
+			// Drop the preroll and the part of the frame before the seek point.
+			if (seekSample > 0)
+			{
+				auto skip = (mgint)std::min<mgulong>(seekSample - std::min(seekSample, first), count);
+				if (skip == count)
+					continue;
+
+				memmove(output, output + (skip * channels), (count - skip) * channels * sizeof(mp3d_sample_t));
+				count -= skip;
+				seekSample = 0;
+			}
+
+			decoded += count;
+		}
+
+		size = (mguint)(decoded * channels * sizeof(mp3d_sample_t));
+		return position >= length;
+	}
+};
+
+
+// MP3 audio muxed into an MP4 file, where the container
+// already has where every frame is and its time.
+struct MGM_AudioDecoder_Mp4Mp3 : MGM_AudioDecoder
+{
+	const mgbyte* data = nullptr;
+	std::vector<MGM_Mp4Sample> samples;
+	mguint timescale = 0;
+
+	mp3dec_t decoder;
+
+	mgint channels = 0;
+	mgint samplerate = 0;
+
+	// The next frame to decode.
+	size_t next = 0;
+	mgulong seekSample = 0;
+
+	std::vector<mp3d_sample_t> pcm;
+
+	void Initialize(mgbyte* filepath, MGM_AudioDecoderInfo& info) override
+	{
+		// Set up from the video decoder's track instead.
+	}
+
+	// The first output sample of a frame from its container time.
+	mgulong SampleAt(size_t index) const
+	{
+		return (samples[index].time * samplerate) / timescale;
+	}
+
+	void SetPosition(mgulong timeMS) override
+	{
+		auto target = (timeMS * samplerate) / 1000;
+
+		// Start far enough back to fill the bit reservoir.
+		next = 0;
+		while (next + 1 < samples.size() && SampleAt(next + 1) <= target)
+			next++;
+		next -= std::min<size_t>(next, MGM_Mp3_SeekPreroll);
+
+		mp3dec_init(&decoder);
+		seekSample = target;
+	}
+
+	bool Decode(mgbyte*& buffer, mguint& size) override
+	{
+		buffer = (mgbyte*)pcm.data();
+		size = 0;
+
+		mgint decoded = 0;
+
+		while (decoded < MGM_Mp3_FramesPerDecode && next < samples.size())
+		{
+			auto output = pcm.data() + (decoded * channels);
+			auto first = SampleAt(next);
+			auto& sample = samples[next++];
+
+			mp3dec_frame_info_t frame = {};
+			auto count = mp3dec_decode_frame(&decoder, data + sample.offset, (int)sample.size, output, &frame);
+			if (frame.hz == 0)
+				continue;
+
+			count = MGM_Mp3_Silence(data + sample.offset + frame.frame_offset, count, frame.channels, channels, output);
+
+			// Drop the preroll and the part of the frame before the seek point.
+			if (seekSample > 0)
+			{
+				auto skip = (mgint)std::min<mgulong>(seekSample - std::min(seekSample, first), count);
+				if (skip == count)
+					continue;
+
+				memmove(output, output + (skip * channels), (count - skip) * channels * sizeof(mp3d_sample_t));
+				count -= skip;
+				seekSample = 0;
+			}
+
+			decoded += count;
+		}
+
+		size = (mguint)(decoded * channels * sizeof(mp3d_sample_t));
+		return next >= samples.size();
+	}
+};
+
+MGM_AudioDecoder* MGM_AudioDecoder_CreateMp4Mp3(const mgbyte* data, const MGM_Mp4Track& track, MGM_AudioDecoderInfo& info)
+{
+	info.samplerate = 0;
+	info.channels = 0;
+	info.duration = 0;
+
+	if (track.samples.empty() || track.timescale == 0)
+		return nullptr;
+
+	// The sample entry is often left at defaults, so
+	// the format comes from the first frame header.
+	mp3dec_t decoder;
+	mp3dec_init(&decoder);
+
+	mp3dec_frame_info_t frame;
+	auto& first = track.samples[0];
+	if (mp3dec_decode_frame(&decoder, data + first.offset, (int)first.size, nullptr, &frame) == 0 || frame.channels == 0 || frame.hz == 0)
+		return nullptr;
+
+	auto mp3 = new MGM_AudioDecoder_Mp4Mp3();
+	mp3->data = data;
+	mp3->samples = track.samples;
+	mp3->timescale = track.timescale;
+	mp3->channels = frame.channels;
+	mp3->samplerate = frame.hz;
+	mp3->pcm.resize((MGM_Mp3_FramesPerDecode * frame.channels) + MINIMP3_MAX_SAMPLES_PER_FRAME);
+	mp3dec_init(&mp3->decoder);
+
+	info.samplerate = mp3->samplerate;
+	info.channels = mp3->channels;
+	info.duration = (track.duration * 1000) / track.timescale;
+	return mp3;
+}
+
+
+MGM_AudioDecoder* MGM_AudioDecoder_TryCreate_Mp3(MGM_SIGNATURE)
+{
+	auto bytes = (const mgbyte*)signature;
+
+	// Either an ID3 tag or a frame sync with a valid layer.
+	auto isID3 = memcmp(signature, "ID3", 3) == 0;
+	auto isFrame = bytes[0] == 0xFF && (bytes[1] & 0xE0) == 0xE0 && (bytes[1] & 0x06) != 0;
+	if (!isID3 && !isFrame)
+		return nullptr;
+
+	return new MGM_AudioDecoder_Mp3();
+}
@@ -0,0 +1,405 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "api_MGM.h"
+
+#include "MGM_common.h"
+
+#include <algorithm>
+#include <string.h>
+
+
+// Only the boxes needed to find the samples of each track
+// are read, everything else in the file is skipped over.
+
+struct MGM_Mp4_Reader
+{
+	const mgbyte* data;
+	mglong offset;
+	mglong end;
+
+	bool Has(mglong bytes) const
+	{
+		return bytes >= 0 && offset + bytes <= end;
+	}
+
+	void Skip(mglong bytes)
+	{
+		offset = std::min(end, offset + bytes);
+	}
+
+	mguint U8()
+	{
+		if (!Has(1))
+			return 0;
+		return data[offset++];
+	}
+
+	mguint U16()
+	{
+		if (!Has(2))
+		{
+			offset = end;
+			return 0;
+		}
+		auto value = (data[offset] << 8) | data[offset + 1];
+		offset += 2;
+		return value;
+	}
+
+	mguint U32()
+	{
+		if (!Has(4))
+		{
+			offset = end;
+			return 0;
+		}
+		auto value = ((mguint)data[offset] << 24) | (data[offset + 1] << 16) | (data[offset + 2] << 8) | data[offset + 3];
+		offset += 4;
+		return value;
+	}
+
+	mgulong U64()
+	{
+		auto high = (mgulong)U32();
+		return (high << 32) | U32();
+	}
+
+	// Returns false at the end or on a box which
+	// doesn't fit, which ends the parent too.
+	bool NextBox(mguint& type, MGM_Mp4_Reader& box)
+	{
+		if (!Has(8))
+			return false;
+
+		auto start = offset;
+		mgulong size = U32();
+		type = U32();
+
+		if (size == 1)
+		{
+			if (!Has(8))
+				return false;
+			size = U64();
+		}
+		else if (size == 0)
+			size = end - start;
+
+		auto header = offset - start;
+		if (size < (mgulong)header || size > (mgulong)(end - start))
+			return false;
+
+		box = { data, offset, start + (mglong)size };
+		offset = box.end;
+		return true;
+	}
+};
+
+// The counts in the sample tables come from the file, so
+// check they fit in the box before allocating for them.
+static bool MGM_Mp4_FitsCount(const MGM_Mp4_Reader& box, mguint count, mglong entryBytes)
+{
+	return (mglong)count * entryBytes <= box.end - box.offset;
+}
+
+static mguint MGM_Mp4_DescriptorSize(MGM_Mp4_Reader& box)
+{
+	mguint size = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		auto byte = box.U8();
+		size = (size << 7) | (byte & 0x7F);
+		if ((byte & 0x80) == 0)
+			break;
+	}
+	return size;
+}
+
+// Finds the codec of an MPEG-4 audio entry.
+static void MGM_Mp4_ReadESDS(MGM_Mp4_Reader box, MGM_Mp4Track& track)
+{
+	box.Skip(4);
+
+	if (box.U8() != 0x03)
+		return;
+	MGM_Mp4_DescriptorSize(box);
+
+	box.Skip(2);
+	auto flags = box.U8();
+	if (flags & 0x80)
+		box.Skip(2);
+	if (flags & 0x40)
+		box.Skip(box.U8());
+	if (flags & 0x20)
+		box.Skip(2);
+
+	if (box.U8() != 0x04)
+		return;
+	MGM_Mp4_DescriptorSize(box);
+
+	track.objectType = (mgint)box.U8();
+}
+
+static void MGM_Mp4_ReadSTSD(MGM_Mp4_Reader box, MGM_Mp4Track& track)
+{
+	box.Skip(4);
+	if (box.U32() == 0)
+		return;
+
+	// Only the first entry is used.
+	mguint type;
+	MGM_Mp4_Reader entry;
+	if (!box.NextBox(type, entry))
+		return;
+
+	track.format = type;
+
+	if (track.handler == MGM_MP4_TYPE('v', 'i', 'd', 'e'))
+		entry.Skip(78);
+	else if (track.handler == MGM_MP4_TYPE('s', 'o', 'u', 'n'))
+	{
+		entry.Skip(8);
+		auto version = entry.U16();
+		entry.Skip(6);
+		track.channels = (mgint)entry.U16();
+		entry.Skip(6);
+		track.samplerate = (mgint)(entry.U32() >> 16);
+
+		// QuickTime adds more fields to the newer versions.
+		if (version == 1)
+			entry.Skip(16);
+		else if (version == 2)
+			entry.Skip(36);
+	}
+	else
+		return;
+
+	MGM_Mp4_Reader child;
+	while (entry.NextBox(type, child))
+	{
+		if (type == MGM_MP4_TYPE('a', 'v', 'c', 'C'))
+			track.config.assign(child.data + child.offset, child.data + child.end);
+		else if (type == MGM_MP4_TYPE('e', 's', 'd', 's'))
+			MGM_Mp4_ReadESDS(child, track);
+	}
+}
+
+struct MGM_Mp4_Tables
+{
+	std::vector<mguint> timeCounts;
+	std::vector<mguint> timeDeltas;
+	std::vector<mguint> syncSamples;
+	bool hasSync = false;
+	std::vector<mguint> chunkFirst;
+	std::vector<mguint> chunkSamples;
+	mguint sampleSize = 0;
+	std::vector<mguint> sampleSizes;
+	mguint sampleCount = 0;
+	std::vector<mgulong> chunkOffsets;
+};
+
+static void MGM_Mp4_ReadSTBL(MGM_Mp4_Reader stbl, MGM_Mp4Track& track, MGM_Mp4_Tables& tables)
+{
+	mguint type;
+	MGM_Mp4_Reader box;
+	while (stbl.NextBox(type, box))
+	{
+		if (type == MGM_MP4_TYPE('s', 't', 's', 'd'))
+		{
+			MGM_Mp4_ReadSTSD(box, track);
+			continue;
+		}
+
+		box.Skip(4);
+		auto count = box.U32();
+
+		if (type == MGM_MP4_TYPE('s', 't', 't', 's') && MGM_Mp4_FitsCount(box, count, 8))
+		{
+			for (mguint i = 0; i < count; i++)
+			{
+				tables.timeCounts.push_back(box.U32());
+				tables.timeDeltas.push_back(box.U32());
+			}
+		}
+		else if (type == MGM_MP4_TYPE('s', 't', 's', 's') && MGM_Mp4_FitsCount(box, count, 4))
+		{
+			tables.hasSync = true;
+			for (mguint i = 0; i < count; i++)
+				tables.syncSamples.push_back(box.U32());
+		}
+		else if (type == MGM_MP4_TYPE('s', 't', 's', 'c') && MGM_Mp4_FitsCount(box, count, 12))
+		{
+			for (mguint i = 0; i < count; i++)
+			{
+				tables.chunkFirst.push_back(box.U32());
+				tables.chunkSamples.push_back(box.U32());
+				box.Skip(4);
+			}
+		}
+		else if (type == MGM_MP4_TYPE('s', 't', 's', 'z'))
+		{
+			// The count is the second field here.
+			tables.sampleSize = count;
+			tables.sampleCount = box.U32();
+			if (tables.sampleSize == 0 && MGM_Mp4_FitsCount(box, tables.sampleCount, 4))
+			{
+				for (mguint i = 0; i < tables.sampleCount; i++)
+					tables.sampleSizes.push_back(box.U32());
+			}
+		}
+		else if (type == MGM_MP4_TYPE('s', 't', 'c', 'o') && MGM_Mp4_FitsCount(box, count, 4))
+		{
+			for (mguint i = 0; i < count; i++)
+				tables.chunkOffsets.push_back(box.U32());
+		}
+		else if (type == MGM_MP4_TYPE('c', 'o', '6', '4') && MGM_Mp4_FitsCount(box, count, 8))
+		{
+			for (mguint i = 0; i < count; i++)
+				tables.chunkOffsets.push_back(box.U64());
+		}
+	}
+}
+
+// Expands the run length coded tables into one entry per sample.
+static bool MGM_Mp4_BuildSamples(const MGM_Mp4_Tables& tables, mglong length, MGM_Mp4Track& track)
+{
+	auto count = tables.sampleCount;
+	if (count == 0 || (tables.sampleSize == 0 && tables.sampleSizes.size() != count))
+		return false;
+	if ((mgulong)count * tables.sampleSize > (mgulong)length)
+		return false;
+	if (tables.chunkFirst.empty() || tables.chunkOffsets.empty())
+		return false;
+
+	track.samples.resize(count);
+
+	mgulong time = 0;
+	mguint index = 0;
+	for (size_t i = 0; i < tables.timeCounts.size() && index < count; i++)
+	{
+		for (mguint j = 0; j < tables.timeCounts[i] && index < count; j++, index++)
+		{
+			track.samples[index].time = time;
+			time += tables.timeDeltas[i];
+		}
+	}
+	for (; index < count; index++)
+		track.samples[index].time = time;
+
+	for (mguint i = 0; i < count; i++)
+		track.samples[i].sync = !tables.hasSync;
+	for (auto number : tables.syncSamples)
+	{
+		if (number >= 1 && number <= count)
+			track.samples[number - 1].sync = true;
+	}
+
+	index = 0;
+	for (size_t entry = 0; entry < tables.chunkFirst.size() && index < count; entry++)
+	{
+		auto first = (size_t)tables.chunkFirst[entry];
+		auto last = entry + 1 < tables.chunkFirst.size() ? (size_t)tables.chunkFirst[entry + 1] : tables.chunkOffsets.size() + 1;
+		if (first < 1)
+			return false;
+
+		for (auto chunk = first; chunk < last && chunk <= tables.chunkOffsets.size() && index < count; chunk++)
+		{
+			auto offset = tables.chunkOffsets[chunk - 1];
+			for (mguint j = 0; j < tables.chunkSamples[entry] && index < count; j++, index++)
+			{
+				auto size = tables.sampleSize != 0 ? tables.sampleSize : tables.sampleSizes[index];
+				if (offset + size > (mgulong)length)
+					return false;
+
+				track.samples[index].offset = (mglong)offset;
+				track.samples[index].size = size;
+				offset += size;
+			}
+		}
+	}
+
+	// A table that didn't cover every sample is broken.
+	return index == count;
+}
+
+static void MGM_Mp4_ReadTrack(MGM_Mp4_Reader trak, mglong length, std::vector<MGM_Mp4Track>& tracks)
+{
+	MGM_Mp4Track track;
+	MGM_Mp4_Tables tables;
+
+	mguint type;
+	MGM_Mp4_Reader mdia;
+	while (trak.NextBox(type, mdia))
+	{
+		if (type != MGM_MP4_TYPE('m', 'd', 'i', 'a'))
+			continue;
+
+		// The handler comes before the sample tables
+		// which need it to read the sample entry.
+		MGM_Mp4_Reader box;
+		while (mdia.NextBox(type, box))
+		{
+			if (type == MGM_MP4_TYPE('m', 'd', 'h', 'd'))
+			{
+				auto version = box.U8();
+				box.Skip(3);
+				if (version == 1)
+				{
+					box.Skip(16);
+					track.timescale = box.U32();
+					track.duration = box.U64();
+				}
+				else
+				{
+					box.Skip(8);
+					track.timescale = box.U32();
+					track.duration = box.U32();
+				}
+			}
+			else if (type == MGM_MP4_TYPE('h', 'd', 'l', 'r'))
+			{
+				box.Skip(8);
+				track.handler = box.U32();
+			}
+			else if (type == MGM_MP4_TYPE('m', 'i', 'n', 'f'))
+			{
+				MGM_Mp4_Reader stbl;
+				while (box.NextBox(type, stbl))
+				{
+					if (type == MGM_MP4_TYPE('s', 't', 'b', 'l'))
+						MGM_Mp4_ReadSTBL(stbl, track, tables);
+				}
+			}
+		}
+	}
+
+	if (track.timescale == 0 || !MGM_Mp4_BuildSamples(tables, length, track))
+		return;
+
+	tracks.push_back(std::move(track));
+}
+
+bool MGM_Mp4_ReadTracks(const mgbyte* data, mglong length, std::vector<MGM_Mp4Track>& tracks)
+{
+	tracks.clear();
+
+	MGM_Mp4_Reader file = { data, 0, length };
+
+	mguint type;
+	MGM_Mp4_Reader moov;
+	while (file.NextBox(type, moov))
+	{
+		if (type != MGM_MP4_TYPE('m', 'o', 'o', 'v'))
+			continue;
+
+		MGM_Mp4_Reader trak;
+		while (moov.NextBox(type, trak))
+		{
+			if (type == MGM_MP4_TYPE('t', 'r', 'a', 'k'))
+				MGM_Mp4_ReadTrack(trak, length, tracks);
+		}
+	}
+
+	return !tracks.empty();
+}
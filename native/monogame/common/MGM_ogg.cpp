@@ -0,0 +1,127 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "api_MGM.h"
+#include "api_MG_Asset.h"
+#include "MG_Asset_common.h"
+
+#include "MGM_common.h"
+
+#include <vector>
+#include <climits>
+#include <string.h>
+
+// We decode from memory, so skip the
+// file and push data parts of the API.
+#define STB_VORBIS_NO_STDIO
+#define STB_VORBIS_NO_PUSHDATA_API
+#include "stb_vorbis.c"
+
+
+// This is about 185ms at 44.1Khz which keeps the
+// voice fed between the streaming thread wakeups.
+static const int MGM_Ogg_FramesPerDecode = 8192;
+
+struct MGM_AudioDecoder_Ogg : MGM_AudioDecoder
+{
+	// The file is mapped for the life of the decoder
+	// which lets stb_vorbis seek without any I/O.
+	MG_Asset* asset = nullptr;
+	stb_vorbis* vorbis = nullptr;
+
+	mgint channels = 0;
+	mgint samplerate = 0;
+	mgulong frames = 0;
+
+	// Set by seeking to or past the end.
+	bool ended = false;
+
+	std::vector<short> pcm;
+
+	~MGM_AudioDecoder_Ogg() override
+	{
+		if (vorbis)
+			stb_vorbis_close(vorbis);
+		if (asset)
+			MG_Asset_Close(asset);
+	}
+
+	void Initialize(mgbyte* filepath, MGM_AudioDecoderInfo& info) override
+	{
+		info.samplerate = 0;
+		info.channels = 0;
+		info.duration = 0;
+
+		mglong length;
+		if (!MG_Asset_Open((const char*)filepath, asset, length))
+		{
+			asset = nullptr;
+			return;
+		}
+
+		mgbyte* data;
+		if (length > INT_MAX || !MG_Asset_Load(asset, data))
+			return;
+
+		int error;
+		vorbis = stb_vorbis_open_memory(data, (int)length, &error, nullptr);
+		if (vorbis == nullptr)
+			return;
+
+		auto vinfo = stb_vorbis_get_info(vorbis);
+		channels = vinfo.channels;
+		samplerate = (mgint)vinfo.sample_rate;
+		frames = stb_vorbis_stream_length_in_samples(vorbis);
+
+		pcm.resize(MGM_Ogg_FramesPerDecode * channels);
+
+		info.samplerate = samplerate;
+		info.channels = channels;
+		info.duration = samplerate > 0 ? (frames * 1000) / samplerate : 0;
+	}
+
+	void SetPosition(mgulong timeMS) override
+	{
+		if (vorbis == nullptr)
+			return;
+
+		// Seeking to the end has nothing left to play
+		// rather than starting over from the top.
+		auto frame = (timeMS * samplerate) / 1000;
+		ended = frame >= frames;
+		if (ended)
+			return;
+
+		// stb_vorbis finds the page by bisecting on the
+		// granule positions then decodes up to the sample.
+		if (!stb_vorbis_seek(vorbis, (unsigned int)frame))
+			stb_vorbis_seek_start(vorbis);
+	}
+
+	bool Decode(mgbyte*& buffer, mguint& size) override
+	{
+		buffer = nullptr;
+		size = 0;
+
+		if (vorbis == nullptr || ended)
+			return true;
+
+		// This only returns less than we asked for at the end.
+		auto decoded = stb_vorbis_get_samples_short_interleaved(vorbis, channels, pcm.data(), (int)pcm.size());
+
+		buffer = (mgbyte*)pcm.data();
+		size = (mguint)(decoded * channels * sizeof(short));
+
+		return decoded < MGM_Ogg_FramesPerDecode;
+	}
+};
+
+
+MGM_AudioDecoder* MGM_AudioDecoder_TryCreate_Ogg(MGM_SIGNATURE)
+{
+	if (memcmp(signature, "OggS", 4) != 0)
+		return nullptr;
+
+	return new MGM_AudioDecoder_Ogg();
+}
@@ -0,0 +1,721 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "api_MGM.h"
+#include "api_MG_Asset.h"
+#include "MG_Asset_common.h"
+
+#include "MGM_common.h"
+
+#include <vector>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+
+// OpenH264 is loaded at runtime, so games only ship it when they
+// want H.264 and can use Cisco's binaries which covers the patent
+// license.  These mirror the parts of codec_api.h we use which
+// have kept the same layout since the 2.0 release.
+
+#if defined(_WIN32)
+#define MGM_H264_API __stdcall
+#else
+#define MGM_H264_API
+#endif
+
+struct MGM_H264_DecodingParam
+{
+	char* pFileNameRestructed;
+	unsigned int uiCpuLoad;
+	unsigned char uiTargetDqLayer;
+	int eEcActiveIdc;
+	bool bParseOnly;
+	unsigned int videoPropertySize;
+	int eVideoBsType;
+};
+
+struct MGM_H264_BufferInfo
+{
+	int iBufferStatus;
+	unsigned long long uiInBsTimeStamp;
+	unsigned long long uiOutYuvTimeStamp;
+	int iWidth;
+	int iHeight;
+	int iFormat;
+	int iStride[2];
+	unsigned char* pDst[3];
+};
+
+struct MGM_H264_Version
+{
+	unsigned int uMajor;
+	unsigned int uMinor;
+	unsigned int uRevision;
+	unsigned int uReserved;
+};
+
+class MGM_H264_ISVCDecoder
+{
+public:
+	virtual long MGM_H264_API Initialize(const MGM_H264_DecodingParam* pParam) = 0;
+	virtual long MGM_H264_API Uninitialize() = 0;
+	virtual int MGM_H264_API DecodeFrame(const unsigned char* pSrc, const int iSrcLen, unsigned char** ppDst, int* pStride, int& iWidth, int& iHeight) = 0;
+	virtual int MGM_H264_API DecodeFrameNoDelay(const unsigned char* pSrc, const int iSrcLen, unsigned char** ppDst, MGM_H264_BufferInfo* pDstInfo) = 0;
+};
+
+typedef int (*MGM_H264_CreateFunc)(MGM_H264_ISVCDecoder** ppDecoder);
+typedef void (*MGM_H264_DestroyFunc)(MGM_H264_ISVCDecoder* pDecoder);
+typedef void (*MGM_H264_VersionFunc)(MGM_H264_Version* pVersion);
+
+static const int MGM_H264_VIDEO_BITSTREAM_AVC = 0;
+static const int MGM_H264_ERROR_CON_SLICE_COPY = 2;
+
+struct MGM_H264_Library
+{
+	std::once_flag once;
+	MGM_H264_CreateFunc create = nullptr;
+	MGM_H264_DestroyFunc destroy = nullptr;
+};
+
+static MGM_H264_Library s_OpenH264;
+
+
+static void* MGM_H264_LoadLibrary(const char* name)
+{
+#if defined(_WIN32)
+	return ::LoadLibraryA(name);
+#else
+	return dlopen(name, RTLD_NOW | RTLD_LOCAL);
+#endif
+}
+
+static void* MGM_H264_GetProc(void* library, const char* name)
+{
+#if defined(_WIN32)
+	return (void*)::GetProcAddress((HMODULE)library, name);
+#else
+	return dlsym(library, name);
+#endif
+}
+
+static void MGM_H264_Load()
+{
+	// The environment can point at a specific build, else we
+	// try the names Cisco's binaries are usually installed as.
+	const char* names[] =
+	{
+		getenv("MONOGAME_OPENH264"),
+#if defined(_WIN32)
+		"openh264.dll",
+		"openh264-2.4.1-win64.dll",
+#elif defined(__APPLE__)
+		"libopenh264.dylib",
+		"libopenh264.7.dylib",
+#else
+		"libopenh264.so",
+		"libopenh264.so.7",
+		"libopenh264.so.6",
+#endif
+	};
+
+	void* library = nullptr;
+	for (auto name : names)
+	{
+		if (name && (library = MGM_H264_LoadLibrary(name)) != nullptr)
+			break;
+	}
+
+	if (library == nullptr)
+		return;
+
+	auto version = (MGM_H264_VersionFunc)MGM_H264_GetProc(library, "WelsGetCodecVersionEx");
+	auto create = (MGM_H264_CreateFunc)MGM_H264_GetProc(library, "WelsCreateDecoder");
+	auto destroy = (MGM_H264_DestroyFunc)MGM_H264_GetProc(library, "WelsDestroyDecoder");
+	if (!version || !create || !destroy)
+		return;
+
+	// Older releases have a different interface layout.
+	MGM_H264_Version info = {};
+	version(&info);
+	if (info.uMajor < 2)
+		return;
+
+	// The library stays loaded for the life of the process.
+	s_OpenH264.create = create;
+	s_OpenH264.destroy = destroy;
+}
+
+static bool MGM_H264_IsAvailable()
+{
+	std::call_once(s_OpenH264.once, MGM_H264_Load);
+	return s_OpenH264.create != nullptr;
+}
+
+
+// Reads the exp-Golomb coded fields of a parameter set.
+struct MGM_H264_Bits
+{
+	std::vector<mgbyte> data;
+	size_t bit = 0;
+
+	mguint U(int count)
+	{
+		mguint value = 0;
+		for (; count > 0; count--, bit++)
+		{
+			value <<= 1;
+			if (bit < data.size() * 8)
+				value |= (data[bit >> 3] >> (7 - (bit & 7))) & 1;
+		}
+		return value;
+	}
+
+	mguint UE()
+	{
+		int zeros = 0;
+		while (U(1) == 0 && zeros < 31)
+			zeros++;
+		return ((1u << zeros) - 1) + U(zeros);
+	}
+
+	mgint SE()
+	{
+		auto code = UE();
+		return (code & 1) ? (mgint)((code + 1) / 2) : -(mgint)(code / 2);
+	}
+};
+
+struct MGM_H264_Unit
+{
+	mglong offset;
+	mglong size;
+
+	// Only set for MP4 keyframes, which get
+	// the parameter sets put in front of them.
+	bool sync;
+};
+
+struct MGM_VideoDecoder_OpenH264 : MGM_VideoDecoder_Threaded
+{
+	MG_Asset* asset = nullptr;
+	const mgbyte* data = nullptr;
+	mglong length = 0;
+
+	MGM_H264_ISVCDecoder* decoder = nullptr;
+
+	// Every access unit in the stream which each
+	// decode to one picture, built when opened.
+	std::vector<MGM_H264_Unit> units;
+	mgulong durationMS = 0;
+
+	// MP4 samples are length prefixed NAL units with the parameter
+	// sets kept in the avcC box, but the decoder wants Annex B.
+	bool mp4 = false;
+	mgint lengthSize = 4;
+	std::vector<mgbyte> parameterSets;
+	std::vector<mgbyte> annexB;
+
+	MGM_AudioDecoder* audio = nullptr;
+	MGM_AudioDecoderInfo audioInfo = {};
+
+	// Only used by the worker.
+	size_t nextUnit = 0;
+	mgulong outputFrames = 0;
+
+	~MGM_VideoDecoder_OpenH264() override
+	{
+		StopWorker();
+
+		delete audio;
+
+		if (decoder)
+		{
+			decoder->Uninitialize();
+			s_OpenH264.destroy(decoder);
+		}
+
+		if (asset)
+			MG_Asset_Close(asset);
+	}
+
+	// Returns where the next start code begins and
+	// how many bytes it is or the end of the data.
+	mglong FindStartCode(mglong offset, mglong& codeBytes) const
+	{
+		for (; offset + 3 <= length; offset++)
+		{
+			if (data[offset] != 0 || data[offset + 1] != 0)
+				continue;
+
+			if (data[offset + 2] == 1)
+			{
+				codeBytes = 3;
+				return offset;
+			}
+
+			if (offset + 4 <= length && data[offset + 2] == 0 && data[offset + 3] == 1)
+			{
+				codeBytes = 4;
+				return offset;
+			}
+		}
+
+		codeBytes = 0;
+		return length;
+	}
+
+	// Strips the emulation prevention bytes.
+	static void ReadPayload(const mgbyte* nal, mglong size, std::vector<mgbyte>& payload)
+	{
+		payload.clear();
+		for (mglong i = 1; i < size; i++)
+		{
+			if (i >= 3 && nal[i] == 3 && nal[i - 1] == 0 && nal[i - 2] == 0)
+				continue;
+			payload.push_back(nal[i]);
+		}
+	}
+
+	static void SkipScalingList(MGM_H264_Bits& bits, int size)
+	{
+		mgint last = 8;
+		mgint next = 8;
+		for (int i = 0; i < size; i++)
+		{
+			if (next != 0)
+				next = (last + bits.SE() + 256) % 256;
+			last = next == 0 ? last : next;
+		}
+	}
+
+	// Gets the picture size and frame rate from the first sequence parameter set.
+	bool ReadSPS(const mgbyte* nal, mglong size)
+	{
+		MGM_H264_Bits bits;
+		ReadPayload(nal, size, bits.data);
+
+		auto profile = bits.U(8);
+		bits.U(16);
+		bits.UE();
+
+		mguint chromaFormat = 1;
+		if (profile == 100 || profile == 110 || profile == 122 || profile == 244 || profile == 44 ||
+			profile == 83 || profile == 86 || profile == 118 || profile == 128 || profile == 138 ||
+			profile == 139 || profile == 134 || profile == 135)
+		{
+			chromaFormat = bits.UE();
+			if (chromaFormat == 3)
+				bits.U(1);
+			bits.UE();
+			bits.UE();
+			bits.U(1);
+
+			if (bits.U(1))
+			{
+				for (int i = 0; i < (chromaFormat != 3 ? 8 : 12); i++)
+				{
+					if (bits.U(1))
+						SkipScalingList(bits, i < 6 ? 16 : 64);
+				}
+			}
+		}
+
+		bits.UE();
+		auto pocType = bits.UE();
+		if (pocType == 0)
+			bits.UE();
+		else if (pocType == 1)
+		{
+			bits.U(1);
+			bits.SE();
+			bits.SE();
+			auto cycle = bits.UE();
+			for (mguint i = 0; i < cycle && i < 256; i++)
+				bits.SE();
+		}
+
+		bits.UE();
+		bits.U(1);
+
+		auto widthMbs = bits.UE() + 1;
+		auto heightMbs = bits.UE() + 1;
+		auto frameMbsOnly = bits.U(1);
+		if (!frameMbsOnly)
+			bits.U(1);
+		bits.U(1);
+
+		mgint w = widthMbs * 16;
+		mgint h = (2 - frameMbsOnly) * heightMbs * 16;
+
+		if (bits.U(1))
+		{
+			auto cropX = chromaFormat == 1 || chromaFormat == 2 ? 2 : 1;
+			auto cropY = (chromaFormat == 1 ? 2 : 1) * (2 - frameMbsOnly);
+			auto left = bits.UE();
+			auto right = bits.UE();
+			auto top = bits.UE();
+			auto bottom = bits.UE();
+			w -= (left + right) * cropX;
+			h -= (top + bottom) * cropY;
+		}
+
+		// A raw stream has no container, so without VUI
+		// timing we play it at the most common rate.
+		fps = 30.0f;
+
+		if (bits.U(1))
+		{
+			if (bits.U(1) && bits.U(8) == 255)
+				bits.U(32);
+			if (bits.U(1))
+				bits.U(1);
+			if (bits.U(1))
+			{
+				bits.U(4);
+				if (bits.U(1))
+					bits.U(24);
+			}
+			if (bits.U(1))
+			{
+				bits.UE();
+				bits.UE();
+			}
+			if (bits.U(1))
+			{
+				auto units = bits.U(32);
+				auto scale = bits.U(32);
+				if (units > 0 && scale > 0)
+					fps = (mgfloat)(scale / (2.0 * units));
+			}
+		}
+
+		width = w;
+		height = h;
+		return w > 0 && h > 0 && w <= 16384 && h <= 16384;
+	}
+
+	// Splits the stream into access units so each
+	// call to the decoder gets a whole picture.
+	bool BuildIndex()
+	{
+		mglong codeBytes;
+		auto start = FindStartCode(0, codeBytes);
+
+		MGM_H264_Unit unit = { start, 0 };
+		bool hasPicture = false;
+		bool hasSPS = false;
+
+		while (start < length)
+		{
+			auto nal = start + codeBytes;
+			auto end = FindStartCode(nal, codeBytes);
+			if (nal >= end)
+			{
+				start = end;
+				continue;
+			}
+
+			auto type = data[nal] & 0x1F;
+			auto isSlice = type == 1 || type == 5;
+
+			// A new picture starts at the first slice of the picture,
+			// which is first_mb_in_slice of 0, or any non slice unit.
+			auto firstSlice = isSlice && nal + 1 < end && (data[nal + 1] & 0x80) != 0;
+			if (hasPicture && (firstSlice || type == 6 || type == 7 || type == 8 || type == 9))
+			{
+				unit.size = start - unit.offset;
+				units.push_back(unit);
+				unit.offset = start;
+				hasPicture = false;
+			}
+
+			if (type == 7 && !hasSPS)
+				hasSPS = ReadSPS(data + nal, end - nal);
+
+			hasPicture |= isSlice;
+			start = end;
+		}
+
+		if (hasPicture)
+		{
+			unit.size = length - unit.offset;
+			units.push_back(unit);
+		}
+
+		if (!hasSPS || units.empty())
+			return false;
+
+		durationMS = (mgulong)((units.size() * 1000) / fps);
+		return true;
+	}
+
+	// Gets the length size and parameter sets from the avcC box.
+	bool ReadAVCC(const std::vector<mgbyte>& config)
+	{
+		if (config.size() < 7 || config[0] != 1)
+			return false;
+
+		lengthSize = (config[4] & 3) + 1;
+
+		size_t offset = 5;
+		bool hasSPS = false;
+
+		// The sequence then the picture parameter sets.
+		for (int set = 0; set < 2; set++)
+		{
+			if (offset >= config.size())
+				return false;
+
+			auto count = set == 0 ? (config[offset] & 0x1F) : config[offset];
+			offset++;
+
+			for (int i = 0; i < count; i++)
+			{
+				if (offset + 2 > config.size())
+					return false;
+
+				size_t size = (config[offset] << 8) | config[offset + 1];
+				offset += 2;
+				if (size == 0 || offset + size > config.size())
+					return false;
+
+				if (set == 0 && !hasSPS)
+					hasSPS = ReadSPS(config.data() + offset, (mglong)size);
+
+				const mgbyte startCode[] = { 0, 0, 0, 1 };
+				parameterSets.insert(parameterSets.end(), startCode, startCode + 4);
+				parameterSets.insert(parameterSets.end(), config.begin() + offset, config.begin() + offset + size);
+				offset += size;
+			}
+		}
+
+		return hasSPS;
+	}
+
+	// Each sample is one access unit, so the container
+	// gives us the index and the timing for free.
+	bool BuildIndexMp4()
+	{
+		std::vector<MGM_Mp4Track> tracks;
+		if (!MGM_Mp4_ReadTracks(data, length, tracks))
+			return false;
+
+		const MGM_Mp4Track* video = nullptr;
+		for (auto& track : tracks)
+		{
+			auto avc = track.format == MGM_MP4_TYPE('a', 'v', 'c', '1') || track.format == MGM_MP4_TYPE('a', 'v', 'c', '3');
+			if (track.handler == MGM_MP4_TYPE('v', 'i', 'd', 'e') && avc && !track.config.empty())
+			{
+				video = &track;
+				break;
+			}
+		}
+
+		if (video == nullptr || !ReadAVCC(video->config))
+			return false;
+
+		for (auto& sample : video->samples)
+			units.push_back({ sample.offset, sample.size, sample.sync });
+
+		// The frame times are more reliable than the track
+		// duration, else we keep the rate from the SPS.
+		auto& samples = video->samples;
+		auto span = samples.back().time - samples.front().time;
+		if (samples.size() > 1 && span > 0)
+		{
+			auto rate = ((double)(samples.size() - 1) * video->timescale) / span;
+			if (rate >= 1.0 && rate <= 240.0)
+				fps = (mgfloat)rate;
+		}
+
+		durationMS = (mgulong)((units.size() * 1000) / fps);
+
+		// We can only decode MP3 soundtracks, AAC ones are silent.
+		for (auto& track : tracks)
+		{
+			if (track.handler != MGM_MP4_TYPE('s', 'o', 'u', 'n'))
+				continue;
+
+			auto isMp3 =
+				track.format == MGM_MP4_TYPE('.', 'm', 'p', '3') ||
+				(track.format == MGM_MP4_TYPE('m', 'p', '4', 'a') && (track.objectType == 0x69 || track.objectType == 0x6B));
+
+			if (isMp3 && (audio = MGM_AudioDecoder_CreateMp4Mp3(data, track, audioInfo)) != nullptr)
+				break;
+		}
+
+		return fps > 0;
+	}
+
+	// Returns the unit as Annex B for the decoder.
+	bool GetUnit(const MGM_H264_Unit& unit, const mgbyte*& bytes, int& size)
+	{
+		if (!mp4)
+		{
+			bytes = data + unit.offset;
+			size = (int)unit.size;
+			return true;
+		}
+
+		annexB.clear();
+		if (unit.sync)
+			annexB.insert(annexB.end(), parameterSets.begin(), parameterSets.end());
+
+		auto nal = data + unit.offset;
+		auto end = nal + unit.size;
+		while (end - nal >= lengthSize)
+		{
+			mglong nalSize = 0;
+			for (int i = 0; i < lengthSize; i++)
+				nalSize = (nalSize << 8) | *nal++;
+			if (nalSize > end - nal)
+				return false;
+
+			const mgbyte startCode[] = { 0, 0, 0, 1 };
+			annexB.insert(annexB.end(), startCode, startCode + 4);
+			annexB.insert(annexB.end(), nal, nal + nalSize);
+			nal += nalSize;
+		}
+
+		bytes = annexB.data();
+		size = (int)annexB.size();
+		return size > 0;
+	}
+
+	bool DecodeFrame(MGM_VideoFrame* frame) override
+	{
+		while (nextUnit < units.size())
+		{
+			auto& unit = units[nextUnit++];
+
+			const mgbyte* bytes;
+			int size;
+			if (!GetUnit(unit, bytes, size))
+				continue;
+
+			unsigned char* planes[3] = {};
+			MGM_H264_BufferInfo info = {};
+			decoder->DecodeFrameNoDelay(bytes, size, planes, &info);
+
+			// Errors are concealed by the decoder, we only
+			// skip pictures it couldn't produce at all.
+			if (info.iBufferStatus != 1 || planes[0] == nullptr)
+				continue;
+
+			// The parameter sets are allowed to change size
+			// mid stream, but our textures can't.
+			if (info.iWidth != width || info.iHeight != height)
+				continue;
+
+			WriteFrame(frame, planes[0], info.iStride[0], planes[1], info.iStride[1], planes[2], info.iStride[1]);
+			frame->positionMS = (mgulong)((outputFrames++ * 1000) / fps);
+			return true;
+		}
+
+		return false;
+	}
+
+	bool Rewind() override
+	{
+		// The stream starts with an IDR picture
+		// so the decoder doesn't need a reset.
+		nextUnit = 0;
+		outputFrames = 0;
+		return true;
+	}
+
+	void Initialize(mgbyte* filepath, MGM_VideoDecoderInfo& info) override
+	{
+		info.width = 0;
+		info.height = 0;
+		info.fps = 0;
+		info.duration = 0;
+
+		if (!MG_Asset_Open((const char*)filepath, asset, length))
+		{
+			asset = nullptr;
+			return;
+		}
+
+		mgbyte* mapped;
+		if (length > INT32_MAX || !MG_Asset_Load(asset, mapped) || mapped == nullptr)
+			return;
+		data = mapped;
+
+		mp4 = length >= 8 && memcmp(data + 4, "ftyp", 4) == 0;
+		if (mp4 ? !BuildIndexMp4() : !BuildIndex())
+			return;
+
+		if (s_OpenH264.create(&decoder) != 0 || decoder == nullptr)
+		{
+			decoder = nullptr;
+			return;
+		}
+
+		MGM_H264_DecodingParam param = {};
+		param.uiTargetDqLayer = 0xFF;
+		param.eEcActiveIdc = MGM_H264_ERROR_CON_SLICE_COPY;
+		param.videoPropertySize = sizeof(param.videoPropertySize) + sizeof(param.eVideoBsType);
+		param.eVideoBsType = MGM_H264_VIDEO_BITSTREAM_AVC;
+		if (decoder->Initialize(&param) != 0)
+			return;
+
+		// OpenH264 only outputs 4:2:0.
+		shiftX = 1;
+		shiftY = 1;
+
+		StartWorker();
+
+		info.width = width;
+		info.height = height;
+		info.fps = fps;
+		info.duration = durationMS;
+	}
+
+	MGM_AudioDecoder* GetAudioDecoder(MGM_AudioDecoderInfo& info) override
+	{
+		// Raw H.264 streams have no audio and we
+		// keep ownership of the MP4 soundtrack.
+		info = audioInfo;
+		return audio;
+	}
+};
+
+
+MGM_VideoDecoder* MGM_VideoDecoder_TryCreate_OpenH264(MGM_SIGNATURE)
+{
+	auto bytes = (const mgbyte*)signature;
+
+	// MP4 files from the content pipeline, which fail in
+	// Initialize when there is no H.264 track.
+	if (memcmp(signature + 4, "ftyp", 4) == 0)
+		return MGM_H264_IsAvailable() ? new MGM_VideoDecoder_OpenH264() : nullptr;
+
+	// We play Annex B streams which start with a start code
+	// and then an access unit delimiter, SEI or parameter set.
+	int start;
+	if (bytes[0] == 0 && bytes[1] == 0 && bytes[2] == 1)
+		start = 3;
+	else if (bytes[0] == 0 && bytes[1] == 0 && bytes[2] == 0 && bytes[3] == 1)
+		start = 4;
+	else
+		return nullptr;
+
+	auto type = bytes[start] & 0x1F;
+	if ((bytes[start] & 0x80) != 0 || (type != 6 && type != 7 && type != 9))
+		return nullptr;
+
+	if (!MGM_H264_IsAvailable())
+		return nullptr;
+
+	return new MGM_VideoDecoder_OpenH264();
+}
@@ -0,0 +1,302 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "api_MGM.h"
+
+#include "MGM_common.h"
+
+#if defined(MG_THEORA)
+
+#include "api_MG_Asset.h"
+
+#include <vector>
+#include <algorithm>
+#include <string.h>
+
+#include <theora/theoradec.h>
+
+
+static const int MGM_Theora_ReadBytes = 64 * 1024;
+
+// The end of the file is searched this far
+// back for the last granule to get the duration.
+static const int MGM_Theora_TailBytes = 64 * 1024;
+
+struct MGM_VideoDecoder_Theora : MGM_VideoDecoder_Threaded
+{
+	MG_Asset* asset = nullptr;
+	mglong length = 0;
+
+	ogg_sync_state sync;
+	ogg_stream_state stream;
+	bool streamReady = false;
+
+	th_info theora;
+	th_comment comment;
+	th_dec_ctx* decoder = nullptr;
+
+	mgulong durationMS = 0;
+
+	MGM_VideoDecoder_Theora()
+	{
+		ogg_sync_init(&sync);
+		th_info_init(&theora);
+		th_comment_init(&comment);
+	}
+
+	~MGM_VideoDecoder_Theora() override
+	{
+		StopWorker();
+
+		CloseStream();
+		ogg_sync_clear(&sync);
+
+		if (asset)
+			MG_Asset_Close(asset);
+	}
+
+	bool ReadPage(ogg_page& page)
+	{
+		while (ogg_sync_pageout(&sync, &page) != 1)
+		{
+			auto buffer = ogg_sync_buffer(&sync, MGM_Theora_ReadBytes);
+			auto read = MG_Asset_Read(asset, (mgbyte*)buffer, MGM_Theora_ReadBytes);
+			if (read <= 0)
+				return false;
+
+			ogg_sync_wrote(&sync, read);
+		}
+
+		return true;
+	}
+
+	bool ReadPacket(ogg_packet& packet)
+	{
+		ogg_page page;
+
+		while (ogg_stream_packetout(&stream, &packet) != 1)
+		{
+			if (!ReadPage(page))
+				return false;
+
+			// Skip the pages of the other streams.
+			if (ogg_page_serialno(&page) == stream.serialno)
+				ogg_stream_pagein(&stream, &page);
+		}
+
+		return true;
+	}
+
+	void CloseStream()
+	{
+		if (decoder)
+			th_decode_free(decoder);
+		decoder = nullptr;
+
+		if (streamReady)
+			ogg_stream_clear(&stream);
+		streamReady = false;
+
+		th_comment_clear(&comment);
+		th_info_clear(&theora);
+	}
+
+	// Reads the headers from the start of the file and leaves
+	// the stream positioned at the first video packet.
+	bool OpenStream()
+	{
+		CloseStream();
+		th_info_init(&theora);
+		th_comment_init(&comment);
+
+		MG_Asset_Seek(asset, 0, SEEK_SET);
+		ogg_sync_reset(&sync);
+
+		th_setup_info* setup = nullptr;
+		ogg_page page;
+		ogg_packet packet;
+
+		// The streams all start on the first pages of the file.
+		while (ReadPage(page))
+		{
+			if (!ogg_page_bos(&page))
+			{
+				if (streamReady && ogg_page_serialno(&page) == stream.serialno)
+					ogg_stream_pagein(&stream, &page);
+				break;
+			}
+
+			ogg_stream_state test;
+			ogg_stream_init(&test, ogg_page_serialno(&page));
+			ogg_stream_pagein(&test, &page);
+
+			if (!streamReady && ogg_stream_packetout(&test, &packet) == 1 && th_decode_headerin(&theora, &comment, &setup, &packet) > 0)
+			{
+				memcpy(&stream, &test, sizeof(test));
+				streamReady = true;
+			}
+			else
+				ogg_stream_clear(&test);
+		}
+
+		// The rest of the headers follow, then the first video
+		// packet which we leave in the stream to decode later.
+		while (streamReady)
+		{
+			if (ogg_stream_packetpeek(&stream, &packet) != 1)
+			{
+				if (!ReadPage(page))
+					break;
+				if (ogg_page_serialno(&page) == stream.serialno)
+					ogg_stream_pagein(&stream, &page);
+				continue;
+			}
+
+			auto result = th_decode_headerin(&theora, &comment, &setup, &packet);
+			if (result == 0)
+			{
+				decoder = th_decode_alloc(&theora, setup);
+				break;
+			}
+			if (result < 0)
+				break;
+
+			ogg_stream_packetout(&stream, &packet);
+		}
+
+		th_setup_free(setup);
+		return decoder != nullptr;
+	}
+
+	mgulong FrameToMS(ogg_int64_t frame) const
+	{
+		return (mgulong)((frame * 1000 * theora.fps_denominator) / theora.fps_numerator);
+	}
+
+	// Finds the last granule position of our stream near the end of the file.
+	mgulong ReadDuration()
+	{
+		auto tail = std::min<mglong>(length, MGM_Theora_TailBytes);
+
+		std::vector<mgbyte> buffer((size_t)tail);
+		auto resume = MG_Asset_Seek(asset, 0, SEEK_CUR);
+		MG_Asset_Seek(asset, length - tail, SEEK_SET);
+		auto read = MG_Asset_Read(asset, buffer.data(), tail);
+		MG_Asset_Seek(asset, resume, SEEK_SET);
+
+		for (mglong i = (mglong)read - 27; i >= 0; i--)
+		{
+			auto header = buffer.data() + i;
+			if (memcmp(header, "OggS", 4) != 0)
+				continue;
+
+			ogg_int64_t granule;
+			mguint serial;
+			memcpy(&granule, header + 6, sizeof(granule));
+			memcpy(&serial, header + 14, sizeof(serial));
+
+			if ((int)serial == stream.serialno && granule != -1)
+				return FrameToMS(th_granule_frame(decoder, granule) + 1);
+		}
+
+		return 0;
+	}
+
+	// Decodes up to the next new picture, skipping duplicated frames.
+	bool DecodeFrame(MGM_VideoFrame* frame) override
+	{
+		ogg_packet packet;
+		while (ReadPacket(packet))
+		{
+			// Keeps the decoder's frame count right when
+			// the stream doesn't start at granule zero.
+			if (packet.granulepos >= 0)
+				th_decode_ctl(decoder, TH_DECCTL_SET_GRANPOS, &packet.granulepos, sizeof(packet.granulepos));
+
+			ogg_int64_t granule = -1;
+			if (th_decode_packetin(decoder, &packet, &granule) != 0)
+				continue;
+
+			th_ycbcr_buffer ycbcr;
+			th_decode_ycbcr_out(decoder, ycbcr);
+
+			// The picture is a window into the coded frame.
+			auto px = theora.pic_x;
+			auto py = theora.pic_y;
+
+			WriteFrame(frame,
+				ycbcr[0].data + (py * ycbcr[0].stride) + px, ycbcr[0].stride,
+				ycbcr[1].data + ((py >> shiftY) * ycbcr[1].stride) + (px >> shiftX), ycbcr[1].stride,
+				ycbcr[2].data + ((py >> shiftY) * ycbcr[2].stride) + (px >> shiftX), ycbcr[2].stride);
+
+			frame->positionMS = FrameToMS(th_granule_frame(decoder, granule));
+			return true;
+		}
+
+		return false;
+	}
+
+	bool Rewind() override
+	{
+		return OpenStream();
+	}
+
+	void Initialize(mgbyte* filepath, MGM_VideoDecoderInfo& info) override
+	{
+		info.width = 0;
+		info.height = 0;
+		info.fps = 0;
+		info.duration = 0;
+
+		if (!MG_Asset_Open((const char*)filepath, asset, length))
+		{
+			asset = nullptr;
+			return;
+		}
+
+		if (!OpenStream() || theora.fps_numerator == 0 || theora.fps_denominator == 0)
+			return;
+
+		width = theora.pic_width;
+		height = theora.pic_height;
+		shiftX = theora.pixel_fmt == TH_PF_444 ? 0 : 1;
+		shiftY = theora.pixel_fmt == TH_PF_420 ? 1 : 0;
+		fps = (mgfloat)theora.fps_numerator / theora.fps_denominator;
+		durationMS = ReadDuration();
+
+		StartWorker();
+
+		info.width = width;
+		info.height = height;
+		info.fps = fps;
+		info.duration = durationMS;
+	}
+
+	MGM_AudioDecoder* GetAudioDecoder(MGM_AudioDecoderInfo& info) override
+	{
+		// The Vorbis soundtrack shares the Ogg file with the
+		// video and isn't demuxed, so Theora video is silent.
+		info.samplerate = 0;
+		info.channels = 0;
+		info.duration = 0;
+		return nullptr;
+	}
+};
+
+#endif
+
+
+MGM_VideoDecoder* MGM_VideoDecoder_TryCreate_Theora(MGM_SIGNATURE)
+{
+#if defined(MG_THEORA)
+	// Ogg holds audio only files too, those fail
+	// in Initialize when no Theora stream is found.
+	if (memcmp(signature, "OggS", 4) != 0)
+		return nullptr;
+
+	return new MGM_VideoDecoder_Theora();
+#else
+	return nullptr;
+#endif
+}
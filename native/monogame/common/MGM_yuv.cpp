@@ -0,0 +1,220 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "api_MGM.h"
+
+#include "MGM_common.h"
+#include "mg_simd.h"
+#include "mg_parallel.h"
+
+#include <algorithm>
+
+
+// BT.601 video range in 6 bit fixed point which lets every
+// term fit in 16 bits, so SIMD does 8 pixels per register.
+static const int MGM_YUV_Y = 74;	// 1.164
+static const int MGM_YUV_RV = 102;	// 1.596
+static const int MGM_YUV_GU = 25;	// 0.392
+static const int MGM_YUV_GV = 52;	// 0.813
+static const int MGM_YUV_BU = 129;	// 2.017
+
+// Frames are split into bands of rows which
+// are converted on several threads at once.
+static const mgint MGM_YUV_BandRows = 64;
+
+struct MGM_YUVPlanes
+{
+	const mgbyte* y;
+	const mgbyte* u;
+	const mgbyte* v;
+	mgint yStride;
+	mgint uStride;
+	mgint vStride;
+	mgint shiftX;
+	mgint shiftY;
+	mgint width;
+	mgbyte* rgba;
+	mgint rgbaStride;
+};
+
+
+// The scalar path saturates exactly like the SIMD
+// ones, so the row tails come out the same.
+static inline int MGM_YUV_Saturate16(int x)
+{
+	return std::min(std::max(x, -32768), 32767);
+}
+
+static inline mgbyte MGM_YUV_Pack(int x)
+{
+	return (mgbyte)std::min(std::max(MGM_YUV_Saturate16(x + 32) >> 6, 0), 255);
+}
+
+static void MGM_YUV_Row_Scalar(const mgbyte* y, const mgbyte* u, const mgbyte* v, mgint shiftX, mgint start, mgint count, mgbyte* rgba)
+{
+	for (mgint x = start; x < count; x++)
+	{
+		auto Y = (y[x] - 16) * MGM_YUV_Y;
+		auto U = u[x >> shiftX] - 128;
+		auto V = v[x >> shiftX] - 128;
+
+		auto out = rgba + (x * 4);
+		out[0] = MGM_YUV_Pack(MGM_YUV_Saturate16(Y + (V * MGM_YUV_RV)));
+		out[1] = MGM_YUV_Pack(MGM_YUV_Saturate16(Y - (U * MGM_YUV_GU) - (V * MGM_YUV_GV)));
+		out[2] = MGM_YUV_Pack(MGM_YUV_Saturate16(Y + (U * MGM_YUV_BU)));
+		out[3] = 255;
+	}
+}
+
+#if defined(MG_SIMD_SSE2)
+
+static inline void MGM_YUV_Half_SSE2(__m128i y, __m128i u, __m128i v, __m128i& r, __m128i& g, __m128i& b)
+{
+	const auto y16 = _mm_set1_epi16(16);
+	const auto c128 = _mm_set1_epi16(128);
+	const auto round = _mm_set1_epi16(32);
+
+	y = _mm_mullo_epi16(_mm_sub_epi16(y, y16), _mm_set1_epi16(MGM_YUV_Y));
+	u = _mm_sub_epi16(u, c128);
+	v = _mm_sub_epi16(v, c128);
+
+	r = _mm_adds_epi16(y, _mm_mullo_epi16(v, _mm_set1_epi16(MGM_YUV_RV)));
+	g = _mm_subs_epi16(_mm_subs_epi16(y, _mm_mullo_epi16(u, _mm_set1_epi16(MGM_YUV_GU))), _mm_mullo_epi16(v, _mm_set1_epi16(MGM_YUV_GV)));
+	b = _mm_adds_epi16(y, _mm_mullo_epi16(u, _mm_set1_epi16(MGM_YUV_BU)));
+
+	r = _mm_srai_epi16(_mm_adds_epi16(r, round), 6);
+	g = _mm_srai_epi16(_mm_adds_epi16(g, round), 6);
+	b = _mm_srai_epi16(_mm_adds_epi16(b, round), 6);
+}
+
+// Converts 16 pixels at a time with the chroma shared by pairs of pixels.
+static void MGM_YUV_Row_SSE2(const mgbyte* y, const mgbyte* u, const mgbyte* v, mgint count, mgbyte* rgba)
+{
+	const auto zero = _mm_setzero_si128();
+	const auto alpha = _mm_set1_epi8((char)0xFF);
+
+	mgint x = 0;
+	for (; x + 16 <= count; x += 16)
+	{
+		auto yv = _mm_loadu_si128((const __m128i*)(y + x));
+		auto uv = _mm_loadl_epi64((const __m128i*)(u + (x >> 1)));
+		auto vv = _mm_loadl_epi64((const __m128i*)(v + (x >> 1)));
+		uv = _mm_unpacklo_epi8(uv, uv);
+		vv = _mm_unpacklo_epi8(vv, vv);
+
+		__m128i rlo, glo, blo, rhi, ghi, bhi;
+		MGM_YUV_Half_SSE2(_mm_unpacklo_epi8(yv, zero), _mm_unpacklo_epi8(uv, zero), _mm_unpacklo_epi8(vv, zero), rlo, glo, blo);
+		MGM_YUV_Half_SSE2(_mm_unpackhi_epi8(yv, zero), _mm_unpackhi_epi8(uv, zero), _mm_unpackhi_epi8(vv, zero), rhi, ghi, bhi);
+
+		auto r = _mm_packus_epi16(rlo, rhi);
+		auto g = _mm_packus_epi16(glo, ghi);
+		auto b = _mm_packus_epi16(blo, bhi);
+
+		auto rgLo = _mm_unpacklo_epi8(r, g);
+		auto rgHi = _mm_unpackhi_epi8(r, g);
+		auto baLo = _mm_unpacklo_epi8(b, alpha);
+		auto baHi = _mm_unpackhi_epi8(b, alpha);
+
+		auto out = (__m128i*)(rgba + (x * 4));
+		_mm_storeu_si128(out + 0, _mm_unpacklo_epi16(rgLo, baLo));
+		_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(rgLo, baLo));
+		_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(rgHi, baHi));
+		_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(rgHi, baHi));
+	}
+
+	MGM_YUV_Row_Scalar(y, u, v, 1, x, count, rgba);
+}
+
+#elif defined(MG_SIMD_NEON)
+
+static inline void MGM_YUV_Half_NEON(uint8x8_t y8, uint8x8_t u8, uint8x8_t v8, uint8x8_t& r, uint8x8_t& g, uint8x8_t& b)
+{
+	auto y = vmulq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(y8)), vdupq_n_s16(16)), MGM_YUV_Y);
+	auto u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u8)), vdupq_n_s16(128));
+	auto v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v8)), vdupq_n_s16(128));
+
+	// The narrowing shift rounds and clamps to 0-255.
+	r = vqrshrun_n_s16(vqaddq_s16(y, vmulq_n_s16(v, MGM_YUV_RV)), 6);
+	g = vqrshrun_n_s16(vqsubq_s16(vqsubq_s16(y, vmulq_n_s16(u, MGM_YUV_GU)), vmulq_n_s16(v, MGM_YUV_GV)), 6);
+	b = vqrshrun_n_s16(vqaddq_s16(y, vmulq_n_s16(u, MGM_YUV_BU)), 6);
+}
+
+// Converts 16 pixels at a time with the chroma shared by pairs of pixels.
+static void MGM_YUV_Row_NEON(const mgbyte* y, const mgbyte* u, const mgbyte* v, mgint count, mgbyte* rgba)
+{
+	mgint x = 0;
+	for (; x + 16 <= count; x += 16)
+	{
+		auto yv = vld1q_u8(y + x);
+		auto uz = vzip_u8(vld1_u8(u + (x >> 1)), vld1_u8(u + (x >> 1)));
+		auto vz = vzip_u8(vld1_u8(v + (x >> 1)), vld1_u8(v + (x >> 1)));
+
+		uint8x8_t rlo, glo, blo, rhi, ghi, bhi;
+		MGM_YUV_Half_NEON(vget_low_u8(yv), uz.val[0], vz.val[0], rlo, glo, blo);
+		MGM_YUV_Half_NEON(vget_high_u8(yv), uz.val[1], vz.val[1], rhi, ghi, bhi);
+
+		uint8x16x4_t out;
+		out.val[0] = vcombine_u8(rlo, rhi);
+		out.val[1] = vcombine_u8(glo, ghi);
+		out.val[2] = vcombine_u8(blo, bhi);
+		out.val[3] = vdupq_n_u8(255);
+		vst4q_u8(rgba + (x * 4), out);
+	}
+
+	MGM_YUV_Row_Scalar(y, u, v, 1, x, count, rgba);
+}
+
+#endif
+
+static void MGM_YUV_Rows(const MGM_YUVPlanes& planes, mgint first, mgint last)
+{
+	for (mgint row = first; row < last; row++)
+	{
+		auto y = planes.y + ((mglong)row * planes.yStride);
+		auto u = planes.u + ((mglong)(row >> planes.shiftY) * planes.uStride);
+		auto v = planes.v + ((mglong)(row >> planes.shiftY) * planes.vStride);
+		auto rgba = planes.rgba + ((mglong)row * planes.rgbaStride);
+
+		// Only horizontally subsampled chroma has a SIMD path.
+		if (planes.shiftX != 1)
+		{
+			MGM_YUV_Row_Scalar(y, u, v, planes.shiftX, 0, planes.width, rgba);
+			continue;
+		}
+
+#if defined(MG_SIMD_SSE2)
+		MGM_YUV_Row_SSE2(y, u, v, planes.width, rgba);
+#elif defined(MG_SIMD_NEON)
+		MGM_YUV_Row_NEON(y, u, v, planes.width, rgba);
+#else
+		MGM_YUV_Row_Scalar(y, u, v, 1, 0, planes.width, rgba);
+#endif
+	}
+}
+
+void MGM_YUV_ToRGBA(
+	const mgbyte* y, mgint yStride,
+	const mgbyte* u, mgint uStride,
+	const mgbyte* v, mgint vStride,
+	mgint shiftX, mgint shiftY,
+	mgint width, mgint height,
+	mgbyte* rgba)
+{
+	assert(y != nullptr);
+	assert(u != nullptr);
+	assert(v != nullptr);
+	assert(rgba != nullptr);
+
+	MGM_YUVPlanes planes = { y, u, v, yStride, uStride, vStride, shiftX, shiftY, width, rgba, width * 4 };
+
+	auto bands = (height + MGM_YUV_BandRows - 1) / MGM_YUV_BandRows;
+
+	// The shared pool leaves a core for the game
+	// thread and the calling thread also converts.
+	MG_ParallelFor(bands, [&](mgint band)
+	{
+		auto first = band * MGM_YUV_BandRows;
+		MGM_YUV_Rows(planes, first, std::min(first + MGM_YUV_BandRows, height));
+	});
+}
@@ -4,15 +4,424 @@
 
 #include "mg_common.h"
 #include "api_MG_Asset.h"
+#include "MG_Asset_common.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <algorithm>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// The plain ftell/fseek use a long which is only
+// 32bits on Windows and some 32bit platforms.
+#if defined(_WIN32)
+#define MG_FSEEK _fseeki64
+#define MG_FTELL _ftelli64
+#else
+#define MG_FSEEK fseeko
+#define MG_FTELL ftello
+#endif
+
+// A pack holds many assets in a single file with a sorted
+// directory so opening an asset is just a lookup.
+//
+//   header    "MGPK", version, entry count, name bytes
+//   entries   sorted by hash then name
+//   names     UTF8 paths relative to the mount point using '/'
+//   data      each asset 16 byte aligned
+//
+struct MG_PackEntry
+{
+    mguint hash;
+    mguint nameOffset;
+    mguint nameLength;
+    mguint reserved;
+    mgulong offset;
+    mgulong length;
+};
+
+static const mguint MG_PACK_MAGIC = 0x4B50474D; // MGPK
+static const mguint MG_PACK_VERSION = 1;
+static const mguint MG_PACK_HEADER_SIZE = 16;
+
+struct MG_Pack
+{
+    std::string mountPoint;
+
+    FILE* file;
+    mglong length;
+
+    // The whole pack when it can be mapped, else we share
+    // the file handle between all the open assets.
+    mgbyte* data;
+    void* mapping;
+    std::mutex mutex;
+
+    std::vector<MG_PackEntry> entries;
+    std::vector<char> names;
+};
+
+static std::mutex s_packsMutex;
+static std::vector<MG_Pack*> s_packs;
+
+// Optional counters for tuning pack layouts and prefetching,
+// kept per path and in total.  Entries are never freed so
+// open assets can keep pointing at theirs across a reset.
+static const int MG_ASSET_STATS_BUCKETS = sizeof(MG_AssetStats::ReadHistogram) / sizeof(mglong);
+
+struct MG_AssetStatsEntry
+{
+    std::string path;
+
+    std::atomic<mglong> opens;
+    std::atomic<mglong> failedOpens;
+    std::atomic<mglong> reads;
+    std::atomic<mglong> bytesRead;
+    std::atomic<mglong> seeks;
+    std::atomic<mglong> maps;
+    std::atomic<mglong> openTimeNS;
+    std::atomic<mglong> readTimeNS;
+
+    // Read latency where bucket N counts reads taking
+    // under 2^N microseconds and the last one the rest.
+    std::atomic<mglong> readHistogram[MG_ASSET_STATS_BUCKETS];
+};
+
+static std::atomic<bool> s_statsEnabled;
+static std::mutex s_statsMutex;
+static std::unordered_map<std::string, MG_AssetStatsEntry*> s_statsPaths;
+static MG_AssetStatsEntry s_statsTotal;
+static std::string s_statsDumpPath;
+static bool s_statsDumpRegistered;
+
+typedef std::chrono::steady_clock MG_AssetStatsClock;
 
 struct MG_Asset
 {
     FILE* file;
+    mglong length;
+
+    // The whole file when mapped.
+    mgbyte* data;
+    bool mapped;
+    void* mapping;
+
+    // Set when this is a view into a pack.
+    MG_Pack* pack;
+    mglong offset;
+    mglong position;
+
+    // Set when the stored data is chunk compressed, in
+    // which case length is still the stored length.
+    MG_AssetChunks* chunks;
+
+    // Set when stats were enabled as it was opened.
+    MG_AssetStatsEntry* stats;
+
+    // Guards the file position as MG_Asset_ReadAt has
+    // to move it where we don't have a positional read.
+    std::mutex mutex;
 };
 
-mgbool MG_Asset_Open(const char* path, MG_Asset*& handle, mglong& length)
+static mglong MG_Asset_GetLength(MG_Asset* handle)
+{
+    return handle->chunks ? MG_AssetChunks_GetLength(handle->chunks) : handle->length;
+}
+
+static bool MG_MapFile(FILE* file, mglong length, mgbyte*& data, void*& mapping)
+{
+    data = nullptr;
+    mapping = nullptr;
+
+    if (length <= 0 || (mglong)(size_t)length != length)
+        return false;
+
+#if defined(_WIN32)
+    auto handle = (HANDLE)_get_osfhandle(_fileno(file));
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+        return false;
+
+    data = (mgbyte*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr)
+    {
+        CloseHandle(mapping);
+        mapping = nullptr;
+        return false;
+    }
+
+    return true;
+#else
+    auto view = mmap(nullptr, (size_t)length, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+    if (view == MAP_FAILED)
+        return false;
+
+    data = (mgbyte*)view;
+    return true;
+#endif
+}
+
+static void MG_UnmapFile(mgbyte* data, mglong length, void* mapping)
+{
+#if defined(_WIN32)
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+#else
+    munmap(data, (size_t)length);
+#endif
+}
+
+static char MG_PackLower(char c)
+{
+    return c >= 'A' && c <= 'Z' ? (char)(c + ('a' - 'A')) : c;
+}
+
+// Pack lookups ignore case and accept either
+// path separator so they behave like the filesystem
+// on every platform.
+static mguint MG_PackHash(const char* name, size_t length)
+{
+    // Same FNV-1a as MG_ComputeHash, one character at a time.
+    mguint hash = 0x811c9dc5;
+    for (size_t i = 0; i < length; i++)
+    {
+        auto c = MG_PackLower(name[i] == '\\' ? '/' : name[i]);
+        hash = MG_ComputeHash((mguint)(mgbyte)c, hash);
+    }
+
+    return hash;
+}
+
+static int MG_PackCompare(const char* a, size_t aLength, const char* b, size_t bLength)
+{
+    auto length = aLength < bLength ? aLength : bLength;
+    for (size_t i = 0; i < length; i++)
+    {
+        auto ca = MG_PackLower(a[i] == '\\' ? '/' : a[i]);
+        auto cb = MG_PackLower(b[i] == '\\' ? '/' : b[i]);
+        if (ca != cb)
+            return (mgbyte)ca < (mgbyte)cb ? -1 : 1;
+    }
+
+    return aLength == bLength ? 0 : (aLength < bLength ? -1 : 1);
+}
+
+static const MG_PackEntry* MG_Pack_Find(MG_Pack* pack, const char* name, size_t length)
+{
+    auto hash = MG_PackHash(name, length);
+
+    // Binary search for the first entry with this hash
+    // then walk forward in the rare case of collisions.
+    size_t lo = 0;
+    size_t hi = pack->entries.size();
+    while (lo < hi)
+    {
+        auto mid = lo + (hi - lo) / 2;
+        if (pack->entries[mid].hash < hash)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    for (; lo < pack->entries.size() && pack->entries[lo].hash == hash; lo++)
+    {
+        auto& entry = pack->entries[lo];
+        if (MG_PackCompare(name, length, pack->names.data() + entry.nameOffset, entry.nameLength) == 0)
+            return &entry;
+    }
+
+    return nullptr;
+}
+
+static const MG_PackEntry* MG_Packs_Find(const char* path, MG_Pack*& pack)
+{
+    // Skip over any leading "./".
+    while (path[0] == '.' && (path[1] == '/' || path[1] == '\\'))
+        path += 2;
+
+    std::lock_guard<std::mutex> lock(s_packsMutex);
+
+    for (auto p : s_packs)
+    {
+        auto& mount = p->mountPoint;
+
+        auto name = path;
+        if (!mount.empty())
+        {
+            if (MG_PackCompare(path, std::min(strlen(path), mount.size()), mount.c_str(), mount.size()) != 0)
+                continue;
+
+            name = path + mount.size();
+            if (name[0] != '/' && name[0] != '\\')
+                continue;
+            name++;
+        }
+
+        auto entry = MG_Pack_Find(p, name, strlen(name));
+        if (entry)
+        {
+            pack = p;
+            return entry;
+        }
+    }
+
+    return nullptr;
+}
+
+static bool MG_Pack_ReadAt(MG_Pack* pack, mglong offset, void* buffer, size_t count)
+{
+    if (pack->data)
+    {
+        memcpy(buffer, pack->data + offset, count);
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(pack->mutex);
+    if (MG_FSEEK(pack->file, offset, SEEK_SET) != 0)
+        return false;
+    return fread(buffer, 1, count, pack->file) == count;
+}
+
+mgbool MG_Asset_Mount(const char* packPath, const char* mountPoint)
 {
+    assert(packPath != nullptr);
+
+    auto file = fopen(packPath, "rb");
+    if (file == nullptr)
+        return false;
+
+    auto pack = new MG_Pack();
+    pack->file = file;
+    pack->data = nullptr;
+    pack->mapping = nullptr;
+    pack->mountPoint = mountPoint ? mountPoint : "";
+
+    // Mount points are matched without a trailing separator.
+    while (!pack->mountPoint.empty() && (pack->mountPoint.back() == '/' || pack->mountPoint.back() == '\\'))
+        pack->mountPoint.pop_back();
+
+    bool valid = false;
+
+    mguint header[4];
+    if (MG_FSEEK(file, 0, SEEK_END) == 0)
+    {
+        pack->length = MG_FTELL(file);
+        MG_FSEEK(file, 0, SEEK_SET);
+        valid = fread(header, 1, sizeof(header), file) == sizeof(header) &&
+                header[0] == MG_PACK_MAGIC &&
+                header[1] == MG_PACK_VERSION;
+    }
+
+    // The counts come from the file, so check the tables
+    // fit in it before allocating anything for them.
+    mgulong entryBytes = 0;
+    if (valid)
+    {
+        entryBytes = (mgulong)sizeof(MG_PackEntry) * header[2];
+        valid = pack->length >= 0 && (mgulong)pack->length >= MG_PACK_HEADER_SIZE + entryBytes + header[3];
+    }
+
+    if (valid)
+    {
+        pack->entries.resize(header[2]);
+        pack->names.resize(header[3]);
+
+        valid = fread(pack->entries.data(), 1, entryBytes, file) == entryBytes &&
+                fread(pack->names.data(), 1, pack->names.size(), file) == pack->names.size();
+    }
+
+    for (size_t i = 0; valid && i < pack->entries.size(); i++)
+    {
+        auto& entry = pack->entries[i];
+        valid = (mgulong)entry.nameOffset + entry.nameLength <= pack->names.size() &&
+                entry.offset <= (mgulong)pack->length &&
+                entry.length <= (mgulong)pack->length - entry.offset &&
+                (i == 0 || pack->entries[i - 1].hash <= entry.hash);
+    }
+
+    if (!valid)
+    {
+        fclose(file);
+        delete pack;
+        return false;
+    }
+
+    // If we can't map it we'll read through the shared file.
+    MG_MapFile(file, pack->length, pack->data, pack->mapping);
+
+    std::lock_guard<std::mutex> lock(s_packsMutex);
+    s_packs.push_back(pack);
+    return true;
+}
+
+static mglong MG_AssetStats_Elapsed(MG_AssetStatsClock::time_point start)
+{
+    return (mglong)std::chrono::duration_cast<std::chrono::nanoseconds>(MG_AssetStatsClock::now() - start).count();
+}
+
+static MG_AssetStatsEntry* MG_AssetStats_Find(const char* path)
+{
+    std::lock_guard<std::mutex> lock(s_statsMutex);
+
+    auto& entry = s_statsPaths[path];
+    if (entry == nullptr)
+    {
+        entry = new MG_AssetStatsEntry();
+        entry->path = path;
+    }
+
+    return entry;
+}
+
+static void MG_AssetStats_Add(MG_AssetStatsEntry* entry, std::atomic<mglong> MG_AssetStatsEntry::* counter, mglong value)
+{
+    (entry->*counter).fetch_add(value, std::memory_order_relaxed);
+    (s_statsTotal.*counter).fetch_add(value, std::memory_order_relaxed);
+}
+
+static void MG_AssetStats_AddRead(MG_AssetStatsEntry* entry, mglong elapsedNS, mglong read)
+{
+    MG_AssetStats_Add(entry, &MG_AssetStatsEntry::reads, 1);
+    MG_AssetStats_Add(entry, &MG_AssetStatsEntry::bytesRead, std::max<mglong>(read, 0));
+    MG_AssetStats_Add(entry, &MG_AssetStatsEntry::readTimeNS, elapsedNS);
+
+    int bucket = 0;
+    for (auto us = elapsedNS / 1000; us > 0 && bucket < MG_ASSET_STATS_BUCKETS - 1; us >>= 1)
+        bucket++;
+
+    entry->readHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    s_statsTotal.readHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+static mgbool MG_Asset_OpenInternal(const char* path, MG_Asset*& handle, mglong& length)
+{
+    MG_Pack* pack;
+    auto entry = MG_Packs_Find(path, pack);
+    if (entry)
+    {
+        handle = new MG_Asset();
+        handle->pack = pack;
+        handle->offset = entry->offset;
+        handle->length = entry->length;
+        handle->chunks = MG_AssetChunks_Open(handle, handle->length);
+        length = MG_Asset_GetLength(handle);
+        return true;
+    }
+
     handle = new MG_Asset();
     handle->file = fopen(path, "rb");
     if (handle->file == nullptr)
@@ -21,37 +430,507 @@ mgbool MG_Asset_Open(const char* path, MG_Asset*& handle, mglong& length)
         return false;
     }
 
-    if (fseek(handle->file, 0, SEEK_END) != 0)
+    if (MG_FSEEK(handle->file, 0, SEEK_END) != 0)
     {
         //unable to seek file for some reason
+        fclose(handle->file);
         delete handle;
         return false;
     }
 
-    length = ftell(handle->file);
+    length = MG_FTELL(handle->file);
+    handle->length = length;
 
-    if (fseek(handle->file, 0, SEEK_SET) != 0)
+    if (length < 0 || MG_FSEEK(handle->file, 0, SEEK_SET) != 0)
     {
         //unable to seek back to file start for some reason
+        fclose(handle->file);
         delete handle;
         return false;
     }
 
+    handle->chunks = MG_AssetChunks_Open(handle, handle->length);
+    length = MG_Asset_GetLength(handle);
+
     return true;
 }
 
+mgbool MG_Asset_Open(const char* path, MG_Asset*& handle, mglong& length)
+{
+    if (!s_statsEnabled.load(std::memory_order_relaxed))
+        return MG_Asset_OpenInternal(path, handle, length);
+
+    auto entry = MG_AssetStats_Find(path);
+    auto start = MG_AssetStatsClock::now();
+
+    auto opened = MG_Asset_OpenInternal(path, handle, length);
+
+    MG_AssetStats_Add(entry, &MG_AssetStatsEntry::openTimeNS, MG_AssetStats_Elapsed(start));
+    if (opened)
+    {
+        MG_AssetStats_Add(entry, &MG_AssetStatsEntry::opens, 1);
+        handle->stats = entry;
+    }
+    else
+        MG_AssetStats_Add(entry, &MG_AssetStatsEntry::failedOpens, 1);
+
+    return opened;
+}
+
+static mglong MG_Asset_ReadAtInternal(MG_Asset* handle, mglong offset, mgbyte* buffer, mglong count)
+{
+    if (handle->chunks)
+        return MG_AssetChunks_ReadAt(handle->chunks, handle, offset, buffer, count);
+
+    return MG_Asset_ReadRaw(handle, offset, buffer, count);
+}
+
+static mgint MG_Asset_ReadInternal(MG_Asset* handle,  mgbyte* buffer, mglong count)
+{
+    if (handle->pack == nullptr && handle->chunks == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(handle->mutex);
+        return fread(buffer, 1, count, handle->file);
+    }
+
+    auto read = MG_Asset_ReadAtInternal(handle, handle->position, buffer, count);
+    if (read <= 0)
+        return 0;
+
+    handle->position += read;
+    return (mgint)read;
+}
+
 mgint MG_Asset_Read(MG_Asset* handle,  mgbyte* buffer, mglong count)
 {
-    return fread(buffer, 1, count, handle->file);
+    if (handle->stats == nullptr)
+        return MG_Asset_ReadInternal(handle, buffer, count);
+
+    auto start = MG_AssetStatsClock::now();
+    auto read = MG_Asset_ReadInternal(handle, buffer, count);
+    MG_AssetStats_AddRead(handle->stats, MG_AssetStats_Elapsed(start), read);
+
+    return read;
 }
 
 mglong MG_Asset_Seek(MG_Asset* handle, mglong offset, mgint whence)
 {
-    return fseek(handle->file, offset, whence);
+    if (handle->stats)
+        MG_AssetStats_Add(handle->stats, &MG_AssetStatsEntry::seeks, 1);
+
+    if (handle->pack == nullptr && handle->chunks == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(handle->mutex);
+        if (MG_FSEEK(handle->file, offset, whence) != 0)
+            return -1;
+
+        return MG_FTELL(handle->file);
+    }
+
+    auto length = MG_Asset_GetLength(handle);
+
+    mglong position;
+    switch (whence)
+    {
+    case SEEK_SET:
+        position = offset;
+        break;
+    case SEEK_CUR:
+        position = handle->position + offset;
+        break;
+    case SEEK_END:
+        position = length + offset;
+        break;
+    default:
+        return -1;
+    }
+
+    if (position < 0 || position > length)
+        return -1;
+
+    handle->position = position;
+    return position;
+}
+
+mgbool MG_Asset_Map(MG_Asset* handle, mgbyte*& data)
+{
+    assert(handle != nullptr);
+
+    // Mapping would decompress the whole asset, so compressed
+    // assets are only read a chunk at a time as needed.
+    if (handle->chunks)
+    {
+        data = nullptr;
+        return false;
+    }
+
+    return MG_Asset_Load(handle, data);
+}
+
+mgbool MG_Asset_Load(MG_Asset* handle, mgbyte*& data)
+{
+    assert(handle != nullptr);
+
+    data = nullptr;
+
+    if (handle->data != nullptr)
+    {
+        data = handle->data;
+        return true;
+    }
+
+    if (handle->stats)
+        MG_AssetStats_Add(handle->stats, &MG_AssetStatsEntry::maps, 1);
+
+    auto length = MG_Asset_GetLength(handle);
+
+    // There is nothing to map in an empty file.
+    if (length == 0)
+        return true;
+
+    if ((mglong)(size_t)length != length)
+        return false;
+
+    if (handle->chunks)
+    {
+        // Compressed assets are decompressed whole.
+        auto buffer = (mgbyte*)malloc((size_t)length);
+        if (buffer == nullptr)
+            return false;
+
+        if (MG_AssetChunks_ReadAt(handle->chunks, handle, 0, buffer, length) != length)
+        {
+            free(buffer);
+            return false;
+        }
+
+        handle->data = buffer;
+    }
+    else if (handle->pack && handle->pack->data)
+    {
+        // Views into a mapped pack are free.
+        handle->data = handle->pack->data + handle->offset;
+    }
+    else if (handle->pack)
+    {
+        auto buffer = (mgbyte*)malloc((size_t)handle->length);
+        if (buffer == nullptr)
+            return false;
+
+        if (!MG_Pack_ReadAt(handle->pack, handle->offset, buffer, (size_t)handle->length))
+        {
+            free(buffer);
+            return false;
+        }
+
+        handle->data = buffer;
+    }
+    else if (MG_MapFile(handle->file, handle->length, handle->data, handle->mapping))
+    {
+        // Content is almost always parsed front to back.
+#if !defined(_WIN32)
+        madvise(handle->data, (size_t)handle->length, MADV_SEQUENTIAL);
+#endif
+        handle->mapped = true;
+    }
+    else
+    {
+        // Some filesystems and platforms can't map files,
+        // so fall back to reading it all into memory.
+        auto buffer = (mgbyte*)malloc((size_t)handle->length);
+        if (buffer == nullptr)
+            return false;
+
+        auto position = MG_FTELL(handle->file);
+        MG_FSEEK(handle->file, 0, SEEK_SET);
+        auto read = fread(buffer, 1, (size_t)handle->length, handle->file);
+        MG_FSEEK(handle->file, position, SEEK_SET);
+
+        if (read != (size_t)handle->length)
+        {
+            free(buffer);
+            return false;
+        }
+
+        handle->data = buffer;
+    }
+
+    data = handle->data;
+    return true;
+}
+
+void MG_Asset_Unmap(MG_Asset* handle)
+{
+    assert(handle != nullptr);
+
+    if (handle->data == nullptr)
+        return;
+
+    if (handle->mapped)
+        MG_UnmapFile(handle->data, handle->length, handle->mapping);
+    else if (handle->chunks || !(handle->pack && handle->pack->data))
+        free(handle->data);
+
+    handle->data = nullptr;
+    handle->mapping = nullptr;
+    handle->mapped = false;
+}
+
+FILE* MG_Asset_GetFile(MG_Asset* handle, mglong& base, mglong& length)
+{
+    assert(handle != nullptr);
+
+    length = MG_Asset_GetLength(handle);
+
+    if (handle->chunks)
+    {
+        base = 0;
+        return nullptr;
+    }
+
+    if (handle->pack)
+    {
+        base = handle->offset;
+        return handle->pack->file;
+    }
+
+    base = 0;
+    return handle->file;
+}
+
+mglong MG_Asset_ReadAt(MG_Asset* handle, mglong offset, mgbyte* buffer, mglong count)
+{
+    assert(handle != nullptr);
+
+    if (handle->stats == nullptr)
+        return MG_Asset_ReadAtInternal(handle, offset, buffer, count);
+
+    auto start = MG_AssetStatsClock::now();
+    auto read = MG_Asset_ReadAtInternal(handle, offset, buffer, count);
+    MG_AssetStats_AddRead(handle->stats, MG_AssetStats_Elapsed(start), read);
+
+    return read;
+}
+
+mglong MG_Asset_ReadRaw(MG_Asset* handle, mglong offset, mgbyte* buffer, mglong count)
+{
+    assert(handle != nullptr);
+
+    if (offset < 0 || offset >= handle->length)
+        return 0;
+    if (count > handle->length - offset)
+        count = handle->length - offset;
+
+    if (handle->pack)
+        return MG_Pack_ReadAt(handle->pack, handle->offset + offset, buffer, (size_t)count) ? count : -1;
+
+    // A mapped compressed asset holds the decompressed data.
+    if (handle->data && handle->chunks == nullptr)
+    {
+        memcpy(buffer, handle->data + offset, (size_t)count);
+        return count;
+    }
+
+#if defined(_WIN32)
+    std::lock_guard<std::mutex> lock(handle->mutex);
+
+    auto position = MG_FTELL(handle->file);
+    if (MG_FSEEK(handle->file, offset, SEEK_SET) != 0)
+        return -1;
+    auto read = fread(buffer, 1, (size_t)count, handle->file);
+    MG_FSEEK(handle->file, position, SEEK_SET);
+    return (mglong)read;
+#else
+    mglong total = 0;
+    while (total < count)
+    {
+        auto read = pread(fileno(handle->file), buffer + total, (size_t)(count - total), offset + total);
+        if (read < 0)
+            return -1;
+        if (read == 0)
+            break;
+        total += read;
+    }
+    return total;
+#endif
 }
 
 void MG_Asset_Close(MG_Asset* handle)
 {
-    fclose(handle->file);
+    MG_Asset_Unmap(handle);
+    if (handle->chunks)
+        MG_AssetChunks_Destroy(handle->chunks);
+    if (handle->file)
+        fclose(handle->file);
     delete handle;
 }
+
+static void MG_AssetStats_Copy(MG_AssetStatsEntry* entry, MG_AssetStats& stats)
+{
+    stats.Opens = entry->opens.load(std::memory_order_relaxed);
+    stats.FailedOpens = entry->failedOpens.load(std::memory_order_relaxed);
+    stats.Reads = entry->reads.load(std::memory_order_relaxed);
+    stats.BytesRead = entry->bytesRead.load(std::memory_order_relaxed);
+    stats.Seeks = entry->seeks.load(std::memory_order_relaxed);
+    stats.Maps = entry->maps.load(std::memory_order_relaxed);
+    stats.OpenTimeNS = entry->openTimeNS.load(std::memory_order_relaxed);
+    stats.ReadTimeNS = entry->readTimeNS.load(std::memory_order_relaxed);
+
+    for (int i = 0; i < MG_ASSET_STATS_BUCKETS; i++)
+        stats.ReadHistogram[i] = entry->readHistogram[i].load(std::memory_order_relaxed);
+}
+
+static void MG_AssetStats_Clear(MG_AssetStatsEntry* entry)
+{
+    entry->opens = 0;
+    entry->failedOpens = 0;
+    entry->reads = 0;
+    entry->bytesRead = 0;
+    entry->seeks = 0;
+    entry->maps = 0;
+    entry->openTimeNS = 0;
+    entry->readTimeNS = 0;
+
+    for (int i = 0; i < MG_ASSET_STATS_BUCKETS; i++)
+        entry->readHistogram[i] = 0;
+}
+
+static void MG_AssetStats_WriteString(FILE* file, const char* value)
+{
+    fputc('"', file);
+
+    for (; *value; value++)
+    {
+        auto c = (unsigned char)*value;
+        if (c == '"' || c == '\\')
+            fprintf(file, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(file, "\\u%04x", c);
+        else
+            fputc(c, file);
+    }
+
+    fputc('"', file);
+}
+
+static void MG_AssetStats_WriteJson(FILE* file, const MG_AssetStats& stats)
+{
+    fprintf(file, "\"opens\": %lld, \"failedOpens\": %lld, \"reads\": %lld, \"bytesRead\": %lld, \"seeks\": %lld, \"maps\": %lld, \"openTimeNS\": %lld, \"readTimeNS\": %lld, \"readHistogram\": [",
+        (long long)stats.Opens,
+        (long long)stats.FailedOpens,
+        (long long)stats.Reads,
+        (long long)stats.BytesRead,
+        (long long)stats.Seeks,
+        (long long)stats.Maps,
+        (long long)stats.OpenTimeNS,
+        (long long)stats.ReadTimeNS);
+
+    for (int i = 0; i < MG_ASSET_STATS_BUCKETS; i++)
+        fprintf(file, i == 0 ? "%lld" : ", %lld", (long long)stats.ReadHistogram[i]);
+
+    fputc(']', file);
+}
+
+static void MG_AssetStats_DumpAtExit()
+{
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(s_statsMutex);
+        path = s_statsDumpPath;
+    }
+
+    if (!path.empty())
+        MG_Asset_WriteStats(path.c_str());
+}
+
+void MG_Asset_SetStatsEnabled(mgbool enabled, const char* dumpPath)
+{
+    {
+        std::lock_guard<std::mutex> lock(s_statsMutex);
+
+        s_statsDumpPath = dumpPath ? dumpPath : "";
+        if (!s_statsDumpPath.empty() && !s_statsDumpRegistered)
+        {
+            atexit(MG_AssetStats_DumpAtExit);
+            s_statsDumpRegistered = true;
+        }
+    }
+
+    // Only assets opened from now on are counted.
+    s_statsEnabled = enabled;
+}
+
+void MG_Asset_GetStats(MG_AssetStats& stats)
+{
+    MG_AssetStats_Copy(&s_statsTotal, stats);
+}
+
+mgint MG_Asset_GetPathStats(MG_AssetPathStats* stats, mgint maxStats)
+{
+    assert(stats != nullptr || maxStats == 0);
+
+    std::lock_guard<std::mutex> lock(s_statsMutex);
+
+    mgint count = 0;
+    for (auto& pair : s_statsPaths)
+    {
+        if (count < maxStats)
+        {
+            stats[count].Path = pair.second->path.c_str();
+            MG_AssetStats_Copy(pair.second, stats[count].Stats);
+        }
+        count++;
+    }
+
+    return count;
+}
+
+void MG_Asset_ResetStats()
+{
+    std::lock_guard<std::mutex> lock(s_statsMutex);
+
+    MG_AssetStats_Clear(&s_statsTotal);
+    for (auto& pair : s_statsPaths)
+        MG_AssetStats_Clear(pair.second);
+}
+
+mgbool MG_Asset_WriteStats(const char* path)
+{
+    assert(path != nullptr);
+
+    // Paths opened between the two calls are counted but not
+    // filled in, so only keep the entries we actually got.
+    std::vector<MG_AssetPathStats> paths(MG_Asset_GetPathStats(nullptr, 0));
+    auto count = MG_Asset_GetPathStats(paths.data(), (mgint)paths.size());
+    paths.resize(std::min((size_t)count, paths.size()));
+
+    // The biggest readers first as those matter most for layout.
+    std::sort(paths.begin(), paths.end(), [](const MG_AssetPathStats& a, const MG_AssetPathStats& b)
+    {
+        return a.Stats.BytesRead > b.Stats.BytesRead;
+    });
+
+    auto file = fopen(path, "w");
+    if (file == nullptr)
+        return false;
+
+    MG_AssetStats total;
+    MG_Asset_GetStats(total);
+
+    fprintf(file, "{\n  \"total\": { ");
+    MG_AssetStats_WriteJson(file, total);
+    fprintf(file, " },\n  \"assets\": [");
+
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        fprintf(file, i == 0 ? "\n    { \"path\": " : ",\n    { \"path\": ");
+        MG_AssetStats_WriteString(file, paths[i].Path);
+        fprintf(file, ", ");
+        MG_AssetStats_WriteJson(file, paths[i].Stats);
+        fprintf(file, " }");
+    }
+
+    fprintf(file, "\n  ]\n}\n");
+
+    return fclose(file) == 0;
+}
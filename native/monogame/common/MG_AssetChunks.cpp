@@ -0,0 +1,323 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "mg_common.h"
+#include "MG_Asset_common.h"
+#include "mg_parallel.h"
+
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <string.h>
+
+
+// A chunked asset is compressed in fixed size chunks which
+// are each independent, so any range can be read by only
+// decompressing the chunks which overlap it.
+//
+//   header    "MGCZ", version, codec, chunk size, length, chunk count
+//   offsets   chunk count + 1 offsets to the compressed chunks
+//   chunks    LZ4 blocks or stored as is when they didn't shrink
+//
+static const mguint MG_CHUNKS_MAGIC = 0x5A43474D; // MGCZ
+static const mguint MG_CHUNKS_VERSION = 1;
+static const mguint MG_CHUNKS_CODEC_LZ4 = 1;
+static const mguint MG_CHUNKS_HEADER_SIZE = 32;
+static const mguint MG_CHUNKS_MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+
+// Reads covering at least this many whole chunks
+// are decompressed across the worker threads.
+static const mglong MG_CHUNKS_PARALLEL_MIN = 4;
+
+struct MG_AssetChunks
+{
+	mglong length;
+	mguint chunkSize;
+	std::vector<mgulong> offsets;
+
+	// The last chunk decompressed for a partial read, which
+	// makes small sequential reads cost one decode per chunk.
+	std::mutex mutex;
+	mglong cached;
+	std::vector<mgbyte> cache;
+	std::vector<mgbyte> compressed;
+};
+
+
+// Decodes a raw LZ4 block which must exactly fill the output.
+static bool MG_LZ4_Decode(const mgbyte* src, size_t srcBytes, mgbyte* dst, size_t dstBytes)
+{
+	auto ip = src;
+	auto iend = src + srcBytes;
+	auto op = dst;
+	auto oend = dst + dstBytes;
+
+	while (ip < iend)
+	{
+		auto token = *ip++;
+
+		size_t literals = token >> 4;
+		if (literals == 15)
+		{
+			mgbyte b;
+			do
+			{
+				if (ip >= iend)
+					return false;
+				b = *ip++;
+				literals += b;
+			} while (b == 255);
+		}
+
+		if (literals > (size_t)(iend - ip) || literals > (size_t)(oend - op))
+			return false;
+
+		memcpy(op, ip, literals);
+		op += literals;
+		ip += literals;
+
+		// The last sequence is only literals.
+		if (ip == iend)
+			break;
+
+		if (iend - ip < 2)
+			return false;
+
+		size_t distance = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (distance == 0 || distance > (size_t)(op - dst))
+			return false;
+
+		size_t length = token & 15;
+		if (length == 15)
+		{
+			mgbyte b;
+			do
+			{
+				if (ip >= iend)
+					return false;
+				b = *ip++;
+				length += b;
+			} while (b == 255);
+		}
+		length += 4;
+
+		if (length > (size_t)(oend - op))
+			return false;
+
+		auto match = op - distance;
+		auto end = op + length;
+
+		if (distance >= 8 && (size_t)(oend - op) >= length + 8)
+		{
+			// The source is far enough back that 8 byte copies
+			// never overlap, and we have room to overshoot.
+			do
+			{
+				memcpy(op, match, 8);
+				op += 8;
+				match += 8;
+			} while (op < end);
+		}
+		else
+		{
+			// Overlapping matches repeat the recent output.
+			while (op < end)
+				*op++ = *match++;
+		}
+
+		op = end;
+	}
+
+	return op == oend;
+}
+
+static mglong MG_AssetChunks_ChunkBytes(MG_AssetChunks* chunks, mglong index)
+{
+	return std::min<mglong>(chunks->chunkSize, chunks->length - (index * chunks->chunkSize));
+}
+
+static bool MG_AssetChunks_Decode(MG_AssetChunks* chunks, mglong index, const mgbyte* src, mgbyte* dst)
+{
+	auto srcBytes = (size_t)(chunks->offsets[index + 1] - chunks->offsets[index]);
+	auto dstBytes = (size_t)MG_AssetChunks_ChunkBytes(chunks, index);
+
+	// Chunks which didn't compress are stored.
+	if (srcBytes == dstBytes)
+	{
+		memcpy(dst, src, dstBytes);
+		return true;
+	}
+
+	return MG_LZ4_Decode(src, srcBytes, dst, dstBytes);
+}
+
+MG_AssetChunks* MG_AssetChunks_Open(MG_Asset* handle, mglong rawLength)
+{
+	assert(handle != nullptr);
+
+	if (rawLength < MG_CHUNKS_HEADER_SIZE)
+		return nullptr;
+
+	mguint header[8];
+	if (MG_Asset_ReadRaw(handle, 0, (mgbyte*)header, sizeof(header)) != sizeof(header))
+		return nullptr;
+
+	if (header[0] != MG_CHUNKS_MAGIC || header[1] != MG_CHUNKS_VERSION || header[2] != MG_CHUNKS_CODEC_LZ4)
+		return nullptr;
+
+	auto chunkSize = header[3];
+	mglong length;
+	memcpy(&length, header + 4, sizeof(length));
+	auto count = header[6];
+
+	if (chunkSize == 0 || chunkSize > MG_CHUNKS_MAX_CHUNK_SIZE || length < 0)
+		return nullptr;
+	if ((mgulong)count != ((mgulong)length + chunkSize - 1) / chunkSize)
+		return nullptr;
+
+	auto tableBytes = ((mglong)count + 1) * (mglong)sizeof(mgulong);
+	if (tableBytes > rawLength - MG_CHUNKS_HEADER_SIZE)
+		return nullptr;
+
+	auto chunks = new MG_AssetChunks();
+	chunks->length = length;
+	chunks->chunkSize = chunkSize;
+	chunks->cached = -1;
+	chunks->offsets.resize(count + 1);
+
+	bool valid = MG_Asset_ReadRaw(handle, MG_CHUNKS_HEADER_SIZE, (mgbyte*)chunks->offsets.data(), tableBytes) == tableBytes;
+	valid = valid && chunks->offsets[0] >= (mgulong)(MG_CHUNKS_HEADER_SIZE + tableBytes) && chunks->offsets[count] <= (mgulong)rawLength;
+
+	// A chunk is never stored bigger than it is.
+	for (mguint i = 0; valid && i < count; i++)
+	{
+		valid = chunks->offsets[i] <= chunks->offsets[i + 1] &&
+				chunks->offsets[i + 1] - chunks->offsets[i] <= (mgulong)MG_AssetChunks_ChunkBytes(chunks, i);
+	}
+
+	if (!valid)
+	{
+		delete chunks;
+		return nullptr;
+	}
+
+	return chunks;
+}
+
+void MG_AssetChunks_Destroy(MG_AssetChunks* chunks)
+{
+	delete chunks;
+}
+
+mglong MG_AssetChunks_GetLength(MG_AssetChunks* chunks)
+{
+	assert(chunks != nullptr);
+	return chunks->length;
+}
+
+// Copies part of a chunk out of the cache, decoding it first if needed.
+static bool MG_AssetChunks_ReadPartial(MG_AssetChunks* chunks, MG_Asset* handle, mglong index, mglong start, mgbyte* buffer, mglong count)
+{
+	std::lock_guard<std::mutex> lock(chunks->mutex);
+
+	if (chunks->cached != index)
+	{
+		chunks->cached = -1;
+		chunks->cache.resize(chunks->chunkSize);
+
+		auto compressedBytes = (mglong)(chunks->offsets[index + 1] - chunks->offsets[index]);
+		chunks->compressed.resize((size_t)compressedBytes);
+
+		if (MG_Asset_ReadRaw(handle, chunks->offsets[index], chunks->compressed.data(), compressedBytes) != compressedBytes)
+			return false;
+		if (!MG_AssetChunks_Decode(chunks, index, chunks->compressed.data(), chunks->cache.data()))
+			return false;
+
+		chunks->cached = index;
+	}
+
+	memcpy(buffer, chunks->cache.data() + start, (size_t)count);
+	return true;
+}
+
+// Decodes a run of whole chunks straight into the caller's buffer.
+static bool MG_AssetChunks_ReadWhole(MG_AssetChunks* chunks, MG_Asset* handle, mglong first, mglong last, mgbyte* buffer)
+{
+	// The compressed chunks are next to each other
+	// so we fetch all of them with a single read.
+	auto base = chunks->offsets[first];
+	auto compressedBytes = (mglong)(chunks->offsets[last] - base);
+
+	std::vector<mgbyte> compressed((size_t)compressedBytes);
+	if (MG_Asset_ReadRaw(handle, base, compressed.data(), compressedBytes) != compressedBytes)
+		return false;
+
+	std::atomic<bool> failed(false);
+
+	auto decode = [&](mgint i)
+	{
+		auto index = first + i;
+		auto src = compressed.data() + (chunks->offsets[index] - base);
+		auto dst = buffer + ((index - first) * chunks->chunkSize);
+		if (!failed && !MG_AssetChunks_Decode(chunks, index, src, dst))
+			failed = true;
+	};
+
+	auto count = (mgint)(last - first);
+	if (count >= MG_CHUNKS_PARALLEL_MIN)
+		MG_ParallelFor(count, decode);
+	else
+	{
+		for (mgint i = 0; i < count; i++)
+			decode(i);
+	}
+
+	return !failed;
+}
+
+mglong MG_AssetChunks_ReadAt(MG_AssetChunks* chunks, MG_Asset* handle, mglong offset, mgbyte* buffer, mglong count)
+{
+	assert(chunks != nullptr);
+	assert(handle != nullptr);
+
+	if (offset < 0 || offset >= chunks->length)
+		return 0;
+	if (count > chunks->length - offset)
+		count = chunks->length - offset;
+	if (count <= 0)
+		return 0;
+
+	auto chunkSize = (mglong)chunks->chunkSize;
+	auto end = offset + count;
+
+	// The chunks completely covered by the read.
+	auto first = (offset + chunkSize - 1) / chunkSize;
+	auto last = end == chunks->length ? (mglong)chunks->offsets.size() - 1 : end / chunkSize;
+
+	if (first >= last)
+	{
+		// The read is within one chunk or straddles two.
+		auto index = offset / chunkSize;
+		auto start = offset - (index * chunkSize);
+		auto bytes = std::min(count, chunkSize - start);
+		if (!MG_AssetChunks_ReadPartial(chunks, handle, index, start, buffer, bytes))
+			return -1;
+		if (bytes < count && !MG_AssetChunks_ReadPartial(chunks, handle, index + 1, 0, buffer + bytes, count - bytes))
+			return -1;
+		return count;
+	}
+
+	auto head = (first * chunkSize) - offset;
+	auto tail = end - std::min(end, last * chunkSize);
+
+	if (head > 0 && !MG_AssetChunks_ReadPartial(chunks, handle, first - 1, chunkSize - head, buffer, head))
+		return -1;
+	if (!MG_AssetChunks_ReadWhole(chunks, handle, first, last, buffer + head))
+		return -1;
+	if (tail > 0 && !MG_AssetChunks_ReadPartial(chunks, handle, last, 0, buffer + count - tail, tail))
+		return -1;
+
+	return count;
+}
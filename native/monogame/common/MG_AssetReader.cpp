@@ -0,0 +1,727 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "mg_common.h"
+#include "api_MG_Asset.h"
+#include "MG_Asset_common.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#define MG_ASSET_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+
+// Reads which are close together in the same file are merged into
+// a single vectored read.  Small gaps between them are read into a
+// scratch buffer which is cheaper than issuing another request.
+static const mglong MG_AssetReader_MaxGap = 64 * 1024;
+static const mglong MG_AssetReader_MaxGroupBytes = 16 * 1024 * 1024;
+static const size_t MG_AssetReader_MaxGroupReads = 64;
+
+struct MG_AssetReadMember
+{
+	mgulong userData;
+	mglong offset;
+	mgint length;
+	mgbyte* buffer;
+};
+
+struct MG_AssetReadGroup
+{
+	MG_Asset* asset;
+	FILE* file;
+
+	// The range within the file and how much of it is read.
+	mglong base;
+	mglong start;
+	mglong length;
+	mglong done;
+
+	std::vector<MG_AssetReadMember> members;
+
+#if !defined(_WIN32)
+	std::vector<iovec> iov;
+	size_t iovFirst;
+
+	// Gaps between members are read here.  Each group has its
+	// own so groups in flight at once never share memory.
+	std::vector<mgbyte> scratch;
+#endif
+};
+
+#if defined(MG_ASSET_IO_URING)
+
+struct MG_Uring
+{
+	int fd = -1;
+
+	unsigned* sqHead;
+	unsigned* sqTail;
+	unsigned* sqMask;
+	unsigned* sqArray;
+	io_uring_sqe* sqes = nullptr;
+	unsigned sqEntries;
+
+	unsigned* cqHead;
+	unsigned* cqTail;
+	unsigned* cqMask;
+	io_uring_cqe* cqes;
+	unsigned cqEntries;
+
+	void* sqRing = nullptr;
+	size_t sqRingBytes = 0;
+	void* cqRing = nullptr;
+	size_t cqRingBytes = 0;
+	size_t sqesBytes = 0;
+};
+
+#endif
+
+struct MG_AssetReader
+{
+	mgint maxInFlight;
+
+	// Guards everything below, including the rings.
+	std::mutex mutex;
+	std::condition_variable completed;
+	std::deque<MG_AssetReadResult> results;
+	mgint outstanding = 0;
+
+#if defined(MG_ASSET_IO_URING)
+	bool useUring = false;
+	MG_Uring uring;
+	std::deque<MG_AssetReadGroup*> pending;
+	mgint inFlight = 0;
+
+	// Only one thread at a time blocks in the kernel, the
+	// others wait for it to signal completed.
+	bool uringWaiting = false;
+	bool wakeWaiter = false;
+#endif
+
+	// The fallback when the platform has no async file API.
+	std::condition_variable wake;
+	std::deque<MG_AssetReadGroup*> queue;
+	std::vector<std::thread> workers;
+	bool quit = false;
+};
+
+
+// The caller must hold the reader mutex.
+static void MG_AssetReader_CompleteLocked(MG_AssetReader* reader, MG_AssetReadGroup* group, mglong result)
+{
+	// Each member gets whatever part of its range was read.
+	for (auto& member : group->members)
+	{
+		MG_AssetReadResult r;
+		r.UserData = member.userData;
+
+		if (result < 0)
+			r.BytesRead = -1;
+		else
+		{
+			auto read = result - (member.offset - group->start);
+			r.BytesRead = (mgint)std::max<mglong>(0, std::min<mglong>(read, member.length));
+		}
+
+		reader->results.push_back(r);
+		reader->outstanding--;
+	}
+
+	delete group;
+
+	reader->completed.notify_all();
+}
+
+static void MG_AssetReader_Complete(MG_AssetReader* reader, MG_AssetReadGroup* group, mglong result)
+{
+	std::lock_guard<std::mutex> lock(reader->mutex);
+	MG_AssetReader_CompleteLocked(reader, group, result);
+}
+
+#if !defined(_WIN32)
+
+// Moves past the data already read, which only
+// matters when the system returns a short read.
+static void MG_AssetReadGroup_Advance(MG_AssetReadGroup* group, mglong read)
+{
+	group->done += read;
+
+	while (read > 0 && group->iovFirst < group->iov.size())
+	{
+		auto& iov = group->iov[group->iovFirst];
+		if ((size_t)read < iov.iov_len)
+		{
+			iov.iov_base = (mgbyte*)iov.iov_base + read;
+			iov.iov_len -= read;
+			break;
+		}
+
+		read -= iov.iov_len;
+		group->iovFirst++;
+	}
+}
+
+#endif
+
+static void MG_AssetReader_Execute(MG_AssetReader* reader, MG_AssetReadGroup* group)
+{
+	mglong result;
+
+	// Compressed assets are never merged as
+	// they must be decompressed by the asset.
+	if (group->file == nullptr)
+	{
+		auto& member = group->members[0];
+		result = MG_Asset_ReadAt(group->asset, member.offset, member.buffer, member.length);
+		MG_AssetReader_Complete(reader, group, result);
+		return;
+	}
+
+#if defined(_WIN32)
+	// Without a vectored positional read every group is a single read.
+	auto& member = group->members[0];
+	result = MG_Asset_ReadAt(group->asset, member.offset - group->base, member.buffer, member.length);
+#else
+	auto fd = fileno(group->file);
+
+	result = 0;
+	while (group->done < group->length)
+	{
+		auto iov = group->iov.data() + group->iovFirst;
+		auto iovcnt = (int)(group->iov.size() - group->iovFirst);
+
+		auto read = preadv(fd, iov, iovcnt, group->start + group->done);
+		if (read < 0 && errno == EINTR)
+			continue;
+		if (read <= 0)
+		{
+			if (read < 0 && group->done == 0)
+				result = -1;
+			break;
+		}
+
+		MG_AssetReadGroup_Advance(group, read);
+	}
+
+	if (result == 0)
+		result = group->done;
+#endif
+
+	MG_AssetReader_Complete(reader, group, result);
+}
+
+static void MG_AssetReader_Worker(MG_AssetReader* reader)
+{
+	while (true)
+	{
+		MG_AssetReadGroup* group;
+		{
+			std::unique_lock<std::mutex> lock(reader->mutex);
+			reader->wake.wait(lock, [reader] { return reader->quit || !reader->queue.empty(); });
+
+			if (reader->queue.empty())
+				break;
+
+			group = reader->queue.front();
+			reader->queue.pop_front();
+		}
+
+		MG_AssetReader_Execute(reader, group);
+	}
+}
+
+#if defined(MG_ASSET_IO_URING)
+
+static bool MG_Uring_Create(MG_Uring& uring, unsigned entries)
+{
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	// This fails on old kernels or where it is blocked
+	// by a sandbox, in which case we use the workers.
+	uring.fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+	if (uring.fd < 0)
+		return false;
+
+	uring.sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	uring.cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+		uring.sqRingBytes = uring.cqRingBytes = std::max(uring.sqRingBytes, uring.cqRingBytes);
+
+	uring.sqRing = mmap(nullptr, uring.sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring.fd, IORING_OFF_SQ_RING);
+	if (uring.sqRing == MAP_FAILED)
+	{
+		uring.sqRing = nullptr;
+		return false;
+	}
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+		uring.cqRing = uring.sqRing;
+	else
+	{
+		uring.cqRing = mmap(nullptr, uring.cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring.fd, IORING_OFF_CQ_RING);
+		if (uring.cqRing == MAP_FAILED)
+		{
+			uring.cqRing = nullptr;
+			return false;
+		}
+	}
+
+	uring.sqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+	auto sqes = mmap(nullptr, uring.sqesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring.fd, IORING_OFF_SQES);
+	if (sqes == MAP_FAILED)
+		return false;
+
+	auto sq = (mgbyte*)uring.sqRing;
+	uring.sqHead = (unsigned*)(sq + params.sq_off.head);
+	uring.sqTail = (unsigned*)(sq + params.sq_off.tail);
+	uring.sqMask = (unsigned*)(sq + params.sq_off.ring_mask);
+	uring.sqArray = (unsigned*)(sq + params.sq_off.array);
+	uring.sqes = (io_uring_sqe*)sqes;
+	uring.sqEntries = params.sq_entries;
+
+	auto cq = (mgbyte*)uring.cqRing;
+	uring.cqHead = (unsigned*)(cq + params.cq_off.head);
+	uring.cqTail = (unsigned*)(cq + params.cq_off.tail);
+	uring.cqMask = (unsigned*)(cq + params.cq_off.ring_mask);
+	uring.cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+	uring.cqEntries = params.cq_entries;
+
+	return true;
+}
+
+static void MG_Uring_Destroy(MG_Uring& uring)
+{
+	if (uring.sqes)
+		munmap(uring.sqes, uring.sqesBytes);
+	if (uring.cqRing && uring.cqRing != uring.sqRing)
+		munmap(uring.cqRing, uring.cqRingBytes);
+	if (uring.sqRing)
+		munmap(uring.sqRing, uring.sqRingBytes);
+	if (uring.fd >= 0)
+		close(uring.fd);
+
+	uring = MG_Uring();
+}
+
+static void MG_Uring_Enter(MG_Uring& uring, unsigned submit, unsigned wait)
+{
+	auto flags = wait > 0 ? IORING_ENTER_GETEVENTS : 0;
+	while (syscall(__NR_io_uring_enter, uring.fd, submit, wait, flags, nullptr, 0) < 0 && errno == EINTR)
+	{
+	}
+}
+
+// The rings, pending and inFlight are only touched with the
+// reader mutex held.  Submitting doesn't block so it is fine
+// to enter the kernel with it held.
+static void MG_AssetReader_SubmitPendingLocked(MG_AssetReader* reader)
+{
+	auto& uring = reader->uring;
+
+	auto tail = *uring.sqTail;
+	auto head = __atomic_load_n(uring.sqHead, __ATOMIC_ACQUIRE);
+	unsigned submit = 0;
+
+	// Never have more in flight than the completion
+	// queue can hold or completions could be lost.
+	while (	!reader->pending.empty() &&
+			tail - head < uring.sqEntries &&
+			(unsigned)reader->inFlight < uring.cqEntries)
+	{
+		auto group = reader->pending.front();
+		reader->pending.pop_front();
+
+		auto index = tail & *uring.sqMask;
+		auto& sqe = uring.sqes[index];
+		memset(&sqe, 0, sizeof(sqe));
+		sqe.opcode = IORING_OP_READV;
+		sqe.fd = fileno(group->file);
+		sqe.off = group->start + group->done;
+		sqe.addr = (mgulong)(group->iov.data() + group->iovFirst);
+		sqe.len = (unsigned)(group->iov.size() - group->iovFirst);
+		sqe.user_data = (mgulong)group;
+
+		uring.sqArray[index] = index;
+		tail++;
+		submit++;
+		reader->inFlight++;
+	}
+
+	// A reap by another thread could have taken the completion
+	// the waiting thread is blocked on, so wake it with a no-op.
+	if (reader->wakeWaiter && reader->uringWaiting &&
+		tail - head < uring.sqEntries &&
+		(unsigned)reader->inFlight < uring.cqEntries)
+	{
+		auto index = tail & *uring.sqMask;
+		auto& sqe = uring.sqes[index];
+		memset(&sqe, 0, sizeof(sqe));
+		sqe.opcode = IORING_OP_NOP;
+		sqe.user_data = 0;
+
+		uring.sqArray[index] = index;
+		tail++;
+		submit++;
+		reader->inFlight++;
+	}
+
+	reader->wakeWaiter = false;
+
+	if (submit == 0)
+		return;
+
+	__atomic_store_n(uring.sqTail, tail, __ATOMIC_RELEASE);
+	MG_Uring_Enter(uring, submit, 0);
+}
+
+static void MG_AssetReader_ReapLocked(MG_AssetReader* reader)
+{
+	auto& uring = reader->uring;
+
+	auto head = *uring.cqHead;
+	auto tail = __atomic_load_n(uring.cqTail, __ATOMIC_ACQUIRE);
+
+	if (head != tail && reader->uringWaiting)
+		reader->wakeWaiter = true;
+
+	for (; head != tail; head++)
+	{
+		auto& cqe = uring.cqes[head & *uring.cqMask];
+		auto group = (MG_AssetReadGroup*)cqe.user_data;
+		reader->inFlight--;
+
+		// The no-op used to wake a waiting thread.
+		if (group == nullptr)
+			continue;
+
+		if (cqe.res > 0)
+		{
+			// A short read is unusual, but when it happens
+			// we queue another read for the rest.
+			MG_AssetReadGroup_Advance(group, cqe.res);
+			if (group->done < group->length)
+			{
+				reader->pending.push_front(group);
+				continue;
+			}
+		}
+
+		auto result = cqe.res < 0 && group->done == 0 ? -1 : group->done;
+		MG_AssetReader_CompleteLocked(reader, group, result);
+	}
+
+	__atomic_store_n(uring.cqHead, head, __ATOMIC_RELEASE);
+
+	MG_AssetReader_SubmitPendingLocked(reader);
+}
+
+#endif
+
+static void MG_AssetReader_StartWorkers(MG_AssetReader* reader, mgint maxInFlight)
+{
+	// Blocking reads don't need many threads to
+	// saturate a drive, but don't use more than asked.
+	auto count = std::max(1, std::min<mgint>(maxInFlight, std::min(4, (mgint)std::thread::hardware_concurrency())));
+	for (int i = 0; i < count; i++)
+		reader->workers.emplace_back(MG_AssetReader_Worker, reader);
+}
+
+static void MG_AssetReader_Dispatch(MG_AssetReader* reader, MG_AssetReadGroup* group)
+{
+#if !defined(_WIN32)
+	// Point the gaps at the group's scratch now that its
+	// size is known and it will no longer be reallocated.
+	if (!group->scratch.empty())
+	{
+		for (auto& iov : group->iov)
+		{
+			if (iov.iov_base == nullptr)
+				iov.iov_base = group->scratch.data();
+		}
+	}
+#endif
+
+	{
+		std::lock_guard<std::mutex> lock(reader->mutex);
+
+#if defined(MG_ASSET_IO_URING)
+		if (reader->useUring && group->file != nullptr)
+		{
+			reader->pending.push_back(group);
+			return;
+		}
+
+		// Decompression can't be done by the kernel, so those
+		// reads go to workers which we only start when needed.
+		if (reader->workers.empty())
+			MG_AssetReader_StartWorkers(reader, reader->maxInFlight);
+#endif
+
+		reader->queue.push_back(group);
+	}
+	reader->wake.notify_one();
+}
+
+MG_AssetReader* MG_AssetReader_Create(mgint maxInFlight)
+{
+	assert(maxInFlight > 0);
+
+	auto reader = new MG_AssetReader();
+	reader->maxInFlight = maxInFlight;
+
+#if defined(MG_ASSET_IO_URING)
+	unsigned entries = 1;
+	while (entries < (unsigned)maxInFlight && entries < 4096)
+		entries <<= 1;
+
+	reader->useUring = MG_Uring_Create(reader->uring, entries);
+	if (reader->useUring)
+		return reader;
+
+	MG_Uring_Destroy(reader->uring);
+#endif
+
+	MG_AssetReader_StartWorkers(reader, maxInFlight);
+
+	return reader;
+}
+
+void MG_AssetReader_Destroy(MG_AssetReader* reader)
+{
+	assert(reader != nullptr);
+
+	// The buffers belong to the caller, so every
+	// read must be finished before we return.
+	MG_AssetReadResult result;
+	while (MG_AssetReader_Wait(reader, &result, 1) > 0)
+	{
+	}
+
+#if defined(MG_ASSET_IO_URING)
+	MG_Uring_Destroy(reader->uring);
+#endif
+
+	{
+		std::lock_guard<std::mutex> lock(reader->mutex);
+		reader->quit = true;
+	}
+	reader->wake.notify_all();
+
+	for (auto& worker : reader->workers)
+		worker.join();
+
+	delete reader;
+}
+
+void MG_AssetReader_Submit(MG_AssetReader* reader, MG_AssetRead* reads, mgint count)
+{
+	assert(reader != nullptr);
+	assert(reads != nullptr || count == 0);
+
+	struct Item
+	{
+		FILE* file;
+		MG_Asset* asset;
+		mglong base;
+		MG_AssetReadMember member;
+	};
+
+	std::vector<Item> items;
+	items.reserve(count);
+
+	for (mgint i = 0; i < count; i++)
+	{
+		auto& read = reads[i];
+		assert(read.Asset != nullptr);
+		assert(read.Buffer != nullptr || read.Length == 0);
+
+		mglong base, length;
+		auto file = MG_Asset_GetFile(read.Asset, base, length);
+
+		// Clip to the asset so we never read into
+		// the neighboring assets of a pack.
+		Item item;
+		item.file = file;
+		item.asset = read.Asset;
+		item.base = base;
+		item.member.userData = read.UserData;
+		item.member.offset = base + read.Offset;
+		item.member.length = (mgint)std::max<mglong>(0, std::min<mglong>(read.Length, length - read.Offset));
+		item.member.buffer = read.Buffer;
+
+		if (read.Offset < 0 || item.member.length == 0)
+		{
+			std::lock_guard<std::mutex> lock(reader->mutex);
+			reader->results.push_back({ read.UserData, read.Offset < 0 ? -1 : 0 });
+			reader->completed.notify_all();
+			continue;
+		}
+
+		items.push_back(item);
+	}
+
+	// Order by location so neighboring reads can be merged.
+	std::stable_sort(items.begin(), items.end(), [](const Item& a, const Item& b)
+	{
+		if (a.file != b.file)
+			return a.file < b.file;
+		return a.member.offset < b.member.offset;
+	});
+
+	{
+		std::lock_guard<std::mutex> lock(reader->mutex);
+		reader->outstanding += (mgint)items.size();
+	}
+
+	MG_AssetReadGroup* group = nullptr;
+
+	for (auto& item : items)
+	{
+		auto& member = item.member;
+
+#if !defined(_WIN32)
+		if (group != nullptr && group->file != nullptr && group->file == item.file)
+		{
+			auto end = group->start + group->length;
+			auto gap = member.offset - end;
+
+			if (gap >= 0 && gap <= MG_AssetReader_MaxGap &&
+				group->length + gap + member.length <= MG_AssetReader_MaxGroupBytes &&
+				group->members.size() < MG_AssetReader_MaxGroupReads)
+			{
+				// The gap is pointed at the scratch on dispatch.
+				if (gap > 0)
+				{
+					group->iov.push_back({ nullptr, (size_t)gap });
+					if ((size_t)gap > group->scratch.size())
+						group->scratch.resize(gap);
+				}
+				group->iov.push_back({ member.buffer, (size_t)member.length });
+				group->members.push_back(member);
+				group->length += gap + member.length;
+				continue;
+			}
+		}
+#endif
+
+		if (group != nullptr)
+			MG_AssetReader_Dispatch(reader, group);
+
+		group = new MG_AssetReadGroup();
+		group->asset = item.asset;
+		group->file = item.file;
+		group->base = item.base;
+		group->start = member.offset;
+		group->length = member.length;
+		group->done = 0;
+		group->members.push_back(member);
+
+#if !defined(_WIN32)
+		group->iov.push_back({ member.buffer, (size_t)member.length });
+		group->iovFirst = 0;
+#endif
+	}
+
+	if (group != nullptr)
+		MG_AssetReader_Dispatch(reader, group);
+
+#if defined(MG_ASSET_IO_URING)
+	if (reader->useUring)
+	{
+		std::lock_guard<std::mutex> lock(reader->mutex);
+		MG_AssetReader_SubmitPendingLocked(reader);
+	}
+#endif
+}
+
+static mgint MG_AssetReader_TakeResults(MG_AssetReader* reader, MG_AssetReadResult* results, mgint maxResults)
+{
+	mgint count = 0;
+	while (count < maxResults && !reader->results.empty())
+	{
+		results[count++] = reader->results.front();
+		reader->results.pop_front();
+	}
+
+	return count;
+}
+
+mgint MG_AssetReader_Poll(MG_AssetReader* reader, MG_AssetReadResult* results, mgint maxResults)
+{
+	assert(reader != nullptr);
+
+	std::lock_guard<std::mutex> lock(reader->mutex);
+
+#if defined(MG_ASSET_IO_URING)
+	if (reader->useUring)
+		MG_AssetReader_ReapLocked(reader);
+#endif
+
+	return MG_AssetReader_TakeResults(reader, results, maxResults);
+}
+
+mgint MG_AssetReader_Wait(MG_AssetReader* reader, MG_AssetReadResult* results, mgint maxResults)
+{
+	assert(reader != nullptr);
+
+#if defined(MG_ASSET_IO_URING)
+	if (reader->useUring)
+	{
+		std::unique_lock<std::mutex> lock(reader->mutex);
+
+		while (true)
+		{
+			MG_AssetReader_ReapLocked(reader);
+
+			if (!reader->results.empty() || reader->outstanding == 0)
+				break;
+
+			// Block in the kernel without the lock so other threads
+			// can submit and poll.  Anything they reap while we wait
+			// sends a no-op so we don't sleep on a taken completion.
+			if (reader->inFlight > 0 && !reader->uringWaiting)
+			{
+				reader->uringWaiting = true;
+				lock.unlock();
+				MG_Uring_Enter(reader->uring, 0, 1);
+				lock.lock();
+				reader->uringWaiting = false;
+
+				// Let a thread waiting below take over
+				// if we return with our results.
+				reader->completed.notify_all();
+				continue;
+			}
+
+			// Another thread is in the kernel or the
+			// rest of the reads are on the workers.
+			reader->completed.wait(lock);
+		}
+
+		return MG_AssetReader_TakeResults(reader, results, maxResults);
+	}
+#endif
+
+	std::unique_lock<std::mutex> lock(reader->mutex);
+	reader->completed.wait(lock, [reader] { return !reader->results.empty() || reader->outstanding == 0; });
+	return MG_AssetReader_TakeResults(reader, results, maxResults);
+}
@@ -0,0 +1,380 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "mg_common.h"
+#include "api_MG_Asset.h"
+#include "MG_Asset_common.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+#include <algorithm>
+
+
+// Requests are read in slices so that a large background
+// read can't hold up a critical one for more than a slice.
+static const mglong MG_AssetScheduler_SliceBytes = 256 * 1024;
+
+// How close to its deadline a request gets
+// before it is treated as critical.
+static const mgint MG_AssetScheduler_DeadlineSlackMS = 16;
+
+typedef std::chrono::steady_clock MG_AssetClock;
+
+struct MG_AssetRequestState
+{
+	mgulong id;
+	mgulong sequence;
+	MG_AssetRequest request;
+
+	bool hasDeadline;
+	MG_AssetClock::time_point deadline;
+
+	mglong done;
+	bool running;
+	bool cancelled;
+};
+
+struct MG_AssetScheduler
+{
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable sliceDone;
+	std::condition_variable completed;
+
+	std::vector<MG_AssetRequestState*> queue;
+	std::unordered_map<mgulong, MG_AssetRequestState*> requests;
+	std::deque<MG_AssetRequestResult> results;
+	mgulong nextId = 1;
+	mgulong nextSequence = 0;
+
+	// Background reads are limited to a share of the
+	// workers so there is always one free for urgent work.
+	mgint maxBackground = 1;
+	mgint runningBackground = 0;
+
+	// A token bucket for the background bandwidth.
+	mglong bytesPerSecond = 0;
+	double tokens = 0;
+	MG_AssetClock::time_point refilled;
+
+	std::vector<std::thread> workers;
+	bool quit = false;
+};
+
+
+static MGAssetPriority MG_AssetScheduler_EffectivePriority(MG_AssetRequestState* state, MG_AssetClock::time_point now)
+{
+	if (state->hasDeadline && now + std::chrono::milliseconds(MG_AssetScheduler_DeadlineSlackMS) >= state->deadline)
+		return MGAssetPriority::Critical;
+
+	return state->request.Priority;
+}
+
+// Earlier deadlines first, then in the order submitted.
+static bool MG_AssetScheduler_Before(MG_AssetRequestState* a, MGAssetPriority pa, MG_AssetRequestState* b, MGAssetPriority pb)
+{
+	if (pa != pb)
+		return pa < pb;
+	if (a->hasDeadline != b->hasDeadline)
+		return a->hasDeadline;
+	if (a->hasDeadline && a->deadline != b->deadline)
+		return a->deadline < b->deadline;
+	return a->sequence < b->sequence;
+}
+
+static void MG_AssetScheduler_Refill(MG_AssetScheduler* scheduler, MG_AssetClock::time_point now)
+{
+	if (scheduler->bytesPerSecond <= 0)
+		return;
+
+	// Allow a short burst, but never less than a slice.
+	auto capacity = std::max<double>((double)MG_AssetScheduler_SliceBytes, scheduler->bytesPerSecond * 0.1);
+
+	auto elapsed = std::chrono::duration<double>(now - scheduler->refilled).count();
+	scheduler->tokens = std::min(capacity, scheduler->tokens + (elapsed * scheduler->bytesPerSecond));
+	scheduler->refilled = now;
+}
+
+// Picks the next request to read a slice of or returns null, in which
+// case wakeTime is when throttling or a deadline could change that.
+static MG_AssetRequestState* MG_AssetScheduler_Next(MG_AssetScheduler* scheduler, MG_AssetClock::time_point now, MGAssetPriority& bestPriority, MG_AssetClock::time_point& wakeTime)
+{
+	MG_AssetScheduler_Refill(scheduler, now);
+
+	bool backgroundAllowed = scheduler->runningBackground < scheduler->maxBackground;
+	bool throttled = scheduler->bytesPerSecond > 0 && scheduler->tokens <= 0;
+
+	MG_AssetRequestState* best = nullptr;
+	bestPriority = MGAssetPriority::Background;
+	bool blocked = false;
+
+	for (auto state : scheduler->queue)
+	{
+		if (state->running)
+			continue;
+
+		auto priority = MG_AssetScheduler_EffectivePriority(state, now);
+		if (priority == MGAssetPriority::Background && (!backgroundAllowed || throttled))
+		{
+			blocked = true;
+			continue;
+		}
+
+		if (best == nullptr || MG_AssetScheduler_Before(state, priority, best, bestPriority))
+		{
+			best = state;
+			bestPriority = priority;
+		}
+	}
+
+	wakeTime = MG_AssetClock::time_point::max();
+	if (best == nullptr && blocked && throttled && backgroundAllowed)
+	{
+		auto seconds = -scheduler->tokens / scheduler->bytesPerSecond;
+		wakeTime = now + std::chrono::duration_cast<MG_AssetClock::duration>(std::chrono::duration<double>(seconds)) + std::chrono::milliseconds(1);
+	}
+
+	// Deadlines can also promote a request, so wake for the nearest one.
+	for (auto state : scheduler->queue)
+	{
+		if (!state->running && state->hasDeadline && state->request.Priority != MGAssetPriority::Critical)
+			wakeTime = std::min(wakeTime, state->deadline - std::chrono::milliseconds(MG_AssetScheduler_DeadlineSlackMS));
+	}
+
+	return best;
+}
+
+static void MG_AssetScheduler_Finish(MG_AssetScheduler* scheduler, MG_AssetRequestState* state, MGAssetStatus status)
+{
+	MG_AssetRequestResult result;
+	result.UserData = state->request.UserData;
+	result.BytesRead = status == MGAssetStatus::Failed ? -1 : state->done;
+	result.Status = status;
+	result.Late = state->hasDeadline && MG_AssetClock::now() > state->deadline;
+	scheduler->results.push_back(result);
+
+	scheduler->queue.erase(std::find(scheduler->queue.begin(), scheduler->queue.end(), state));
+	scheduler->requests.erase(state->id);
+	delete state;
+
+	scheduler->completed.notify_all();
+}
+
+static void MG_AssetScheduler_Worker(MG_AssetScheduler* scheduler)
+{
+	std::unique_lock<std::mutex> lock(scheduler->mutex);
+
+	while (!scheduler->quit)
+	{
+		MGAssetPriority priority;
+		MG_AssetClock::time_point wakeTime;
+		auto state = MG_AssetScheduler_Next(scheduler, MG_AssetClock::now(), priority, wakeTime);
+		if (state == nullptr)
+		{
+			if (wakeTime == MG_AssetClock::time_point::max())
+				scheduler->wake.wait(lock);
+			else
+				scheduler->wake.wait_until(lock, wakeTime);
+			continue;
+		}
+
+		auto background = priority == MGAssetPriority::Background;
+		auto& request = state->request;
+		auto offset = request.Offset + state->done;
+		auto buffer = request.Buffer + state->done;
+		auto count = std::min(request.Length - state->done, MG_AssetScheduler_SliceBytes);
+
+		state->running = true;
+		if (background)
+			scheduler->runningBackground++;
+
+		lock.unlock();
+		auto read = MG_Asset_ReadAt(request.Asset, offset, buffer, count);
+		lock.lock();
+
+		state->running = false;
+		if (background)
+		{
+			scheduler->runningBackground--;
+			if (scheduler->bytesPerSecond > 0)
+				scheduler->tokens -= (double)std::max<mglong>(read, 0);
+		}
+		scheduler->sliceDone.notify_all();
+
+		if (read > 0)
+			state->done += read;
+
+		if (state->cancelled)
+			MG_AssetScheduler_Finish(scheduler, state, MGAssetStatus::Cancelled);
+		else if (read < 0 && state->done == 0)
+			MG_AssetScheduler_Finish(scheduler, state, MGAssetStatus::Failed);
+		else if (read < count || state->done == request.Length)
+			MG_AssetScheduler_Finish(scheduler, state, MGAssetStatus::Completed);
+
+		// Others may be waiting for a background slot or for a
+		// request that was skipped while this one was running.
+		scheduler->wake.notify_one();
+	}
+}
+
+MG_AssetScheduler* MG_AssetScheduler_Create(mgint workers)
+{
+	assert(workers > 0);
+
+	auto scheduler = new MG_AssetScheduler();
+	scheduler->maxBackground = std::max(1, workers - 1);
+	scheduler->refilled = MG_AssetClock::now();
+
+	for (int i = 0; i < workers; i++)
+		scheduler->workers.emplace_back(MG_AssetScheduler_Worker, scheduler);
+
+	return scheduler;
+}
+
+void MG_AssetScheduler_Destroy(MG_AssetScheduler* scheduler)
+{
+	assert(scheduler != nullptr);
+
+	{
+		std::lock_guard<std::mutex> lock(scheduler->mutex);
+		scheduler->quit = true;
+	}
+	scheduler->wake.notify_all();
+
+	// Workers stop after their current slice and anything
+	// still queued is dropped without a result.
+	for (auto& worker : scheduler->workers)
+		worker.join();
+
+	for (auto state : scheduler->queue)
+		delete state;
+
+	delete scheduler;
+}
+
+void MG_AssetScheduler_SetBackgroundBandwidth(MG_AssetScheduler* scheduler, mglong bytesPerSecond)
+{
+	assert(scheduler != nullptr);
+
+	{
+		std::lock_guard<std::mutex> lock(scheduler->mutex);
+		scheduler->bytesPerSecond = std::max<mglong>(0, bytesPerSecond);
+		scheduler->tokens = 0;
+		scheduler->refilled = MG_AssetClock::now();
+	}
+	scheduler->wake.notify_all();
+}
+
+mgulong MG_AssetScheduler_Submit(MG_AssetScheduler* scheduler, MG_AssetRequest& request)
+{
+	assert(scheduler != nullptr);
+	assert(request.Asset != nullptr);
+	assert(request.Buffer != nullptr || request.Length == 0);
+
+	auto state = new MG_AssetRequestState();
+	state->request = request;
+	state->hasDeadline = request.DeadlineMS > 0;
+	state->deadline = MG_AssetClock::now() + std::chrono::milliseconds(std::max(0, request.DeadlineMS));
+	state->done = 0;
+	state->running = false;
+	state->cancelled = false;
+
+	mgulong id;
+	{
+		std::lock_guard<std::mutex> lock(scheduler->mutex);
+
+		id = scheduler->nextId++;
+		state->id = id;
+		state->sequence = scheduler->nextSequence++;
+
+		scheduler->queue.push_back(state);
+		scheduler->requests[id] = state;
+
+		// Nothing to read, so it is finished right away.
+		if (request.Length <= 0 || request.Offset < 0)
+		{
+			MG_AssetScheduler_Finish(scheduler, state, request.Offset < 0 ? MGAssetStatus::Failed : MGAssetStatus::Completed);
+			return id;
+		}
+	}
+	scheduler->wake.notify_one();
+
+	return id;
+}
+
+mgbool MG_AssetScheduler_SetPriority(MG_AssetScheduler* scheduler, mgulong id, MGAssetPriority priority)
+{
+	assert(scheduler != nullptr);
+
+	{
+		std::lock_guard<std::mutex> lock(scheduler->mutex);
+
+		auto found = scheduler->requests.find(id);
+		if (found == scheduler->requests.end())
+			return false;
+
+		// This takes effect from the next slice.
+		found->second->request.Priority = priority;
+	}
+	scheduler->wake.notify_all();
+
+	return true;
+}
+
+mgbool MG_AssetScheduler_Cancel(MG_AssetScheduler* scheduler, mgulong id)
+{
+	assert(scheduler != nullptr);
+
+	std::unique_lock<std::mutex> lock(scheduler->mutex);
+
+	auto found = scheduler->requests.find(id);
+	if (found == scheduler->requests.end())
+		return false;
+
+	auto state = found->second;
+	if (!state->running)
+	{
+		MG_AssetScheduler_Finish(scheduler, state, MGAssetStatus::Cancelled);
+		return true;
+	}
+
+	// Wait for the slice in progress so the caller can
+	// free the buffer as soon as we return.
+	state->cancelled = true;
+	scheduler->sliceDone.wait(lock, [scheduler, id] { return scheduler->requests.find(id) == scheduler->requests.end(); });
+	return true;
+}
+
+static mgint MG_AssetScheduler_TakeResults(MG_AssetScheduler* scheduler, MG_AssetRequestResult* results, mgint maxResults)
+{
+	mgint count = 0;
+	while (count < maxResults && !scheduler->results.empty())
+	{
+		results[count++] = scheduler->results.front();
+		scheduler->results.pop_front();
+	}
+
+	return count;
+}
+
+mgint MG_AssetScheduler_Poll(MG_AssetScheduler* scheduler, MG_AssetRequestResult* results, mgint maxResults)
+{
+	assert(scheduler != nullptr);
+
+	std::lock_guard<std::mutex> lock(scheduler->mutex);
+	return MG_AssetScheduler_TakeResults(scheduler, results, maxResults);
+}
+
+mgint MG_AssetScheduler_Wait(MG_AssetScheduler* scheduler, MG_AssetRequestResult* results, mgint maxResults)
+{
+	assert(scheduler != nullptr);
+
+	std::unique_lock<std::mutex> lock(scheduler->mutex);
+	scheduler->completed.wait(lock, [scheduler] { return !scheduler->results.empty() || scheduler->requests.empty(); });
+	return MG_AssetScheduler_TakeResults(scheduler, results, maxResults);
+}
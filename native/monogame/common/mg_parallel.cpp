@@ -0,0 +1,130 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "mg_parallel.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+
+
+struct MG_ParallelJob
+{
+	const std::function<void(mgint)>* work;
+	mgint count;
+	std::atomic<mgint> next;
+};
+
+struct MG_ParallelPool
+{
+	// Only one job runs at a time.
+	std::mutex busy;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	MG_ParallelJob* job = nullptr;
+	mguint generation = 0;
+	mgint working = 0;
+
+	mgint workers = 0;
+};
+
+
+static void MG_ParallelJob_Run(MG_ParallelJob* job)
+{
+	mgint index;
+	while ((index = job->next++) < job->count)
+		(*job->work)(index);
+}
+
+static void MG_ParallelPool_Worker(MG_ParallelPool* pool)
+{
+	mguint seen = 0;
+
+	std::unique_lock<std::mutex> lock(pool->mutex);
+
+	while (true)
+	{
+		pool->wake.wait(lock, [pool, seen] { return pool->generation != seen; });
+		seen = pool->generation;
+
+		// We woke after the job was already finished.
+		auto job = pool->job;
+		if (job == nullptr)
+			continue;
+
+		pool->working++;
+		lock.unlock();
+
+		MG_ParallelJob_Run(job);
+
+		lock.lock();
+		if (--pool->working == 0)
+			pool->done.notify_one();
+	}
+}
+
+static MG_ParallelPool* MG_ParallelPool_Get()
+{
+	// This is never destroyed as joining threads while
+	// a library is unloading can deadlock on Windows.
+	static MG_ParallelPool* pool = []()
+	{
+		auto pool = new MG_ParallelPool();
+
+		// Leave a core for the game thread, the
+		// calling thread also does some of the work.
+		pool->workers = std::max((mgint)std::thread::hardware_concurrency() - 2, 0);
+		for (mgint i = 0; i < pool->workers; i++)
+			std::thread(MG_ParallelPool_Worker, pool).detach();
+
+		return pool;
+	}();
+
+	return pool;
+}
+
+
+void MG_ParallelFor(mgint count, const std::function<void(mgint)>& work)
+{
+	if (count <= 0)
+		return;
+
+	MG_ParallelJob job;
+	job.work = &work;
+	job.count = count;
+	job.next = 0;
+
+	auto pool = count > 1 ? MG_ParallelPool_Get() : nullptr;
+	if (pool == nullptr || pool->workers == 0)
+	{
+		MG_ParallelJob_Run(&job);
+		return;
+	}
+
+	std::unique_lock<std::mutex> busy(pool->busy, std::try_to_lock);
+	if (!busy.owns_lock())
+	{
+		MG_ParallelJob_Run(&job);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(pool->mutex);
+		pool->job = &job;
+		pool->generation++;
+	}
+
+	pool->wake.notify_all();
+
+	MG_ParallelJob_Run(&job);
+
+	// Workers still on the job have to finish before it goes away.
+	std::unique_lock<std::mutex> lock(pool->mutex);
+	pool->done.wait(lock, [pool] { return pool->working == 0; });
+	pool->job = nullptr;
+}
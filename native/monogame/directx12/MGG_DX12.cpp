@@ -1578,6 +1578,209 @@ void MGG_Texture_GetData(MGG_GraphicsDevice* device, MGG_Texture* texture, mgint
 
 }
 
+struct MGG_Readback
+{
+	FrameCounter frame = 0;
+	bool queued = false;
+	uint64_t fence = 0;
+
+	MGSurfaceFormat format = MGSurfaceFormat::Color;
+	mgint dataBytes = 0;
+	mgint copiedBytes = 0;
+
+	// The copy layout in the readback heap.
+	UINT rowPitch = 0;
+	UINT rowBytes = 0;
+	UINT rows = 0;
+
+	MGG_Buffer* buffer = nullptr;
+
+	// Readback rows are padded to D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+	// so they are packed here before being returned.
+	std::vector<mgbyte> packed;
+};
+
+MGG_Readback* MGG_Readback_Create(MGG_GraphicsDevice* device, mgint dataBytes)
+{
+	assert(device != nullptr);
+	assert(dataBytes > 0);
+
+	auto readback = new MGG_Readback();
+	readback->dataBytes = dataBytes;
+	readback->packed.resize(dataBytes);
+	return readback;
+}
+
+void MGG_Readback_Destroy(MGG_GraphicsDevice* device, MGG_Readback* readback)
+{
+	assert(device != nullptr);
+	assert(readback != nullptr);
+
+	// The copy could still be in flight, so let the
+	// frame cleanup release the buffer later.
+	if (readback->buffer != nullptr)
+	{
+		readback->buffer->frame = device->frame;
+		device->destroyBuffers.push(readback->buffer);
+	}
+
+	delete readback;
+}
+
+static MGSurfaceFormat MGDX_ToSurfaceFormat(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+		return MGSurfaceFormat::Bgra32;
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		return MGSurfaceFormat::Bgra32SRgb;
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		return MGSurfaceFormat::ColorSRgb;
+	default:
+		return MGSurfaceFormat::Color;
+	}
+}
+
+void MGG_Readback_Queue(MGG_GraphicsDevice* device, MGG_Readback* readback, MGG_Texture* texture, mgint level, mgint slice, mgint x, mgint y, mgint width, mgint height)
+{
+	assert(device != nullptr);
+	assert(readback != nullptr);
+
+	auto cl = device->context->GetCommandList();
+	assert(cl != nullptr);
+
+	// A null texture means the current backbuffer.
+	Texture* source;
+	if (texture == nullptr)
+	{
+		source = device->resources->GetMainTarget();
+		readback->format = MGDX_ToSurfaceFormat(source->GetFormat());
+	}
+	else
+	{
+		source = texture->texture;
+		readback->format = texture->format;
+	}
+
+	assert(source != nullptr);
+	assert(level >= 0 && level < source->GetMipLevels());
+	assert(x >= 0 && x + width <= source->GetWidth());
+	assert(y >= 0 && y + height <= source->GetHeight());
+
+	readback->queued = false;
+
+	// Multisampled targets would need a resolve first.
+	if (source->GetSampleDesc().Count > 1)
+		return;
+
+	auto desc = CD3DX12_RESOURCE_DESC::Tex2D(source->GetFormat(), width, height, 1, 1);
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+	UINT rows;
+	UINT64 rowBytes;
+	UINT64 totalBytes;
+	device->resources->GetD3DDevice()->GetCopyableFootprints(&desc, 0, 1, 0, &footprint, &rows, &rowBytes, &totalBytes);
+
+	// Grow the readback buffer when needed, the old
+	// one could still be the target of a copy.
+	if (readback->buffer == nullptr || readback->buffer->actualSize < totalBytes)
+	{
+		if (readback->buffer != nullptr)
+		{
+			readback->buffer->frame = device->frame;
+			device->destroyBuffers.push(readback->buffer);
+		}
+
+		auto buffer = new MGG_Buffer();
+		buffer->frame = device->frame;
+		buffer->dataSize = totalBytes;
+		buffer->actualSize = totalBytes;
+		buffer->m_currentState = D3D12_RESOURCE_STATE_COPY_DEST;
+
+		CD3DX12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(totalBytes);
+		D3D12MA::ALLOCATION_DESC allocDesc = { D3D12MA::ALLOCATION_FLAG_COMMITTED, D3D12_HEAP_TYPE_READBACK };
+
+		device->resources->GetAllocator()->CreateResource(
+			&allocDesc, &resourceDesc,
+			D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+			buffer->m_alloc.ReleaseAndGetAddressOf(), IID_GRAPHICS_PPV_ARGS(buffer->m_res.ReleaseAndGetAddressOf()));
+
+		readback->buffer = buffer;
+	}
+
+	auto state = source->GetState();
+	source->Transition(cl, D3D12_RESOURCE_STATE_COPY_SOURCE);
+
+	const CD3DX12_TEXTURE_COPY_LOCATION dst(readback->buffer->m_res.Get(), footprint);
+	const CD3DX12_TEXTURE_COPY_LOCATION src(source->Get(), (slice * source->GetMipLevels()) + level);
+	const D3D12_BOX box = { (UINT)x, (UINT)y, 0, (UINT)(x + width), (UINT)(y + height), 1 };
+	cl->CopyTextureRegion(&dst, 0, 0, 0, &src, &box);
+
+	source->Transition(cl, state);
+
+	readback->frame = device->frame;
+	readback->fence = 0;
+	readback->queued = true;
+	readback->rowPitch = footprint.Footprint.RowPitch;
+	readback->rowBytes = (UINT)rowBytes;
+	readback->rows = rows;
+	readback->copiedBytes = (mgint)(rowBytes * rows);
+	if (readback->copiedBytes > readback->dataBytes)
+		readback->copiedBytes = readback->dataBytes;
+}
+
+mgbyte MGG_Readback_GetData(MGG_GraphicsDevice* device, MGG_Readback* readback, mgbyte*& data, mgint& dataBytes, MGSurfaceFormat& format)
+{
+	assert(device != nullptr);
+	assert(readback != nullptr);
+
+	data = nullptr;
+	dataBytes = 0;
+	format = readback->format;
+
+	if (!readback->queued)
+		return false;
+
+	// The copy is in the frame command list which
+	// isn't executed until that frame is presented.
+	if (device->frame == readback->frame)
+		return false;
+
+	// The queue executes in order so any fence signaled
+	// after the present also covers the copy.
+	auto cq = device->resources->GetCommandQueue();
+	if (readback->fence == 0)
+		readback->fence = cq->SignalFence();
+	if (!cq->IsFenceComplete(readback->fence))
+		return false;
+
+	auto buffer = readback->buffer->m_res.Get();
+
+	D3D12_RANGE readRange{ 0, (SIZE_T)readback->rowPitch * readback->rows };
+	mgbyte* mapped = nullptr;
+	if (FAILED(buffer->Map(0, &readRange, (void**)&mapped)))
+		return false;
+
+	// Pack the rows, the last one can be cut
+	// short if the caller's buffer is too small.
+	mgint remaining = readback->copiedBytes;
+	mgbyte* dest = readback->packed.data();
+	for (UINT row = 0; row < readback->rows && remaining > 0; row++)
+	{
+		mgint count = std::min((mgint)readback->rowBytes, remaining);
+		memcpy(dest, mapped + ((size_t)row * readback->rowPitch), count);
+		dest += count;
+		remaining -= count;
+	}
+
+	CD3DX12_RANGE writeRange(0, 0);
+	buffer->Unmap(0, &writeRange);
+
+	data = readback->packed.data();
+	dataBytes = readback->copiedBytes;
+	return true;
+}
+
 static const LPCSTR MGVertexElementUsageToLPCSTR[] =
 {
 	"POSITION",
@@ -53,6 +53,7 @@ public:
     const UINT GetHeight() const { return impl->m_desc.Height; }
     const DXGI_SAMPLE_DESC& GetSampleDesc() const { return impl->m_desc.SampleDesc; }
     const DXGI_FORMAT& GetFormat() const { return impl->m_desc.Format; }
+    const D3D12_RESOURCE_STATES GetState() const { return impl->m_currentState; }
 
     const D3D12_CPU_DESCRIPTOR_HANDLE& GetSRV() const { return impl->m_srvHandle; }
     const D3D12_CPU_DESCRIPTOR_HANDLE& GetUAV(uint32_t mip) const { return impl->m_uavHandles[mip]; }
@@ -3,28 +3,886 @@
 // file 'LICENSE.txt', which is part of this source code package.
 
 #include "api_MGA.h"
+#include "api_MGM.h"
 
-#include "mg_common.h"
+#include "MGM_common.h"
+#include "MGA_common.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
-// TODO: Implement against the C++ API for FAudio.
+
+// Despite the name this doesn't use FAudio, which isn't in
+// external.  Voices are mixed in software into a float stereo
+// bus which goes to a sink, normally the SDL audio device.
+
+// Voices are mixed a block at a time and changes in
+// gain ramp across the block so they don't click.
+static const mgint MGA_MixFrames = 256;
+
+// How many voices are mixed by default, the rest are virtual.
+static const mgint MGA_DefaultVoiceBudget = 64;
+static const mgint MGA_MaxVoiceBudget = 1024;
+
+// Enough for thousands of changes between blocks,
+// past that the game side waits for the mixer.
+static const mgint MGA_CommandCount = 4096;
+
+// The param slot shared between the game and the
+// mixer, marked when the game has written to it.
+static const mgint MGA_ParamsIndex = 3;
+static const mgint MGA_ParamsFresh = 4;
+
+// How much more audible a voice already being mixed is
+// considered, so voices of about the same loudness
+// don't keep swapping in and out every block.
+static const mgfloat MGA_MixedBias = 1.25f;
+
+// How many voices Apply3DBatch works out at a time.
+static const mgint MGA_BatchVoices = 64;
+
+// The most source frames a voice can use for each output frame.
+static const mgfloat MGA_MaxRatio = 16.0f;
+
+static const mgfloat MGA_Pi = 3.14159265f;
+
+// Sample positions are 32.32 fixed point.
+static const mgulong MGA_FixedOne = 1ull << 32;
+static const mgulong MGA_FixedFraction = MGA_FixedOne - 1;
+
+
+// Audio appended to a streaming voice, which
+// are reused once they have been played.
+struct MGA_Chunk
+{
+	std::vector<mgshort> pcm;
+	mgint frames = 0;
+
+	// Set by the game side and cleared by the
+	// mixer once the chunk can be filled again.
+	std::atomic<bool> queued { false };
+
+	// The next chunk in the voice's queue.
+	MGA_Chunk* next = nullptr;
+};
+
+// Everything the game can set on a voice which
+// can be changed without restarting the sound.
+struct MGA_VoiceParams
+{
+	mgfloat volume = 1.0f;
+	mgfloat priority = 1.0f;
+	mgfloat pan = 0.0f;
+	mgfloat pitch = 0.0f;
+	mgfloat reverbMix = 0.0f;
+
+	// Set by Apply3D until the pan or pitch is set.
+	bool positional = false;
+	mgfloat attenuation = 1.0f;
+	mgfloat positionalPan = 0.0f;
+	mgfloat doppler = 1.0f;
+
+	bool filtered = false;
+	MGFilterMode filterMode = MGFilterMode::LowPass;
+	mgfloat filterFrequency = 0.0f;
+	mgfloat filterOneOverQ = 1.0f;
+};
+
+enum class MGA_CommandType : mgbyte
+{
+	AddVoice,
+	RemoveVoice,
+	SetBuffer,
+	AppendChunk,
+	Play,
+	Pause,
+	Resume,
+	Stop,
+	UpdateParams,
+	RemoveBuffer,
+	SetBudget,
+};
+
+struct MGA_Command
+{
+	MGA_CommandType type;
+	bool looped;
+	mguint value;
+	MGA_Voice* voice;
+
+	union
+	{
+		MGA_Buffer* buffer;
+		MGA_Chunk* chunk;
+	};
+};
 
 struct MGA_System
 {
+	MGA_Sink* sink = nullptr;
+	mgint sampleRate = 0;
+
+	// The game side of every voice and the write end of
+	// the commands.  The mixer never takes this, it only
+	// makes the many threads which call us one producer.
+	std::mutex mutex;
+	std::vector<MGA_Voice*> voices;
+
+	// Kept for MGA_System_SetReverbSettings, but the
+	// mix has no reverb so nothing reads it.
+	ReverbSettings reverb;
+
+	// Changes to the voices wait here until the mixer
+	// applies them at the start of its next block.
+	std::vector<MGA_Command> commands;
+	alignas(64) std::atomic<mgulong> writePos { 0 };
+	alignas(64) std::atomic<mgulong> readPos { 0 };
+
+	// What the mixer is done with, freed on the game side.
+	std::atomic<MGA_Voice*> retiredVoices { nullptr };
+	std::atomic<MGA_Buffer*> retiredBuffers { nullptr };
+
+	// From the last block.
+	std::atomic<mgint> playing { 0 };
+	std::atomic<mgint> mixed { 0 };
+
+	// Everything below is only touched by the mixer.
+
+	MGA_Voice* first = nullptr;
+
+	// One voice's block at the output rate.
+	std::vector<mgfloat> scratch;
+
+	// Only the most audible voices are mixed.
+	mgint budget = MGA_DefaultVoiceBudget;
+	std::vector<MGA_Voice*> audible;
 };
 
 struct MGA_Buffer
 {
+	MGA_System* system = nullptr;
+
+	// Decoded audio shared thru the PCM cache.
+	MGM_PCMBlock* block = nullptr;
+	MGM_AudioDecoderInfo blockInfo;
+
+	// Or decoded audio owned by the buffer.
+	MGA_Wave wave;
+
+	const mgshort* pcm = nullptr;
+	mgint frames = 0;
+	mgint channels = 0;
+	mgint sampleRate = 0;
+
+	mgint loopStart = 0;
+	mgint loopLength = 0;
+
+	MGA_Buffer* retiredNext = nullptr;
 };
 
 struct MGA_Voice
 {
+	MGA_System* system = nullptr;
+
+	// The format of appended audio.
+	mgint channels = 0;
+	mgint sampleRate = 0;
+
+	// What the game has asked for, guarded by the system mutex.
+	struct
+	{
+		MGA_Buffer* buffer = nullptr;
+		MGSoundState state = MGSoundState::Stopped;
+		bool looped = false;
+
+		// Counts the plays so we know which one ended.
+		mguint play = 0;
+
+		// Chunks ever appended and how many
+		// of those were before the last stop.
+		mgulong appended = 0;
+		mgulong flushed = 0;
+
+		MGA_VoiceParams params;
+		std::vector<MGA_Chunk*> chunks;
+	} game;
+
+	// Published by the mixer for the game side.
+	std::atomic<mguint> ended { 0 };
+	std::atomic<mgulong> released { 0 };
+	std::atomic<mgulong> position { 0 };
+
+	// The latest params go to the mixer thru three copies
+	// so neither side waits on the other, and only one
+	// command for them is ever queued.  Any changes made
+	// before the mixer gets to it are picked up with it.
+	MGA_VoiceParams paramSlots[3];
+	std::atomic<mgint> paramShared { 1 };
+	mgint paramBack = 0;
+	mgint paramFront = 2;
+	std::atomic<bool> paramsQueued { false };
+
+	// Everything below is only touched by the mixer.
+
+	MGA_Voice* prev = nullptr;
+	MGA_Voice* next = nullptr;
+
+	MGA_Buffer* buffer = nullptr;
+	MGA_Chunk* head = nullptr;
+	MGA_Chunk* tail = nullptr;
+
+	MGSoundState state = MGSoundState::Stopped;
+	bool looped = false;
+	mguint play = 0;
+
+	// Where we are in the buffer or the first chunk in the queue.
+	mgulong cursor = 0;
+
+	// The frames of the chunks already played.
+	mgulong consumed = 0;
+
+	MGA_VoiceParams params;
+	mgfloat filterLow[2] = {};
+	mgfloat filterBand[2] = {};
+
+	// The gains the last block ended on.
+	mgfloat gains[4] = {};
+	bool ramped = false;
+
+	// Virtual voices aren't mixed, they only keep their place.
+	bool mixed = false;
+	bool wasMixed = false;
+	mgfloat audibility = 0.0f;
+
+	MGA_Voice* retiredNext = nullptr;
 };
 
 
+static void MGA_Voice_PanMatrix(mgfloat pan, mgfloat scale, mgint channels, mgfloat matrix[4])
+{
+	pan = std::min(std::max(pan, -1.0f), 1.0f);
+
+	if (channels == 1)
+	{
+		matrix[0] = (pan > 0.0f ? 1.0f - pan : 1.0f) * scale;	// Left
+		matrix[1] = (pan < 0.0f ? 1.0f + pan : 1.0f) * scale;	// Right
+		matrix[2] = 0.0f;
+		matrix[3] = 0.0f;
+	}
+	else if (pan <= 0.0f)
+	{
+		matrix[0] = (0.5f * pan + 1.0f) * scale;	// .5 when pan is -1, 1 when pan is 0
+		matrix[1] = (0.5f * -pan) * scale;			// .5 when pan is -1, 0 when pan is 0
+		matrix[2] = 0.0f;							//  0 when pan is -1, 0 when pan is 0
+		matrix[3] = (pan + 1.0f) * scale;			//  0 when pan is -1, 1 when pan is 0
+	}
+	else
+	{
+		matrix[0] = (-pan + 1.0f) * scale;			//  1 when pan is 0,   0 when pan is 1
+		matrix[1] = 0.0f;							//  0 when pan is 0,   0 when pan is 1
+		matrix[2] = (0.5f * pan) * scale;			//  0 when pan is 0, .5f when pan is 1
+		matrix[3] = (0.5f * -pan + 1.0f) * scale;	//  1 when pan is 0. .5f when pan is 1
+	}
+}
+
+// Resamples with linear interpolation until the cursor reaches
+// the end frame.  The next frame is the one which follows the
+// end or null to hold the last frame.  Returns the frames written.
+static mgint MGA_Voice_Resample(const mgshort* pcm, mgint channels, mgint end, const mgshort* next, mgulong& cursor, mgulong step, mgfloat* out, mgint count)
+{
+	auto frame = (mgint)(cursor >> 32);
+	if (frame >= end)
+		return 0;
+
+	// At the source rate it is only a conversion.
+	if (step == MGA_FixedOne && (cursor & MGA_FixedFraction) == 0)
+	{
+		auto written = std::min(count, end - frame);
+		MGA_Mix_ToFloat(pcm + ((mglong)frame * channels), written * channels, out);
+		cursor += (mgulong)written << 32;
+		return written;
+	}
+
+	const auto scale = 1.0f / 32768.0f;
+	const auto fractionScale = 1.0f / (mgfloat)MGA_FixedOne;
+
+	mgint written = 0;
+	for (; written < count; written++)
+	{
+		frame = (mgint)(cursor >> 32);
+		if (frame >= end)
+			break;
+
+		auto a = pcm + ((mglong)frame * channels);
+		auto b = frame + 1 < end ? a + channels : (next != nullptr ? next : a);
+		auto t = (cursor & MGA_FixedFraction) * fractionScale;
+
+		for (mgint c = 0; c < channels; c++)
+			out[(written * channels) + c] = (a[c] + ((b[c] - a[c]) * t)) * scale;
+
+		cursor += step;
+	}
+
+	return written;
+}
+
+// Hands the first chunk in the queue back to the game side.
+static void MGA_Voice_ReleaseChunk(MGA_Voice* voice)
+{
+	auto chunk = voice->head;
+	voice->head = chunk->next;
+	if (voice->head == nullptr)
+		voice->tail = nullptr;
+
+	chunk->next = nullptr;
+	chunk->queued.store(false, std::memory_order_release);
+	voice->released.fetch_add(1, std::memory_order_release);
+}
+
+// Stops a voice which played to the end of its buffer.
+static void MGA_Voice_Finish(MGA_Voice* voice)
+{
+	voice->state = MGSoundState::Stopped;
+	voice->cursor = 0;
+	voice->ended.store(voice->play, std::memory_order_release);
+}
+
+// Fills the scratch with the next frames of the voice and
+// returns how many there were, which is short at the end.
+static mgint MGA_Voice_Read(MGA_Voice* voice, mgint channels, mgulong step, mgfloat* out, mgint frames)
+{
+	mgint done = 0;
+
+	while (done < frames)
+	{
+		auto buffer = voice->buffer;
+		if (buffer != nullptr)
+		{
+			auto loopEnd = buffer->loopStart + buffer->loopLength;
+			auto end = voice->looped ? loopEnd : buffer->frames;
+			auto next = voice->looped ? buffer->pcm + ((mglong)buffer->loopStart * channels) : nullptr;
+
+			done += MGA_Voice_Resample(buffer->pcm, channels, end, next, voice->cursor, step, out + (done * channels), frames - done);
+			if (done == frames)
+				break;
+
+			if (!voice->looped)
+			{
+				MGA_Voice_Finish(voice);
+				break;
+			}
+
+			voice->cursor -= (mgulong)buffer->loopLength << 32;
+		}
+		else
+		{
+			// Streaming voices keep playing when
+			// starved, waiting for more audio.
+			auto chunk = voice->head;
+			if (chunk == nullptr)
+				break;
+
+			auto next = chunk->next != nullptr ? chunk->next->pcm.data() : nullptr;
+
+			done += MGA_Voice_Resample(chunk->pcm.data(), channels, chunk->frames, next, voice->cursor, step, out + (done * channels), frames - done);
+			if (done == frames)
+				break;
+
+			voice->cursor -= (mgulong)chunk->frames << 32;
+			voice->consumed += chunk->frames;
+			MGA_Voice_ReleaseChunk(voice);
+		}
+	}
+
+	return done;
+}
+
+// The state variable filter XAudio2 uses.
+static void MGA_Voice_Filter(MGA_Voice* voice, mgint channels, mgint sampleRate, mgfloat* samples, mgint frames)
+{
+	auto frequency = std::min(voice->params.filterFrequency, sampleRate * 0.5f);
+	auto f = std::min(2.0f * sinf(MGA_Pi * frequency / sampleRate), 1.0f);
+	auto q = voice->params.filterOneOverQ;
+
+	for (mgint c = 0; c < channels; c++)
+	{
+		auto low = voice->filterLow[c];
+		auto band = voice->filterBand[c];
+
+		for (mgint i = 0; i < frames; i++)
+		{
+			auto& sample = samples[(i * channels) + c];
+
+			low += f * band;
+			auto high = sample - low - (q * band);
+			band += f * high;
+
+			switch (voice->params.filterMode)
+			{
+			case MGFilterMode::LowPass:
+				sample = low;
+				break;
+			case MGFilterMode::BandPass:
+				sample = band;
+				break;
+			case MGFilterMode::HighPass:
+				sample = high;
+				break;
+			}
+		}
+
+		voice->filterLow[c] = low;
+		voice->filterBand[c] = band;
+	}
+}
+
+// Returns false if the voice has nothing to play.
+static bool MGA_Voice_GetFormat(MGA_System* system, MGA_Voice* voice, mgint& channels, mgulong& step)
+{
+	if (voice->state != MGSoundState::Playing)
+		return false;
+
+	auto buffer = voice->buffer;
+	auto sampleRate = buffer != nullptr ? buffer->sampleRate : voice->sampleRate;
+	channels = buffer != nullptr ? buffer->channels : voice->channels;
+	if (channels == 0 || sampleRate == 0)
+		return false;
+
+	auto ratio = ((mgfloat)sampleRate / system->sampleRate) * powf(2.0f, voice->params.pitch) * voice->params.doppler;
+	ratio = std::min(std::max(ratio, 1.0f / MGA_MaxRatio), MGA_MaxRatio);
+	step = (mgulong)((mgdouble)ratio * MGA_FixedOne);
+	return true;
+}
+
+// Moves a virtual voice along as if it had been mixed.
+static void MGA_Voice_Skip(MGA_System* system, MGA_Voice* voice, mgint frames)
+{
+	mgint channels;
+	mgulong step;
+	if (!MGA_Voice_GetFormat(system, voice, channels, step))
+		return;
+
+	// Fade in from silence if it gets mixed again.
+	memset(voice->gains, 0, sizeof(voice->gains));
+	voice->ramped = true;
+
+	voice->cursor += step * frames;
+
+	auto buffer = voice->buffer;
+	if (buffer != nullptr)
+	{
+		auto end = voice->looped ? buffer->loopStart + buffer->loopLength : buffer->frames;
+		if ((mgint)(voice->cursor >> 32) < end)
+			return;
+
+		if (!voice->looped)
+		{
+			MGA_Voice_Finish(voice);
+			return;
+		}
+
+		auto loopStart = (mgulong)buffer->loopStart << 32;
+		auto loopLength = (mgulong)buffer->loopLength << 32;
+		voice->cursor = loopStart + ((voice->cursor - loopStart) % loopLength);
+		return;
+	}
+
+	while (voice->head != nullptr)
+	{
+		auto chunk = voice->head;
+		if ((mgint)(voice->cursor >> 32) < chunk->frames)
+			return;
+
+		voice->cursor -= (mgulong)chunk->frames << 32;
+		voice->consumed += chunk->frames;
+		MGA_Voice_ReleaseChunk(voice);
+	}
+
+	// Starved, so wait at the start of the next chunk.
+	voice->cursor = 0;
+}
+
+// Mixes the voice into the bus, fading it out
+// when it is about to become a virtual voice.
+static void MGA_Voice_Render(MGA_System* system, MGA_Voice* voice, mgfloat* bus, mgint frames, bool fadeOut)
+{
+	mgint channels;
+	mgulong step;
+	if (!MGA_Voice_GetFormat(system, voice, channels, step))
+		return;
+
+	auto scratch = system->scratch.data();
+	auto done = MGA_Voice_Read(voice, channels, step, scratch, frames);
+	if (done == 0)
+		return;
+
+	auto& params = voice->params;
+	if (params.filtered)
+		MGA_Voice_Filter(voice, channels, system->sampleRate, scratch, done);
+
+	mgfloat target[4];
+	auto pan = params.positional ? params.positionalPan : params.pan;
+	MGA_Voice_PanMatrix(pan, fadeOut ? 0.0f : params.volume * params.attenuation, channels, target);
+
+	// Start at the right gains, then ramp to changes.
+	if (!voice->ramped)
+	{
+		memcpy(voice->gains, target, sizeof(target));
+		voice->ramped = true;
+	}
+
+	mgfloat steps[4];
+	for (mgint i = 0; i < 4; i++)
+		steps[i] = (target[i] - voice->gains[i]) / done;
+
+	if (channels == 1)
+		MGA_Mix_Mono(scratch, done, voice->gains, steps, bus);
+	else
+		MGA_Mix_Stereo(scratch, done, voice->gains, steps, bus);
+
+	memcpy(voice->gains, target, sizeof(target));
+}
+
+// Picks the most audible of the playing voices to mix.
+static void MGA_System_PickVoices(MGA_System* system)
+{
+	// The least audible of those picked so far is on top.
+	auto moreAudible = [](MGA_Voice* a, MGA_Voice* b)
+	{
+		return a->audibility > b->audibility;
+	};
+
+	auto& audible = system->audible;
+	audible.clear();
+	mgint playing = 0;
+
+	for (auto voice = system->first; voice != nullptr; voice = voice->next)
+	{
+		voice->wasMixed = voice->mixed;
+		voice->mixed = false;
+
+		if (voice->state != MGSoundState::Playing)
+			continue;
+
+		playing++;
+
+		// Silent voices are never worth mixing.
+		auto& params = voice->params;
+		voice->audibility = fabsf(params.volume) * params.attenuation * params.priority;
+		if (voice->audibility <= 0.0f || system->budget == 0)
+			continue;
+
+		if (voice->wasMixed)
+			voice->audibility *= MGA_MixedBias;
+
+		// This never grows past the budget, so it never allocates.
+		if ((mgint)audible.size() < system->budget)
+		{
+			audible.push_back(voice);
+			std::push_heap(audible.begin(), audible.end(), moreAudible);
+		}
+		else if (voice->audibility > audible.front()->audibility)
+		{
+			std::pop_heap(audible.begin(), audible.end(), moreAudible);
+			audible.back() = voice;
+			std::push_heap(audible.begin(), audible.end(), moreAudible);
+		}
+	}
+
+	for (auto voice : audible)
+		voice->mixed = true;
+
+	system->playing.store(playing, std::memory_order_relaxed);
+	system->mixed.store((mgint)audible.size(), std::memory_order_relaxed);
+}
+
+static void MGA_Voice_PublishPosition(MGA_Voice* voice)
+{
+	auto sampleRate = voice->buffer != nullptr ? voice->buffer->sampleRate : voice->sampleRate;
+	auto frames = voice->consumed + (voice->cursor >> 32);
+	voice->position.store(sampleRate > 0 ? frames * 1000 / sampleRate : 0, std::memory_order_relaxed);
+}
+
+static void MGA_Voice_Flush(MGA_Voice* voice)
+{
+	voice->state = MGSoundState::Stopped;
+	voice->cursor = 0;
+	voice->consumed = 0;
+
+	while (voice->head != nullptr)
+		MGA_Voice_ReleaseChunk(voice);
+
+	MGA_Voice_PublishPosition(voice);
+}
+
+static void MGA_Voice_Start(MGA_Voice* voice, mguint play, bool looped)
+{
+	voice->play = play;
+
+	auto buffer = voice->buffer;
+	if (buffer != nullptr)
+	{
+		voice->cursor = 0;
+		voice->looped = looped;
+		MGA_Voice_PublishPosition(voice);
+	}
+
+	voice->state = MGSoundState::Playing;
+	voice->ramped = false;
+
+	memset(voice->filterLow, 0, sizeof(voice->filterLow));
+	memset(voice->filterBand, 0, sizeof(voice->filterBand));
+}
+
+// Takes the newest params if the game has written any.
+static void MGA_Voice_TakeParams(MGA_Voice* voice)
+{
+	// Clear this first, so anything set after we look
+	// at the slots is sure to queue another command.
+	voice->paramsQueued.store(false);
+
+	if ((voice->paramShared.load() & MGA_ParamsFresh) == 0)
+		return;
+
+	voice->paramFront = voice->paramShared.exchange(voice->paramFront) & MGA_ParamsIndex;
+	voice->params = voice->paramSlots[voice->paramFront];
+}
+
+// The game side frees these once we let go of them.
+
+static void MGA_System_RetireVoice(MGA_System* system, MGA_Voice* voice)
+{
+	voice->retiredNext = system->retiredVoices.load(std::memory_order_relaxed);
+	while (!system->retiredVoices.compare_exchange_weak(voice->retiredNext, voice, std::memory_order_release, std::memory_order_relaxed));
+}
+
+static void MGA_System_RetireBuffer(MGA_System* system, MGA_Buffer* buffer)
+{
+	buffer->retiredNext = system->retiredBuffers.load(std::memory_order_relaxed);
+	while (!system->retiredBuffers.compare_exchange_weak(buffer->retiredNext, buffer, std::memory_order_release, std::memory_order_relaxed));
+}
+
+static void MGA_System_Apply(MGA_System* system, const MGA_Command& command)
+{
+	auto voice = command.voice;
+
+	switch (command.type)
+	{
+	case MGA_CommandType::AddVoice:
+		voice->next = system->first;
+		if (system->first != nullptr)
+			system->first->prev = voice;
+		system->first = voice;
+		break;
+
+	case MGA_CommandType::RemoveVoice:
+		MGA_Voice_Flush(voice);
+		if (voice->prev != nullptr)
+			voice->prev->next = voice->next;
+		else
+			system->first = voice->next;
+		if (voice->next != nullptr)
+			voice->next->prev = voice->prev;
+		MGA_System_RetireVoice(system, voice);
+		break;
+
+	case MGA_CommandType::SetBuffer:
+		MGA_Voice_Flush(voice);
+		voice->buffer = command.buffer;
+		break;
+
+	case MGA_CommandType::AppendChunk:
+		if (voice->tail != nullptr)
+			voice->tail->next = command.chunk;
+		else
+			voice->head = command.chunk;
+		voice->tail = command.chunk;
+		break;
+
+	case MGA_CommandType::Play:
+		MGA_Voice_Start(voice, command.value, command.looped);
+		break;
+
+	case MGA_CommandType::Pause:
+		if (voice->state == MGSoundState::Playing)
+			voice->state = MGSoundState::Paused;
+		break;
+
+	case MGA_CommandType::Resume:
+		if (voice->state == MGSoundState::Paused)
+			voice->state = MGSoundState::Playing;
+		break;
+
+	case MGA_CommandType::Stop:
+		MGA_Voice_Flush(voice);
+		break;
+
+	case MGA_CommandType::UpdateParams:
+		MGA_Voice_TakeParams(voice);
+		break;
+
+	case MGA_CommandType::RemoveBuffer:
+		for (auto other = system->first; other != nullptr; other = other->next)
+		{
+			if (other->buffer != command.buffer)
+				continue;
+
+			MGA_Voice_Flush(other);
+			other->buffer = nullptr;
+		}
+		MGA_System_RetireBuffer(system, command.buffer);
+		break;
+
+	case MGA_CommandType::SetBudget:
+		system->budget = (mgint)command.value;
+		break;
+	}
+}
+
+// Applies everything the game side has queued, without
+// ever waiting on it, at the start of each block.
+static void MGA_System_ApplyCommands(MGA_System* system)
+{
+	auto read = system->readPos.load(std::memory_order_relaxed);
+	auto write = system->writePos.load(std::memory_order_acquire);
+
+	for (; read != write; read++)
+		MGA_System_Apply(system, system->commands[read % MGA_CommandCount]);
+
+	system->readPos.store(read, std::memory_order_release);
+}
+
+static void MGA_System_Render(void* data, mgfloat* output, mgint frames)
+{
+	auto system = (MGA_System*)data;
+
+	while (frames > 0)
+	{
+		auto count = std::min(frames, MGA_MixFrames);
+		memset(output, 0, (size_t)count * MGA_OUTPUT_CHANNELS * sizeof(mgfloat));
+
+		MGA_System_ApplyCommands(system);
+		MGA_System_PickVoices(system);
+
+		for (auto voice = system->first; voice != nullptr; voice = voice->next)
+		{
+			if (voice->state != MGSoundState::Playing)
+				continue;
+
+			if (voice->mixed || voice->wasMixed)
+				MGA_Voice_Render(system, voice, output, count, !voice->mixed);
+			else
+				MGA_Voice_Skip(system, voice, count);
+
+			MGA_Voice_PublishPosition(voice);
+		}
+
+		MGA_Mix_Clamp(output, count * MGA_OUTPUT_CHANNELS);
+
+		output += count * MGA_OUTPUT_CHANNELS;
+		frames -= count;
+	}
+}
+
+static MGA_Sink* MGA_System_CreateSink()
+{
+	// Lets tests and headless machines pick where
+	// the mix goes, either "null" or "file:<path>".
+	auto name = getenv("MONOGAME_AUDIO_SINK");
+	if (name != nullptr)
+	{
+		if (strcmp(name, "null") == 0)
+			return MGA_Sink_CreateNull();
+
+		if (strncmp(name, "file:", 5) == 0)
+		{
+			auto sink = MGA_Sink_CreateFile(name + 5);
+			if (sink != nullptr)
+				return sink;
+		}
+	}
+
+#if defined(MG_SDL2)
+	auto sink = MGA_Sink_CreateSDL();
+	if (sink != nullptr)
+		return sink;
+#endif
+
+	// Without a device sounds still play and finish, just silently.
+	return MGA_Sink_CreateNull();
+}
+
+
+// Queues a change for the mixer with the system mutex held.
+static void MGA_System_Push(MGA_System* system, const MGA_Command& command)
+{
+	auto write = system->writePos.load(std::memory_order_relaxed);
+
+	// Only the game side waits, and only when
+	// it has made thousands of changes in a block.
+	while (write - system->readPos.load(std::memory_order_acquire) >= MGA_CommandCount)
+		std::this_thread::yield();
+
+	system->commands[write % MGA_CommandCount] = command;
+	system->writePos.store(write + 1, std::memory_order_release);
+}
+
+static void MGA_System_Push(MGA_System* system, MGA_CommandType type, MGA_Voice* voice)
+{
+	MGA_Command command = {};
+	command.type = type;
+	command.voice = voice;
+	MGA_System_Push(system, command);
+}
+
+// Frees what the mixer has let go of with the system mutex held.
+static void MGA_System_FreeRetired(MGA_System* system)
+{
+	auto voice = system->retiredVoices.exchange(nullptr, std::memory_order_acquire);
+	while (voice != nullptr)
+	{
+		auto next = voice->retiredNext;
+
+		for (auto chunk : voice->game.chunks)
+			delete chunk;
+
+		delete voice;
+		voice = next;
+	}
+
+	auto buffer = system->retiredBuffers.exchange(nullptr, std::memory_order_acquire);
+	while (buffer != nullptr)
+	{
+		auto next = buffer->retiredNext;
+
+		if (buffer->block)
+			MGM_PCMCache_Release(buffer->block);
+
+		delete buffer;
+		buffer = next;
+	}
+}
+
+
 MGA_System* MGA_System_Create()
 {
 	auto system = new MGA_System();
+	memset(&system->reverb, 0, sizeof(system->reverb));
+
+	system->sink = MGA_System_CreateSink();
+	system->sampleRate = system->sink->sampleRate;
+	system->scratch.resize(MGA_MixFrames * 2);
+	system->audible.reserve(MGA_MaxVoiceBudget);
+	system->commands.resize(MGA_CommandCount);
+
+	system->sink->Start(MGA_System_Render, system);
+
 	return system;
 }
 
@@ -32,6 +890,13 @@ void MGA_System_Destroy(MGA_System* system)
 {
 	assert(system != nullptr);
 
+	// This stops the mixing.
+	delete system->sink;
+
+	// Let go of anything destroyed since the last block.
+	MGA_System_ApplyCommands(system);
+	MGA_System_FreeRetired(system);
+
 	// TODO: We're assuming here the C# side is cleaning up
 	// buffers/voices, but if we want this to be a good C++
 	// API as well, we likely should cleanup ourselves too.
@@ -41,25 +906,101 @@ void MGA_System_Destroy(MGA_System* system)
 
 mgint MGA_System_GetMaxInstances()
 {
+	// Only the voice budget is ever mixed, the
+	// rest are virtual and cost next to nothing.
 	return INT_MAX;
 }
 
 void MGA_System_SetReverbSettings(MGA_System* system, ReverbSettings& settings)
 {
 	assert(system != nullptr);
+
+	std::lock_guard<std::mutex> lock(system->mutex);
+	system->reverb = settings;
+}
+
+void MGA_System_SetVoiceBudget(MGA_System* system, mgint voices)
+{
+	assert(system != nullptr);
+
+	MGA_Command command = {};
+	command.type = MGA_CommandType::SetBudget;
+	command.value = (mguint)std::min(std::max(voices, 0), MGA_MaxVoiceBudget);
+
+	std::lock_guard<std::mutex> lock(system->mutex);
+	MGA_System_Push(system, command);
+}
+
+void MGA_System_GetVoiceStats(MGA_System* system, mgint& playing, mgint& mixed)
+{
+	assert(system != nullptr);
+
+	playing = system->playing.load(std::memory_order_relaxed);
+	mixed = system->mixed.load(std::memory_order_relaxed);
 }
 
 MGA_Buffer* MGA_Buffer_Create(MGA_System* system)
 {
 	assert(system != nullptr);
 	auto buffer = new MGA_Buffer();
+	buffer->system = system;
+
+	std::lock_guard<std::mutex> lock(system->mutex);
+	MGA_System_FreeRetired(system);
+
 	return buffer;
 }
 
 void MGA_Buffer_Destroy(MGA_Buffer* buffer)
 {
 	assert(buffer != nullptr);
-	delete buffer;
+
+	auto system = buffer->system;
+	std::lock_guard<std::mutex> lock(system->mutex);
+
+	// Stop anything still playing it.
+	for (auto voice : system->voices)
+	{
+		if (voice->game.buffer != buffer)
+			continue;
+
+		voice->game.buffer = nullptr;
+		voice->game.state = MGSoundState::Stopped;
+	}
+
+	// The mixer frees it once it is done with it.
+	MGA_Command command = {};
+	command.type = MGA_CommandType::RemoveBuffer;
+	command.buffer = buffer;
+	MGA_System_Push(system, command);
+}
+
+static void MGA_Buffer_Setup(MGA_Buffer* buffer, const mgshort* pcm, mguint samples, mgint channels, mgint sampleRate, mgint loopStart, mgint loopLength)
+{
+	buffer->pcm = pcm;
+	buffer->channels = channels;
+	buffer->sampleRate = sampleRate;
+	buffer->frames = channels > 0 ? samples / channels : 0;
+
+	// No loop means looping the whole buffer.
+	if (loopStart < 0 || loopStart >= buffer->frames || loopLength <= 0)
+	{
+		loopStart = 0;
+		loopLength = buffer->frames;
+	}
+
+	buffer->loopStart = loopStart;
+	buffer->loopLength = std::min(loopLength, buffer->frames - loopStart);
+}
+
+static void MGA_Buffer_SetupWave(MGA_Buffer* buffer, bool decoded, mgint loopStart, mgint loopLength)
+{
+	// Formats we can't decode are silent.
+	if (!decoded)
+		buffer->wave.pcm.clear();
+
+	auto& wave = buffer->wave;
+	MGA_Buffer_Setup(buffer, wave.pcm.data(), (mguint)wave.pcm.size(), wave.channels, wave.sampleRate, loopStart, loopLength);
 }
 
 void MGA_Buffer_InitializeFormat(MGA_Buffer* buffer, mgbyte* waveHeader, mgbyte* waveData, mgint length, mgint loopStart, mgint loopLength)
@@ -68,6 +1009,9 @@ void MGA_Buffer_InitializeFormat(MGA_Buffer* buffer, mgbyte* waveHeader, mgbyte*
 	assert(waveHeader != nullptr);
 	assert(waveData != nullptr);
 	assert(length > 0);
+
+	auto decoded = MGA_Wave_DecodeFormat(buffer->wave, waveHeader, waveData, length);
+	MGA_Buffer_SetupWave(buffer, decoded, loopStart, loopLength);
 }
 
 void MGA_Buffer_InitializePCM(MGA_Buffer* buffer, mgbyte* waveData, mgint offset, mgint length, mgint sampleBits, mgint sampleRate, mgint channels, mgint loopStart, mgint loopLength)
@@ -76,6 +1020,13 @@ void MGA_Buffer_InitializePCM(MGA_Buffer* buffer, mgbyte* waveData, mgint offset
 	assert(waveData != nullptr);
 	assert(offset >=0);
 	assert(length > 0);
+
+	auto& wave = buffer->wave;
+	wave.channels = channels;
+	wave.sampleRate = sampleRate;
+
+	auto decoded = channels >= 1 && channels <= 2 && MGA_Wave_DecodePCM(wave, waveData + offset, length, sampleBits);
+	MGA_Buffer_SetupWave(buffer, decoded, loopStart, loopLength);
 }
 
 void MGA_Buffer_InitializeXact(MGA_Buffer* buffer, mguint codec, mgbyte* waveData, mgint length, mgint sampleRate, mgint blockAlignment, mgint channels, mgint loopStart, mgint loopLength)
@@ -83,44 +1034,132 @@ void MGA_Buffer_InitializeXact(MGA_Buffer* buffer, mguint codec, mgbyte* waveDat
 	assert(buffer != nullptr);
 	assert(waveData != nullptr);
 	assert(length > 0);
+
+	auto& wave = buffer->wave;
+	wave.channels = channels;
+	wave.sampleRate = sampleRate;
+
+	// Only ADPCM comes here, PCM is handled in C# and
+	// the others need platform specific decoders.
+	auto decoded =
+		codec == 0x2 &&
+		channels >= 1 && channels <= 2 &&
+		MGA_Wave_DecodeMSADPCM(wave, waveData, length, blockAlignment);
+
+	MGA_Buffer_SetupWave(buffer, decoded, loopStart, loopLength);
+}
+
+void MGA_Buffer_InitializeCached(MGA_Buffer* buffer, MGM_PCMBlock* block)
+{
+	assert(buffer != nullptr);
+	assert(block != nullptr);
+	assert(buffer->block == nullptr);
+
+	MGM_PCMBlock_AddRef(block, buffer->blockInfo);
+	auto& info = buffer->blockInfo;
+
+	// The mixer only takes mono or stereo, so anything
+	// else like a 5.1 Ogg is silent as with the waves.
+	if (info.channels < 1 || info.channels > 2)
+	{
+		MGM_PCMCache_Release(block);
+		MGA_Buffer_Setup(buffer, nullptr, 0, 0, info.samplerate, 0, 0);
+		return;
+	}
+
+	buffer->block = block;
+
+	mgbyte* data;
+	mguint size;
+	MGM_PCMBlock_GetData(block, data, size);
+
+	MGA_Buffer_Setup(buffer, (const mgshort*)data, size / sizeof(mgshort), info.channels, info.samplerate, 0, 0);
 }
 
 mgulong MGA_Buffer_GetDuration(MGA_Buffer* buffer)
 {
 	assert(buffer != nullptr);
-	return 0;
+
+	if (buffer->sampleRate == 0)
+		return 0;
+
+	return (mgulong)buffer->frames * 1000 / buffer->sampleRate;
 }
 
 MGA_Voice* MGA_Voice_Create(MGA_System* system, mgint sampleRate, mgint channels)
 {
 	assert(system != nullptr);
 	auto voice = new MGA_Voice();
+	voice->system = system;
+	voice->sampleRate = sampleRate;
+	voice->channels = channels >= 1 && channels <= 2 ? channels : 0;
+
+	std::lock_guard<std::mutex> lock(system->mutex);
+	MGA_System_FreeRetired(system);
+
+	system->voices.push_back(voice);
+	MGA_System_Push(system, MGA_CommandType::AddVoice, voice);
+
 	return voice;
 }
 
 void MGA_Voice_Destroy(MGA_Voice* voice)
 {
 	assert(voice != nullptr);
-	delete voice;
+
+	auto system = voice->system;
+	std::lock_guard<std::mutex> lock(system->mutex);
+
+	auto& voices = system->voices;
+	voices.erase(std::remove(voices.begin(), voices.end(), voice), voices.end());
+
+	// The mixer frees it once it is done with it.
+	MGA_System_Push(system, MGA_CommandType::RemoveVoice, voice);
+}
+
+// Catches up with voices which played to the end
+// since we last looked, with the system mutex held.
+static MGSoundState MGA_Voice_UpdateState(MGA_Voice* voice)
+{
+	auto& game = voice->game;
+	if (game.state != MGSoundState::Stopped && voice->ended.load(std::memory_order_acquire) == game.play)
+		game.state = MGSoundState::Stopped;
+
+	return game.state;
 }
 
 mgint MGA_Voice_GetBufferCount(MGA_Voice* voice)
 {
 	assert(voice != nullptr);
-	return 0;
+
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+
+	auto& game = voice->game;
+	if (game.buffer != nullptr)
+		return MGA_Voice_UpdateState(voice) == MGSoundState::Stopped ? 0 : 1;
+
+	// Chunks from before a stop are gone even
+	// if the mixer hasn't got to them yet.
+	auto released = std::max(voice->released.load(std::memory_order_acquire), game.flushed);
+	return (mgint)(game.appended - released);
 }
 
 void MGA_Voice_SetBuffer(MGA_Voice* voice, MGA_Buffer* buffer)
 {
 	assert(voice != nullptr);
 
-	// Stop and remove any pending buffers first.
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
 
-	// Append a buffer if we got one.
-	if (buffer)
-	{
+	// Stop and remove any pending buffers first.
+	voice->game.buffer = buffer;
+	voice->game.state = MGSoundState::Stopped;
+	voice->game.flushed = voice->game.appended;
 
-	}
+	MGA_Command command = {};
+	command.type = MGA_CommandType::SetBuffer;
+	command.voice = voice;
+	command.buffer = buffer;
+	MGA_System_Push(voice->system, command);
 }
 
 void MGA_Voice_AppendBuffer(MGA_Voice* voice, mgbyte* buffer, mguint size)
@@ -128,78 +1167,266 @@ void MGA_Voice_AppendBuffer(MGA_Voice* voice, mgbyte* buffer, mguint size)
 	assert(voice != nullptr);
 	assert(buffer != nullptr);
 
-	// The idea here is that for streaming cases and dynamic buffers
-	// we internally allocate a big chunk of memory for it and
-	// break it up into smaller buffers for submission.
-		
-	// Allocate a dynamic buffer that can be reused later.	
-	// Append the buffer.
+	auto frameBytes = voice->channels * sizeof(mgshort);
+	if (frameBytes == 0 || size < frameBytes)
+		return;
+
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+
+	// Reuse a chunk the mixer is done with.
+	auto& chunks = voice->game.chunks;
+	auto found = std::find_if(chunks.begin(), chunks.end(), [](MGA_Chunk* chunk)
+	{
+		return !chunk->queued.load(std::memory_order_acquire);
+	});
+
+	MGA_Chunk* chunk;
+	if (found != chunks.end())
+		chunk = *found;
+	else
+	{
+		chunk = new MGA_Chunk();
+		chunks.push_back(chunk);
+	}
+
+	chunk->frames = (mgint)(size / frameBytes);
+	chunk->pcm.assign((const mgshort*)buffer, (const mgshort*)buffer + ((size_t)chunk->frames * voice->channels));
+	chunk->queued.store(true, std::memory_order_relaxed);
+
+	voice->game.appended++;
+
+	MGA_Command command = {};
+	command.type = MGA_CommandType::AppendChunk;
+	command.voice = voice;
+	command.chunk = chunk;
+	MGA_System_Push(voice->system, command);
+}
+
+static void MGA_Voice_QueuePlay(MGA_Voice* voice, bool looped)
+{
+	auto& game = voice->game;
+	game.looped = looped;
+
+	// An empty buffer is done before it starts.
+	if (game.buffer != nullptr && game.buffer->frames == 0)
+		return;
+
+	game.state = MGSoundState::Playing;
+	game.play++;
+
+	MGA_Command command = {};
+	command.type = MGA_CommandType::Play;
+	command.voice = voice;
+	command.looped = looped;
+	command.value = game.play;
+	MGA_System_Push(voice->system, command);
 }
 
 void MGA_Voice_Play(MGA_Voice* voice, mgbyte looped)
 {
 	assert(voice != nullptr);
+
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+	MGA_Voice_QueuePlay(voice, looped != 0);
 }
 
 void MGA_Voice_Pause(MGA_Voice* voice)
 {
 	assert(voice != nullptr);
+
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+
+	if (MGA_Voice_UpdateState(voice) != MGSoundState::Playing)
+		return;
+
+	voice->game.state = MGSoundState::Paused;
+	MGA_System_Push(voice->system, MGA_CommandType::Pause, voice);
 }
 
 void MGA_Voice_Resume(MGA_Voice* voice)
 {
 	assert(voice != nullptr);
+
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+
+	auto state = MGA_Voice_UpdateState(voice);
+	if (state == MGSoundState::Paused)
+	{
+		voice->game.state = MGSoundState::Playing;
+		MGA_System_Push(voice->system, MGA_CommandType::Resume, voice);
+	}
+	else if (state == MGSoundState::Stopped)
+		MGA_Voice_QueuePlay(voice, voice->game.looped);
 }
 
 void MGA_Voice_Stop(MGA_Voice* voice, mgbyte immediate)
 {
 	assert(voice != nullptr);
+
+	// There are no effects with a tail to let
+	// finish, so this is always immediate.
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+
+	auto& game = voice->game;
+	game.state = MGSoundState::Stopped;
+	game.flushed = game.appended;
+
+	MGA_System_Push(voice->system, MGA_CommandType::Stop, voice);
 }
 
 MGSoundState MGA_Voice_GetState(MGA_Voice* voice)
 {
 	assert(voice != nullptr);
-	return MGSoundState::Stopped;
+
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+	return MGA_Voice_UpdateState(voice);
 }
 
 mgulong MGA_Voice_GetPosition(MGA_Voice* voice)
 {
 	assert(voice != nullptr);
-	return 0;
+
+	// As of the last block.
+	return voice->position.load(std::memory_order_relaxed);
+}
+
+// Hands the changed params to the mixer with the system mutex held.
+static void MGA_Voice_UpdateParams(MGA_Voice* voice)
+{
+	voice->paramSlots[voice->paramBack] = voice->game.params;
+	voice->paramBack = voice->paramShared.exchange(voice->paramBack | MGA_ParamsFresh) & MGA_ParamsIndex;
+
+	// Any command still queued will pick these up.
+	if (!voice->paramsQueued.exchange(true))
+		MGA_System_Push(voice->system, MGA_CommandType::UpdateParams, voice);
 }
 
 void MGA_Voice_SetPan(MGA_Voice* voice, mgfloat pan)
 {
 	assert(voice != nullptr);
+
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+
+	auto& params = voice->game.params;
+	params.pan = pan;
+	params.positional = false;
+	params.attenuation = 1.0f;
+	MGA_Voice_UpdateParams(voice);
 }
 
 void MGA_Voice_SetPitch(MGA_Voice* voice, mgfloat pitch)
 {
 	assert(voice != nullptr);
+
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+
+	auto& params = voice->game.params;
+	params.pitch = pitch;
+	params.doppler = 1.0f;
+	MGA_Voice_UpdateParams(voice);
 }
 
 void MGA_Voice_SetVolume(MGA_Voice* voice, mgfloat volume)
 {
 	assert(voice != nullptr);
+
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+	voice->game.params.volume = volume;
+	MGA_Voice_UpdateParams(voice);
+}
+
+void MGA_Voice_SetPriority(MGA_Voice* voice, mgfloat priority)
+{
+	assert(voice != nullptr);
+
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+	voice->game.params.priority = std::max(priority, 0.0f);
+	MGA_Voice_UpdateParams(voice);
 }
 
 void MGA_Voice_SetReverbMix(MGA_Voice* voice, mgfloat mix)
 {
 	assert(voice != nullptr);
+
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+	voice->game.params.reverbMix = std::min(std::max(mix, 0.0f), 2.0f);
+	MGA_Voice_UpdateParams(voice);
 }
 
 void MGA_Voice_SetFilterMode(MGA_Voice* voice, MGFilterMode mode, mgfloat filterQ, mgfloat frequency)
 {
 	assert(voice != nullptr);
+
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+
+	auto& params = voice->game.params;
+	params.filtered = true;
+	params.filterMode = mode;
+	params.filterFrequency = std::max(frequency, 0.0f);
+	params.filterOneOverQ = filterQ > 0.0f ? std::min(1.0f / filterQ, 1.5f) : 1.0f;
+	MGA_Voice_UpdateParams(voice);
 }
 
 void MGA_Voice_ClearFilterMode(MGA_Voice* voice)
 {
 	assert(voice != nullptr);
+
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+	voice->game.params.filtered = false;
+	MGA_Voice_UpdateParams(voice);
+}
+
+// Positions the voice with the pan, attenuation and
+// doppler worked out for it, with the mutex held.
+static void MGA_Voice_Position(MGA_Voice* voice, mgfloat pan, mgfloat attenuation, mgfloat doppler)
+{
+	auto& params = voice->game.params;
+	params.positional = true;
+	params.positionalPan = pan;
+	params.attenuation = attenuation;
+	params.doppler = doppler;
+	MGA_Voice_UpdateParams(voice);
 }
 
 void MGA_Voice_Apply3D(MGA_Voice* voice, Listener& listener, Emitter& emitter, mgfloat distanceScale)
 {
 	assert(voice != nullptr);
+
+	mgfloat pan, attenuation, doppler;
+	MGA_Mix_Spatialize(listener, &emitter, 1, distanceScale, &pan, &attenuation, &doppler);
+
+	std::lock_guard<std::mutex> lock(voice->system->mutex);
+	MGA_Voice_Position(voice, pan, attenuation, doppler);
 }
 
+void MGA_Voice_Apply3DBatch(MGA_Voice** voices, Emitter* emitters, mgint count, Listener& listener, mgfloat distanceScale)
+{
+	assert(voices != nullptr || count == 0);
+	assert(emitters != nullptr || count == 0);
+
+	if (count <= 0)
+		return;
+
+	auto system = voices[0]->system;
+
+	mgfloat pans[MGA_BatchVoices];
+	mgfloat attenuations[MGA_BatchVoices];
+	mgfloat dopplers[MGA_BatchVoices];
+
+	for (mgint first = 0; first < count; first += MGA_BatchVoices)
+	{
+		auto batch = std::min(count - first, MGA_BatchVoices);
+		MGA_Mix_Spatialize(listener, emitters + first, batch, distanceScale, pans, attenuations, dopplers);
+
+		std::lock_guard<std::mutex> lock(system->mutex);
+
+		for (mgint i = 0; i < batch; i++)
+		{
+			auto voice = voices[first + i];
+			assert(voice != nullptr);
+			assert(voice->system == system);
+
+			MGA_Voice_Position(voice, pans[i], attenuations[i], dopplers[i]);
+		}
+	}
+}
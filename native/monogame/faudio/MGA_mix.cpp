@@ -0,0 +1,515 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "MGA_common.h"
+#include "mg_simd.h"
+
+#include <algorithm>
+#include <stddef.h>
+#include <math.h>
+
+
+static const mgfloat MGA_Mix_Scale16 = 1.0f / 32768.0f;
+
+static const mgfloat MGA_Mix_SpeedOfSound = 343.5f;
+
+// Keeps both ends well under the speed of sound.
+static const mgfloat MGA_Mix_SpeedLimit = MGA_Mix_SpeedOfSound * 0.5f;
+
+static const mgfloat MGA_Mix_MinDoppler = 0.5f;
+static const mgfloat MGA_Mix_MaxDoppler = 2.0f;
+
+// The SIMD paths load the velocity and doppler scale together.
+static_assert(offsetof(Emitter, DopplerScale) == offsetof(Emitter, Velocity) + (3 * sizeof(mgfloat)), "The doppler scale must follow the velocity.");
+
+
+// The scalar paths also finish the tails of the SIMD ones.
+
+static void MGA_Mix_ToFloat_Scalar(const mgshort* src, mgint start, mgint count, mgfloat* dst)
+{
+	for (mgint i = start; i < count; i++)
+		dst[i] = src[i] * MGA_Mix_Scale16;
+}
+
+static void MGA_Mix_Mono_Scalar(const mgfloat* src, mgint start, mgint frames, const mgfloat gains[2], const mgfloat steps[2], mgfloat* bus)
+{
+	for (mgint i = start; i < frames; i++)
+	{
+		auto left = gains[0] + (steps[0] * i);
+		auto right = gains[1] + (steps[1] * i);
+
+		bus[(i * 2) + 0] += src[i] * left;
+		bus[(i * 2) + 1] += src[i] * right;
+	}
+}
+
+static void MGA_Mix_Stereo_Scalar(const mgfloat* src, mgint start, mgint frames, const mgfloat gains[4], const mgfloat steps[4], mgfloat* bus)
+{
+	for (mgint i = start; i < frames; i++)
+	{
+		auto left = src[(i * 2) + 0];
+		auto right = src[(i * 2) + 1];
+
+		bus[(i * 2) + 0] += (left * (gains[0] + (steps[0] * i))) + (right * (gains[1] + (steps[1] * i)));
+		bus[(i * 2) + 1] += (left * (gains[2] + (steps[2] * i))) + (right * (gains[3] + (steps[3] * i)));
+	}
+}
+
+static void MGA_Mix_Clamp_Scalar(mgfloat* bus, mgint start, mgint count)
+{
+	for (mgint i = start; i < count; i++)
+		bus[i] = std::min(std::max(bus[i], -1.0f), 1.0f);
+}
+
+// XNA is right handed, so this points to the listener's
+// right.  It is zero if the listener has no orientation.
+static Vector3 MGA_Mix_ListenerRight(const Listener& listener)
+{
+	auto& f = listener.Forward;
+	auto& u = listener.Up;
+	Vector3 right = { (f.Y * u.Z) - (f.Z * u.Y), (f.Z * u.X) - (f.X * u.Z), (f.X * u.Y) - (f.Y * u.X) };
+
+	auto length = sqrtf((right.X * right.X) + (right.Y * right.Y) + (right.Z * right.Z));
+	if (length > 0.0f)
+	{
+		right.X /= length;
+		right.Y /= length;
+		right.Z /= length;
+	}
+
+	return right;
+}
+
+// The SIMD paths do the same math in the same order.
+static void MGA_Mix_Spatialize_Scalar(const Listener& listener, const Vector3& right, const Emitter* emitters, mgint start, mgint count, mgfloat distanceScale, mgfloat* pans, mgfloat* attenuations, mgfloat* dopplers)
+{
+	auto& lv = listener.Velocity;
+
+	for (mgint i = start; i < count; i++)
+	{
+		auto& emitter = emitters[i];
+		auto ox = emitter.Position.X - listener.Position.X;
+		auto oy = emitter.Position.Y - listener.Position.Y;
+		auto oz = emitter.Position.Z - listener.Position.Z;
+
+		auto distance = sqrtf(((ox * ox) + (oy * oy)) + (oz * oz));
+
+		// Pan by how far round to the side the emitter is.
+		pans[i] = 0.0f;
+		if (distance > 0.0f)
+			pans[i] = (((ox * right.X) + (oy * right.Y)) + (oz * right.Z)) / distance;
+
+		// Inverse distance from where it starts to get quieter.
+		attenuations[i] = 1.0f;
+		if (distanceScale > 0.0f)
+			attenuations[i] = 1.0f / std::max(distance / distanceScale, 1.0f);
+
+		// The velocities towards each other change the pitch.
+		dopplers[i] = 1.0f;
+		auto scale = emitter.DopplerScale;
+		if (distance > 0.0f && scale > 0.0f)
+		{
+			auto& ev = emitter.Velocity;
+			auto listenerSpeed = ((((lv.X * ox) + (lv.Y * oy)) + (lv.Z * oz)) / distance) * scale;
+			auto emitterSpeed = ((((ev.X * ox) + (ev.Y * oy)) + (ev.Z * oz)) / distance) * scale;
+
+			listenerSpeed = std::min(std::max(listenerSpeed, -MGA_Mix_SpeedLimit), MGA_Mix_SpeedLimit);
+			emitterSpeed = std::min(std::max(emitterSpeed, -MGA_Mix_SpeedLimit), MGA_Mix_SpeedLimit);
+
+			auto doppler = (MGA_Mix_SpeedOfSound + listenerSpeed) / (MGA_Mix_SpeedOfSound + emitterSpeed);
+			dopplers[i] = std::min(std::max(doppler, MGA_Mix_MinDoppler), MGA_Mix_MaxDoppler);
+		}
+	}
+}
+
+#if defined(MG_SIMD_SSE2)
+
+void MGA_Mix_ToFloat(const mgshort* src, mgint count, mgfloat* dst)
+{
+	const auto scale = _mm_set1_ps(MGA_Mix_Scale16);
+
+	mgint i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		auto s = _mm_loadu_si128((const __m128i*)(src + i));
+
+		// Sign extend by putting each sample in the top half.
+		auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+		auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+
+		_mm_storeu_ps(dst + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+	}
+
+	MGA_Mix_ToFloat_Scalar(src, i, count, dst);
+}
+
+// Both do two stereo frames per register, so the gains
+// are laid out to match and step two frames at a time.
+
+void MGA_Mix_Mono(const mgfloat* src, mgint frames, const mgfloat gains[2], const mgfloat steps[2], mgfloat* bus)
+{
+	auto gain = _mm_setr_ps(gains[0], gains[1], gains[0] + steps[0], gains[1] + steps[1]);
+	auto step = _mm_setr_ps(steps[0] * 2, steps[1] * 2, steps[0] * 2, steps[1] * 2);
+
+	mgint i = 0;
+	for (; i + 4 <= frames; i += 4)
+	{
+		auto s = _mm_loadu_ps(src + i);
+		auto out = bus + (i * 2);
+
+		auto lo = _mm_mul_ps(_mm_unpacklo_ps(s, s), gain);
+		gain = _mm_add_ps(gain, step);
+		auto hi = _mm_mul_ps(_mm_unpackhi_ps(s, s), gain);
+		gain = _mm_add_ps(gain, step);
+
+		_mm_storeu_ps(out + 0, _mm_add_ps(_mm_loadu_ps(out + 0), lo));
+		_mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), hi));
+	}
+
+	MGA_Mix_Mono_Scalar(src, i, frames, gains, steps, bus);
+}
+
+void MGA_Mix_Stereo(const mgfloat* src, mgint frames, const mgfloat gains[4], const mgfloat steps[4], mgfloat* bus)
+{
+	// Each channel to itself and each to the other channel.
+	auto direct = _mm_setr_ps(gains[0], gains[3], gains[0] + steps[0], gains[3] + steps[3]);
+	auto cross = _mm_setr_ps(gains[1], gains[2], gains[1] + steps[1], gains[2] + steps[2]);
+	auto directStep = _mm_setr_ps(steps[0] * 2, steps[3] * 2, steps[0] * 2, steps[3] * 2);
+	auto crossStep = _mm_setr_ps(steps[1] * 2, steps[2] * 2, steps[1] * 2, steps[2] * 2);
+
+	mgint i = 0;
+	for (; i + 2 <= frames; i += 2)
+	{
+		auto s = _mm_loadu_ps(src + (i * 2));
+		auto swapped = _mm_shuffle_ps(s, s, _MM_SHUFFLE(2, 3, 0, 1));
+		auto out = bus + (i * 2);
+
+		auto mixed = _mm_add_ps(_mm_mul_ps(s, direct), _mm_mul_ps(swapped, cross));
+		_mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), mixed));
+
+		direct = _mm_add_ps(direct, directStep);
+		cross = _mm_add_ps(cross, crossStep);
+	}
+
+	MGA_Mix_Stereo_Scalar(src, i, frames, gains, steps, bus);
+}
+
+void MGA_Mix_Clamp(mgfloat* bus, mgint count)
+{
+	const auto lo = _mm_set1_ps(-1.0f);
+	const auto hi = _mm_set1_ps(1.0f);
+
+	mgint i = 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(bus + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(bus + i), lo), hi));
+
+	MGA_Mix_Clamp_Scalar(bus, i, count);
+}
+
+// Four emitters at a time, each loaded as a row of four
+// floats and transposed so each register is one component.
+
+void MGA_Mix_Spatialize(const Listener& listener, const Emitter* emitters, mgint count, mgfloat distanceScale, mgfloat* pans, mgfloat* attenuations, mgfloat* dopplers)
+{
+	auto right = MGA_Mix_ListenerRight(listener);
+
+	const auto zero = _mm_setzero_ps();
+	const auto one = _mm_set1_ps(1.0f);
+	const auto lpx = _mm_set1_ps(listener.Position.X);
+	const auto lpy = _mm_set1_ps(listener.Position.Y);
+	const auto lpz = _mm_set1_ps(listener.Position.Z);
+	const auto lvx = _mm_set1_ps(listener.Velocity.X);
+	const auto lvy = _mm_set1_ps(listener.Velocity.Y);
+	const auto lvz = _mm_set1_ps(listener.Velocity.Z);
+	const auto rx = _mm_set1_ps(right.X);
+	const auto ry = _mm_set1_ps(right.Y);
+	const auto rz = _mm_set1_ps(right.Z);
+	const auto scale = _mm_set1_ps(distanceScale);
+	const auto c = _mm_set1_ps(MGA_Mix_SpeedOfSound);
+	const auto hi = _mm_set1_ps(MGA_Mix_SpeedLimit);
+	const auto lo = _mm_set1_ps(-MGA_Mix_SpeedLimit);
+	const auto minDoppler = _mm_set1_ps(MGA_Mix_MinDoppler);
+	const auto maxDoppler = _mm_set1_ps(MGA_Mix_MaxDoppler);
+
+	mgint i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		auto e = emitters + i;
+
+		// The last row is the forward X we don't need.
+		auto px = _mm_loadu_ps(&e[0].Position.X);
+		auto py = _mm_loadu_ps(&e[1].Position.X);
+		auto pz = _mm_loadu_ps(&e[2].Position.X);
+		auto unused = _mm_loadu_ps(&e[3].Position.X);
+		_MM_TRANSPOSE4_PS(px, py, pz, unused);
+
+		auto vx = _mm_loadu_ps(&e[0].Velocity.X);
+		auto vy = _mm_loadu_ps(&e[1].Velocity.X);
+		auto vz = _mm_loadu_ps(&e[2].Velocity.X);
+		auto ds = _mm_loadu_ps(&e[3].Velocity.X);
+		_MM_TRANSPOSE4_PS(vx, vy, vz, ds);
+
+		auto ox = _mm_sub_ps(px, lpx);
+		auto oy = _mm_sub_ps(py, lpy);
+		auto oz = _mm_sub_ps(pz, lpz);
+
+		auto distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ox, ox), _mm_mul_ps(oy, oy)), _mm_mul_ps(oz, oz)));
+		auto away = _mm_cmpgt_ps(distance, zero);
+
+		auto side = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ox, rx), _mm_mul_ps(oy, ry)), _mm_mul_ps(oz, rz));
+		_mm_storeu_ps(pans + i, _mm_and_ps(away, _mm_div_ps(side, distance)));
+
+		auto attenuation = one;
+		if (distanceScale > 0.0f)
+			attenuation = _mm_div_ps(one, _mm_max_ps(_mm_div_ps(distance, scale), one));
+		_mm_storeu_ps(attenuations + i, attenuation);
+
+		auto listenerSpeed = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lvx, ox), _mm_mul_ps(lvy, oy)), _mm_mul_ps(lvz, oz));
+		auto emitterSpeed = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, ox), _mm_mul_ps(vy, oy)), _mm_mul_ps(vz, oz));
+		listenerSpeed = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_div_ps(listenerSpeed, distance), ds), lo), hi);
+		emitterSpeed = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_div_ps(emitterSpeed, distance), ds), lo), hi);
+
+		auto doppler = _mm_div_ps(_mm_add_ps(c, listenerSpeed), _mm_add_ps(c, emitterSpeed));
+		doppler = _mm_min_ps(_mm_max_ps(doppler, minDoppler), maxDoppler);
+
+		// Anything too close or without doppler keeps its pitch.
+		auto shifted = _mm_and_ps(away, _mm_cmpgt_ps(ds, zero));
+		_mm_storeu_ps(dopplers + i, _mm_or_ps(_mm_and_ps(shifted, doppler), _mm_andnot_ps(shifted, one)));
+	}
+
+	MGA_Mix_Spatialize_Scalar(listener, right, emitters, i, count, distanceScale, pans, attenuations, dopplers);
+}
+
+#elif defined(MG_SIMD_NEON)
+
+void MGA_Mix_ToFloat(const mgshort* src, mgint count, mgfloat* dst)
+{
+	mgint i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		auto s = vld1q_s16(src + i);
+		vst1q_f32(dst + i + 0, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))), MGA_Mix_Scale16));
+		vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))), MGA_Mix_Scale16));
+	}
+
+	MGA_Mix_ToFloat_Scalar(src, i, count, dst);
+}
+
+// Both do two stereo frames per register, so the gains
+// are laid out to match and step two frames at a time.
+
+void MGA_Mix_Mono(const mgfloat* src, mgint frames, const mgfloat gains[2], const mgfloat steps[2], mgfloat* bus)
+{
+	const mgfloat start[4] = { gains[0], gains[1], gains[0] + steps[0], gains[1] + steps[1] };
+	const mgfloat twice[4] = { steps[0] * 2, steps[1] * 2, steps[0] * 2, steps[1] * 2 };
+	auto gain = vld1q_f32(start);
+	auto step = vld1q_f32(twice);
+
+	mgint i = 0;
+	for (; i + 4 <= frames; i += 4)
+	{
+		auto s = vld1q_f32(src + i);
+		auto doubled = vzipq_f32(s, s);
+		auto out = bus + (i * 2);
+
+		auto lo = vmulq_f32(doubled.val[0], gain);
+		gain = vaddq_f32(gain, step);
+		auto hi = vmulq_f32(doubled.val[1], gain);
+		gain = vaddq_f32(gain, step);
+
+		vst1q_f32(out + 0, vaddq_f32(vld1q_f32(out + 0), lo));
+		vst1q_f32(out + 4, vaddq_f32(vld1q_f32(out + 4), hi));
+	}
+
+	MGA_Mix_Mono_Scalar(src, i, frames, gains, steps, bus);
+}
+
+void MGA_Mix_Stereo(const mgfloat* src, mgint frames, const mgfloat gains[4], const mgfloat steps[4], mgfloat* bus)
+{
+	// Each channel to itself and each to the other channel.
+	const mgfloat directStart[4] = { gains[0], gains[3], gains[0] + steps[0], gains[3] + steps[3] };
+	const mgfloat crossStart[4] = { gains[1], gains[2], gains[1] + steps[1], gains[2] + steps[2] };
+	const mgfloat directTwice[4] = { steps[0] * 2, steps[3] * 2, steps[0] * 2, steps[3] * 2 };
+	const mgfloat crossTwice[4] = { steps[1] * 2, steps[2] * 2, steps[1] * 2, steps[2] * 2 };
+	auto direct = vld1q_f32(directStart);
+	auto cross = vld1q_f32(crossStart);
+	auto directStep = vld1q_f32(directTwice);
+	auto crossStep = vld1q_f32(crossTwice);
+
+	mgint i = 0;
+	for (; i + 2 <= frames; i += 2)
+	{
+		auto s = vld1q_f32(src + (i * 2));
+		auto swapped = vrev64q_f32(s);
+		auto out = bus + (i * 2);
+
+		auto mixed = vmlaq_f32(vmulq_f32(s, direct), swapped, cross);
+		vst1q_f32(out, vaddq_f32(vld1q_f32(out), mixed));
+
+		direct = vaddq_f32(direct, directStep);
+		cross = vaddq_f32(cross, crossStep);
+	}
+
+	MGA_Mix_Stereo_Scalar(src, i, frames, gains, steps, bus);
+}
+
+void MGA_Mix_Clamp(mgfloat* bus, mgint count)
+{
+	const auto lo = vdupq_n_f32(-1.0f);
+	const auto hi = vdupq_n_f32(1.0f);
+
+	mgint i = 0;
+	for (; i + 4 <= count; i += 4)
+		vst1q_f32(bus + i, vminq_f32(vmaxq_f32(vld1q_f32(bus + i), lo), hi));
+
+	MGA_Mix_Clamp_Scalar(bus, i, count);
+}
+
+// Four emitters at a time, each loaded as a row of four
+// floats and transposed so each register is one component.
+
+static inline void MGA_Mix_Transpose(float32x4_t& r0, float32x4_t& r1, float32x4_t& r2, float32x4_t& r3)
+{
+	auto t01 = vtrnq_f32(r0, r1);
+	auto t23 = vtrnq_f32(r2, r3);
+	r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+	r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+	r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+	r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+// 32bit ARM has no divide or square root, so refine the
+// estimates which is plenty for panning and pitch.
+
+static inline float32x4_t MGA_Mix_Div(float32x4_t a, float32x4_t b)
+{
+#if defined(__aarch64__) || defined(_M_ARM64)
+	return vdivq_f32(a, b);
+#else
+	auto r = vrecpeq_f32(b);
+	r = vmulq_f32(r, vrecpsq_f32(b, r));
+	r = vmulq_f32(r, vrecpsq_f32(b, r));
+	return vmulq_f32(a, r);
+#endif
+}
+
+static inline float32x4_t MGA_Mix_Sqrt(float32x4_t a)
+{
+#if defined(__aarch64__) || defined(_M_ARM64)
+	return vsqrtq_f32(a);
+#else
+	auto r = vrsqrteq_f32(a);
+	r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(a, r), r));
+	r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(a, r), r));
+
+	// The estimate is infinite at zero.
+	return vbslq_f32(vceqq_f32(a, vdupq_n_f32(0.0f)), a, vmulq_f32(a, r));
+#endif
+}
+
+static inline float32x4_t MGA_Mix_Dot(float32x4_t ax, float32x4_t ay, float32x4_t az, float32x4_t bx, float32x4_t by, float32x4_t bz)
+{
+	return vaddq_f32(vaddq_f32(vmulq_f32(ax, bx), vmulq_f32(ay, by)), vmulq_f32(az, bz));
+}
+
+void MGA_Mix_Spatialize(const Listener& listener, const Emitter* emitters, mgint count, mgfloat distanceScale, mgfloat* pans, mgfloat* attenuations, mgfloat* dopplers)
+{
+	auto right = MGA_Mix_ListenerRight(listener);
+
+	const auto zero = vdupq_n_f32(0.0f);
+	const auto one = vdupq_n_f32(1.0f);
+	const auto lpx = vdupq_n_f32(listener.Position.X);
+	const auto lpy = vdupq_n_f32(listener.Position.Y);
+	const auto lpz = vdupq_n_f32(listener.Position.Z);
+	const auto lvx = vdupq_n_f32(listener.Velocity.X);
+	const auto lvy = vdupq_n_f32(listener.Velocity.Y);
+	const auto lvz = vdupq_n_f32(listener.Velocity.Z);
+	const auto rx = vdupq_n_f32(right.X);
+	const auto ry = vdupq_n_f32(right.Y);
+	const auto rz = vdupq_n_f32(right.Z);
+	const auto scale = vdupq_n_f32(distanceScale);
+	const auto c = vdupq_n_f32(MGA_Mix_SpeedOfSound);
+	const auto hi = vdupq_n_f32(MGA_Mix_SpeedLimit);
+	const auto lo = vdupq_n_f32(-MGA_Mix_SpeedLimit);
+	const auto minDoppler = vdupq_n_f32(MGA_Mix_MinDoppler);
+	const auto maxDoppler = vdupq_n_f32(MGA_Mix_MaxDoppler);
+
+	mgint i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		auto e = emitters + i;
+
+		// The last row is the forward X we don't need.
+		auto px = vld1q_f32(&e[0].Position.X);
+		auto py = vld1q_f32(&e[1].Position.X);
+		auto pz = vld1q_f32(&e[2].Position.X);
+		auto unused = vld1q_f32(&e[3].Position.X);
+		MGA_Mix_Transpose(px, py, pz, unused);
+
+		auto vx = vld1q_f32(&e[0].Velocity.X);
+		auto vy = vld1q_f32(&e[1].Velocity.X);
+		auto vz = vld1q_f32(&e[2].Velocity.X);
+		auto ds = vld1q_f32(&e[3].Velocity.X);
+		MGA_Mix_Transpose(vx, vy, vz, ds);
+
+		auto ox = vsubq_f32(px, lpx);
+		auto oy = vsubq_f32(py, lpy);
+		auto oz = vsubq_f32(pz, lpz);
+
+		auto distance = MGA_Mix_Sqrt(MGA_Mix_Dot(ox, oy, oz, ox, oy, oz));
+		auto away = vcgtq_f32(distance, zero);
+
+		auto side = MGA_Mix_Dot(ox, oy, oz, rx, ry, rz);
+		vst1q_f32(pans + i, vbslq_f32(away, MGA_Mix_Div(side, distance), zero));
+
+		auto attenuation = one;
+		if (distanceScale > 0.0f)
+			attenuation = MGA_Mix_Div(one, vmaxq_f32(MGA_Mix_Div(distance, scale), one));
+		vst1q_f32(attenuations + i, attenuation);
+
+		auto listenerSpeed = MGA_Mix_Dot(lvx, lvy, lvz, ox, oy, oz);
+		auto emitterSpeed = MGA_Mix_Dot(vx, vy, vz, ox, oy, oz);
+		listenerSpeed = vminq_f32(vmaxq_f32(vmulq_f32(MGA_Mix_Div(listenerSpeed, distance), ds), lo), hi);
+		emitterSpeed = vminq_f32(vmaxq_f32(vmulq_f32(MGA_Mix_Div(emitterSpeed, distance), ds), lo), hi);
+
+		auto doppler = MGA_Mix_Div(vaddq_f32(c, listenerSpeed), vaddq_f32(c, emitterSpeed));
+		doppler = vminq_f32(vmaxq_f32(doppler, minDoppler), maxDoppler);
+
+		// Anything too close or without doppler keeps its pitch.
+		auto shifted = vandq_u32(away, vcgtq_f32(ds, zero));
+		vst1q_f32(dopplers + i, vbslq_f32(shifted, doppler, one));
+	}
+
+	MGA_Mix_Spatialize_Scalar(listener, right, emitters, i, count, distanceScale, pans, attenuations, dopplers);
+}
+
+#else
+
+void MGA_Mix_ToFloat(const mgshort* src, mgint count, mgfloat* dst)
+{
+	MGA_Mix_ToFloat_Scalar(src, 0, count, dst);
+}
+
+void MGA_Mix_Mono(const mgfloat* src, mgint frames, const mgfloat gains[2], const mgfloat steps[2], mgfloat* bus)
+{
+	MGA_Mix_Mono_Scalar(src, 0, frames, gains, steps, bus);
+}
+
+void MGA_Mix_Stereo(const mgfloat* src, mgint frames, const mgfloat gains[4], const mgfloat steps[4], mgfloat* bus)
+{
+	MGA_Mix_Stereo_Scalar(src, 0, frames, gains, steps, bus);
+}
+
+void MGA_Mix_Clamp(mgfloat* bus, mgint count)
+{
+	MGA_Mix_Clamp_Scalar(bus, 0, count);
+}
+
+void MGA_Mix_Spatialize(const Listener& listener, const Emitter* emitters, mgint count, mgfloat distanceScale, mgfloat* pans, mgfloat* attenuations, mgfloat* dopplers)
+{
+	MGA_Mix_Spatialize_Scalar(listener, MGA_Mix_ListenerRight(listener), emitters, 0, count, distanceScale, pans, attenuations, dopplers);
+}
+
+#endif
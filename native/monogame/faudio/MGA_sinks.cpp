@@ -0,0 +1,166 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "MGA_common.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <string.h>
+
+
+// About what a hardware device would ask for at a time.
+static const mgint MGA_Sink_PeriodFrames = 480;
+
+
+// Pulls from the mixer on its own thread at the
+// rate a real device would, so voices finish and
+// change state just like they do with hardware.
+struct MGA_Sink_Null : MGA_Sink
+{
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool quit = false;
+
+	std::vector<mgfloat> period;
+
+	~MGA_Sink_Null() override
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+
+		wake.notify_one();
+
+		if (thread.joinable())
+			thread.join();
+	}
+
+	void Start(MGA_RenderCallback render, void* data) override
+	{
+		period.resize(MGA_Sink_PeriodFrames * MGA_OUTPUT_CHANNELS);
+		thread = std::thread(&MGA_Sink_Null::Run, this, render, data);
+	}
+
+	virtual void Write(const mgfloat* samples, mgint frames)
+	{
+	}
+
+	void Run(MGA_RenderCallback render, void* data)
+	{
+		auto interval = std::chrono::microseconds(((mglong)MGA_Sink_PeriodFrames * 1000000) / sampleRate);
+		auto next = std::chrono::steady_clock::now();
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (!quit)
+		{
+			lock.unlock();
+			render(data, period.data(), MGA_Sink_PeriodFrames);
+			Write(period.data(), MGA_Sink_PeriodFrames);
+			lock.lock();
+
+			// Keep to the clock rather than the
+			// time spent, so we don't drift.
+			next += interval;
+			wake.wait_until(lock, next, [this] { return quit; });
+		}
+	}
+};
+
+// Writes everything rendered to a 32bit float WAV.
+struct MGA_Sink_File : MGA_Sink_Null
+{
+	FILE* file = nullptr;
+	mguint dataBytes = 0;
+
+	~MGA_Sink_File() override
+	{
+		// Stop rendering before finishing the file.
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+
+		wake.notify_one();
+
+		if (thread.joinable())
+			thread.join();
+
+		WriteHeader();
+		fclose(file);
+	}
+
+	void WriteHeader()
+	{
+		struct
+		{
+			char riff[4];
+			mguint riffBytes;
+			char wave[4];
+			char fmt[4];
+			mguint fmtBytes;
+			mgushort tag;
+			mgushort channels;
+			mguint sampleRate;
+			mguint byteRate;
+			mgushort blockAlign;
+			mgushort sampleBits;
+			char data[4];
+			mguint dataBytes;
+		} header;
+
+		memcpy(header.riff, "RIFF", 4);
+		header.riffBytes = 36 + dataBytes;
+		memcpy(header.wave, "WAVE", 4);
+		memcpy(header.fmt, "fmt ", 4);
+		header.fmtBytes = 16;
+		header.tag = 3;
+		header.channels = MGA_OUTPUT_CHANNELS;
+		header.sampleRate = sampleRate;
+		header.byteRate = sampleRate * MGA_OUTPUT_CHANNELS * sizeof(mgfloat);
+		header.blockAlign = MGA_OUTPUT_CHANNELS * sizeof(mgfloat);
+		header.sampleBits = 32;
+		memcpy(header.data, "data", 4);
+		header.dataBytes = dataBytes;
+
+		static_assert(sizeof(header) == 44, "The WAV header must be packed.");
+
+		fseek(file, 0, SEEK_SET);
+		fwrite(&header, sizeof(header), 1, file);
+		fseek(file, 0, SEEK_END);
+	}
+
+	void Write(const mgfloat* samples, mgint frames) override
+	{
+		auto count = (size_t)frames * MGA_OUTPUT_CHANNELS;
+		dataBytes += (mguint)(fwrite(samples, sizeof(mgfloat), count, file) * sizeof(mgfloat));
+	}
+};
+
+
+MGA_Sink* MGA_Sink_CreateNull()
+{
+	return new MGA_Sink_Null();
+}
+
+MGA_Sink* MGA_Sink_CreateFile(const char* path)
+{
+	assert(path != nullptr);
+
+	auto file = fopen(path, "wb");
+	if (file == nullptr)
+		return nullptr;
+
+	auto sink = new MGA_Sink_File();
+	sink->file = file;
+
+	// Written again with the sizes when we're done.
+	sink->WriteHeader();
+
+	return sink;
+}
@@ -0,0 +1,258 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "MGA_common.h"
+
+#include <algorithm>
+#include <string.h>
+
+
+#define MGA_WAVE_FORMAT_PCM			0x0001
+#define MGA_WAVE_FORMAT_ADPCM		0x0002
+#define MGA_WAVE_FORMAT_IEEE_FLOAT	0x0003
+#define MGA_WAVE_FORMAT_IMA_ADPCM	0x0011
+#define MGA_WAVE_FORMAT_EXTENSIBLE	0xFFFE
+
+static const mgint MGA_MSADPCM_Adapt[16] = { 230, 230, 230, 230, 307, 409, 512, 614, 768, 614, 512, 409, 307, 230, 230, 230 };
+static const mgint MGA_MSADPCM_Coef1[7] = { 256, 512, 0, 192, 240, 460, 392 };
+static const mgint MGA_MSADPCM_Coef2[7] = { 0, -256, 0, 64, 0, -208, -232 };
+
+static const mgint MGA_IMAADPCM_Index[16] = { -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8 };
+static const mgint MGA_IMAADPCM_Step[89] =
+{
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+	50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+	253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+	1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+	3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+	12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+
+// The headers and data aren't aligned, so read thru these.
+static inline mgint MGA_Wave_ReadU16(const mgbyte* data)
+{
+	return data[0] | (data[1] << 8);
+}
+
+static inline mgint MGA_Wave_ReadS16(const mgbyte* data)
+{
+	return (mgshort)MGA_Wave_ReadU16(data);
+}
+
+static inline mgint MGA_Wave_ReadU32(const mgbyte* data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
+}
+
+static inline mgshort MGA_Wave_Clamp16(mgint sample)
+{
+	return (mgshort)std::min(std::max(sample, -32768), 32767);
+}
+
+
+bool MGA_Wave_DecodePCM(MGA_Wave& wave, const mgbyte* data, mgint length, mgint sampleBits)
+{
+	assert(wave.channels > 0);
+
+	auto bytes = sampleBits / 8;
+	if (bytes < 1 || bytes > 4)
+		return false;
+
+	auto frames = length / (bytes * wave.channels);
+	wave.pcm.resize((size_t)frames * wave.channels);
+	auto out = wave.pcm.data();
+
+	// Larger samples just keep their top 16 bits.
+	switch (bytes)
+	{
+	case 1:
+		for (size_t i = 0; i < wave.pcm.size(); i++)
+			out[i] = (mgshort)((data[i] - 128) * 256);
+		break;
+	case 2:
+		memcpy(out, data, wave.pcm.size() * sizeof(mgshort));
+		break;
+	default:
+		for (size_t i = 0; i < wave.pcm.size(); i++)
+			out[i] = (mgshort)MGA_Wave_ReadS16(data + (i * bytes) + bytes - 2);
+		break;
+	}
+
+	return !wave.pcm.empty();
+}
+
+static bool MGA_Wave_DecodeFloat(MGA_Wave& wave, const mgbyte* data, mgint length)
+{
+	auto count = length / sizeof(mgfloat);
+	wave.pcm.resize(count - (count % wave.channels));
+
+	for (size_t i = 0; i < wave.pcm.size(); i++)
+	{
+		mgfloat sample;
+		memcpy(&sample, data + (i * sizeof(mgfloat)), sizeof(sample));
+		wave.pcm[i] = MGA_Wave_Clamp16((mgint)(sample * 32767.0f));
+	}
+
+	return !wave.pcm.empty();
+}
+
+bool MGA_Wave_DecodeMSADPCM(MGA_Wave& wave, const mgbyte* data, mgint length, mgint blockAlign)
+{
+	assert(wave.channels > 0);
+
+	auto channels = wave.channels;
+	auto headerBytes = 7 * channels;
+	if (channels > 2 || blockAlign <= headerBytes)
+		return false;
+
+	wave.pcm.clear();
+	wave.pcm.reserve((size_t)(length / blockAlign + 1) * ((blockAlign - headerBytes) * 2 + (2 * channels)));
+
+	mgint predictor[2], delta[2], sample1[2], sample2[2];
+
+	// The last block may be short.
+	for (mgint offset = 0; offset + headerBytes <= length; offset += blockAlign)
+	{
+		auto block = data + offset;
+		auto blockBytes = std::min(blockAlign, length - offset);
+
+		for (mgint c = 0; c < channels; c++)
+		{
+			predictor[c] = std::min<mgint>(block[c], 6);
+			delta[c] = MGA_Wave_ReadS16(block + channels + (c * 2));
+			sample1[c] = MGA_Wave_ReadS16(block + (3 * channels) + (c * 2));
+			sample2[c] = MGA_Wave_ReadS16(block + (5 * channels) + (c * 2));
+		}
+
+		// The header holds the first two samples oldest last.
+		for (mgint c = 0; c < channels; c++)
+			wave.pcm.push_back((mgshort)sample2[c]);
+		for (mgint c = 0; c < channels; c++)
+			wave.pcm.push_back((mgshort)sample1[c]);
+
+		// Each byte is two samples high nibble first which
+		// for stereo is one sample for each channel.
+		mgint c = 0;
+		for (auto b = headerBytes; b < blockBytes; b++)
+		{
+			for (auto shift : { 4, 0 })
+			{
+				auto nibble = (block[b] >> shift) & 0xF;
+				auto signedNibble = nibble >= 8 ? nibble - 16 : nibble;
+
+				auto predicted = ((sample1[c] * MGA_MSADPCM_Coef1[predictor[c]]) + (sample2[c] * MGA_MSADPCM_Coef2[predictor[c]])) / 256;
+				auto sample = MGA_Wave_Clamp16(predicted + (signedNibble * delta[c]));
+
+				sample2[c] = sample1[c];
+				sample1[c] = sample;
+				delta[c] = std::max((MGA_MSADPCM_Adapt[nibble] * delta[c]) / 256, 16);
+
+				wave.pcm.push_back(sample);
+				c = (c + 1) % channels;
+			}
+		}
+	}
+
+	return !wave.pcm.empty();
+}
+
+bool MGA_Wave_DecodeIMAADPCM(MGA_Wave& wave, const mgbyte* data, mgint length, mgint blockAlign)
+{
+	assert(wave.channels > 0);
+
+	auto channels = wave.channels;
+	auto headerBytes = 4 * channels;
+	auto groupBytes = 4 * channels;
+	if (channels > 2 || blockAlign <= headerBytes)
+		return false;
+
+	wave.pcm.clear();
+	wave.pcm.reserve((size_t)(length / blockAlign + 1) * ((blockAlign - headerBytes) * 2 + channels));
+
+	mgint predicted[2], index[2];
+
+	// The last block may be short.
+	for (mgint offset = 0; offset + headerBytes <= length; offset += blockAlign)
+	{
+		auto block = data + offset;
+		auto blockBytes = std::min(blockAlign, length - offset);
+
+		for (mgint c = 0; c < channels; c++)
+		{
+			predicted[c] = MGA_Wave_ReadS16(block + (c * 4));
+			index[c] = std::min<mgint>(block[(c * 4) + 2], 88);
+			wave.pcm.push_back((mgshort)predicted[c]);
+		}
+
+		// The channels take turns with 4 bytes which
+		// are 8 samples each, low nibble first.
+		for (auto group = headerBytes; group + groupBytes <= blockBytes; group += groupBytes)
+		{
+			auto first = wave.pcm.size();
+			wave.pcm.resize(first + (8 * channels));
+
+			for (mgint c = 0; c < channels; c++)
+			{
+				auto bytes = block + group + (c * 4);
+
+				for (mgint i = 0; i < 8; i++)
+				{
+					auto nibble = (bytes[i >> 1] >> ((i & 1) * 4)) & 0xF;
+					auto step = MGA_IMAADPCM_Step[index[c]];
+
+					auto diff = step >> 3;
+					if (nibble & 4)
+						diff += step;
+					if (nibble & 2)
+						diff += step >> 1;
+					if (nibble & 1)
+						diff += step >> 2;
+
+					predicted[c] = MGA_Wave_Clamp16((nibble & 8) ? predicted[c] - diff : predicted[c] + diff);
+					index[c] = std::min(std::max(index[c] + MGA_IMAADPCM_Index[nibble], 0), 88);
+
+					wave.pcm[first + (i * channels) + c] = (mgshort)predicted[c];
+				}
+			}
+		}
+	}
+
+	return !wave.pcm.empty();
+}
+
+bool MGA_Wave_DecodeFormat(MGA_Wave& wave, const mgbyte* header, const mgbyte* data, mgint length)
+{
+	// This is a WAVEFORMATEX.
+	auto tag = MGA_Wave_ReadU16(header + 0);
+	auto channels = MGA_Wave_ReadU16(header + 2);
+	auto sampleRate = MGA_Wave_ReadU32(header + 4);
+	auto blockAlign = MGA_Wave_ReadU16(header + 12);
+	auto sampleBits = MGA_Wave_ReadU16(header + 14);
+
+	// The real format is the start of the sub format GUID.
+	if (tag == MGA_WAVE_FORMAT_EXTENSIBLE && MGA_Wave_ReadU16(header + 16) >= 22)
+		tag = MGA_Wave_ReadU16(header + 24);
+
+	if (channels < 1 || channels > 2 || sampleRate <= 0)
+		return false;
+
+	wave.channels = channels;
+	wave.sampleRate = sampleRate;
+
+	switch (tag)
+	{
+	case MGA_WAVE_FORMAT_PCM:
+		return MGA_Wave_DecodePCM(wave, data, length, sampleBits);
+	case MGA_WAVE_FORMAT_IEEE_FLOAT:
+		return sampleBits == 32 && MGA_Wave_DecodeFloat(wave, data, length);
+	case MGA_WAVE_FORMAT_ADPCM:
+		return MGA_Wave_DecodeMSADPCM(wave, data, length, blockAlign);
+	case MGA_WAVE_FORMAT_IMA_ADPCM:
+		return MGA_Wave_DecodeIMAADPCM(wave, data, length, blockAlign);
+	}
+
+	// xWMA and XMA need a platform decoder.
+	return false;
+}
@@ -0,0 +1,122 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#pragma once
+
+#include "mg_common.h"
+#include "api_enums.h"
+#include "api_structs.h"
+
+
+// The mix is always interleaved stereo float.
+#define MGA_OUTPUT_CHANNELS 2
+
+// Called on the audio thread to fill the output with
+// the next frames of the mix.
+typedef void (*MGA_RenderCallback)(void* data, mgfloat* output, mgint frames);
+
+/// <summary>
+/// Where the software mixer sends its output.
+/// </summary>
+/// <remarks>
+/// The sink picks the sample rate when it is created and doesn't
+/// call render until started.  Destroying it stops rendering.
+/// </remarks>
+struct MGA_Sink
+{
+	mgint sampleRate = 48000;
+
+	virtual ~MGA_Sink() {}
+	virtual void Start(MGA_RenderCallback render, void* data) = 0;
+};
+
+/// <summary>
+/// Renders in real time and throws the output away.
+/// </summary>
+MGA_Sink* MGA_Sink_CreateNull();
+
+/// <summary>
+/// Renders in real time and writes the output to a float WAV file.
+/// </summary>
+MGA_Sink* MGA_Sink_CreateFile(const char* path);
+
+#if defined(MG_SDL2)
+
+/// <summary>
+/// Plays thru the default SDL audio device, null if there is none.
+/// </summary>
+MGA_Sink* MGA_Sink_CreateSDL();
+
+#endif
+
+
+/// <summary>
+/// Converts 16bit samples to floats in -1 to 1.
+/// </summary>
+void MGA_Mix_ToFloat(const mgshort* src, mgint count, mgfloat* dst);
+
+/// <summary>
+/// Adds mono frames to the stereo bus.
+/// </summary>
+/// <remarks>
+/// The gains are left and right and move by the steps every frame.
+/// </remarks>
+void MGA_Mix_Mono(const mgfloat* src, mgint frames, const mgfloat gains[2], const mgfloat steps[2], mgfloat* bus);
+
+/// <summary>
+/// Adds stereo frames to the stereo bus.
+/// </summary>
+/// <remarks>
+/// The gains are left from left, left from right, right from left
+/// and right from right and move by the steps every frame.
+/// </remarks>
+void MGA_Mix_Stereo(const mgfloat* src, mgint frames, const mgfloat gains[4], const mgfloat steps[4], mgfloat* bus);
+
+/// <summary>
+/// Clamps the bus to -1 to 1.
+/// </summary>
+void MGA_Mix_Clamp(mgfloat* bus, mgint count);
+
+/// <summary>
+/// Works out the pan, distance attenuation and doppler
+/// ratio of each emitter as heard by the listener.
+/// </summary>
+/// <remarks>
+/// The distance scale is where sounds start to get quieter, zero
+/// to never attenuate.  The outputs have one value per emitter.
+/// </remarks>
+void MGA_Mix_Spatialize(const Listener& listener, const Emitter* emitters, mgint count, mgfloat distanceScale, mgfloat* pans, mgfloat* attenuations, mgfloat* dopplers);
+
+
+/// <summary>
+/// Audio decoded to 16bit PCM for the mixer.
+/// </summary>
+struct MGA_Wave
+{
+	std::vector<mgshort> pcm;
+	mgint channels = 0;
+	mgint sampleRate = 0;
+};
+
+/// <summary>
+/// Decodes PCM, float or ADPCM data described by a WAVEFORMATEX header.
+/// </summary>
+bool MGA_Wave_DecodeFormat(MGA_Wave& wave, const mgbyte* header, const mgbyte* data, mgint length);
+
+// These decode into a wave with the channels already set.
+
+/// <summary>
+/// Decodes 8, 16, 24 or 32bit integer PCM.
+/// </summary>
+bool MGA_Wave_DecodePCM(MGA_Wave& wave, const mgbyte* data, mgint length, mgint sampleBits);
+
+/// <summary>
+/// Decodes Microsoft ADPCM.
+/// </summary>
+bool MGA_Wave_DecodeMSADPCM(MGA_Wave& wave, const mgbyte* data, mgint length, mgint blockAlign);
+
+/// <summary>
+/// Decodes IMA ADPCM.
+/// </summary>
+bool MGA_Wave_DecodeIMAADPCM(MGA_Wave& wave, const mgbyte* data, mgint length, mgint blockAlign);
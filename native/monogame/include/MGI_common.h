@@ -0,0 +1,13 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#pragma once
+
+#include "mg_common.h"
+
+
+/// <summary>
+/// Applies the post-decode pixel transforms in a single SIMD pass over RGBA8 pixels.
+/// </summary>
+void MGI_ProcessPixels(mgbyte* pixels, mgint count, mgbyte zero, mgbyte premultiply, mgbyte swizzle);
@@ -4,7 +4,17 @@
 
 #include "mg_common.h"
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <vector>
+
 struct MGM_AudioDecoderInfo;
+struct MGM_PCMBlock;
+struct MGG_GraphicsDevice;
 struct MGG_Texture;
 
 
@@ -25,15 +35,114 @@ struct MGM_AudioDecoder
 /// </summary>
 struct MGM_VideoDecoder
 {
+	// The device frames are uploaded to, set before Initialize.
+	MGG_GraphicsDevice* device = nullptr;
+
 	virtual ~MGM_VideoDecoder() {}
 	virtual void Initialize(mgbyte* filepath, MGM_VideoDecoderInfo& info) = 0;
 	virtual MGM_AudioDecoder* GetAudioDecoder(MGM_AudioDecoderInfo& info) = 0;
 	virtual mgulong GetPosition() = 0;
 	virtual void SetLooped(mgbool looped) = 0;
+	virtual void SetPlanar(mgbool planar) = 0;
+	virtual void GetPlanes(MGG_Texture*& y, MGG_Texture*& u, MGG_Texture*& v) = 0;
 	virtual MGG_Texture* Decode() = 0;
 };
 
 
+/// <summary>
+/// A decoded frame waiting to be uploaded.
+/// </summary>
+struct MGM_VideoFrame
+{
+	// Either RGBA or the Y, U and V planes one after another.
+	std::vector<mgbyte> pixels;
+	bool planar;
+	mgulong clockMS;
+	mgulong positionMS;
+};
+
+/// <summary>
+/// The base for video decoders which decode ahead on a worker thread.
+/// </summary>
+/// <remarks>
+/// Frames go thru a fixed pool and are uploaded into a fixed ring of
+/// textures, so playback never allocates after it starts.  Decoders fill
+/// in the size and fps, call StartWorker at the end of Initialize and
+/// StopWorker first thing in their destructor.
+/// </remarks>
+struct MGM_VideoDecoder_Threaded : MGM_VideoDecoder
+{
+	mgint width = 0;
+	mgint height = 0;
+	mgint shiftX = 1;
+	mgint shiftY = 1;
+	mgint chromaWidth = 0;
+	mgint chromaHeight = 0;
+	mgfloat fps = 0;
+
+	~MGM_VideoDecoder_Threaded() override;
+
+	void StartWorker();
+	void StopWorker();
+
+	// Called on the worker to decode the next frame into the
+	// frame with WriteFrame, returns false at the end.
+	virtual bool DecodeFrame(MGM_VideoFrame* frame) = 0;
+
+	// Called on the worker to go back to the first frame.
+	virtual bool Rewind() = 0;
+
+	void WriteFrame(MGM_VideoFrame* frame, const mgbyte* y, mgint yStride, const mgbyte* u, mgint uStride, const mgbyte* v, mgint vStride);
+
+	// When not paced Decode waits for and returns every frame
+	// in order ignoring the clock, which is for benchmarking.
+	void SetPaced(bool paced);
+
+	mgulong GetPosition() override;
+	void SetLooped(mgbool looped) override;
+	void SetPlanar(mgbool planar) override;
+	void GetPlanes(MGG_Texture*& y, MGG_Texture*& u, MGG_Texture*& v) override;
+	MGG_Texture* Decode() override;
+
+private:
+
+	void Worker();
+	void Upload(MGM_VideoFrame* frame);
+	MGM_VideoFrame* NextFrame();
+	MGM_VideoFrame* DueFrame();
+	bool Finished();
+
+	// Everything here is shared with the worker.
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable produced;
+	std::vector<MGM_VideoFrame> frames;
+	std::vector<MGM_VideoFrame*> free;
+	std::deque<MGM_VideoFrame*> ready;
+	bool quit = false;
+	bool ended = false;
+	std::atomic<bool> looped { false };
+	std::atomic<bool> planar { false };
+
+	// The worker adds this to the frame times
+	// so the clock keeps going when looping.
+	mgulong loopMS = 0;
+	mgulong lastMS = 0;
+
+	// Only used by the thread calling Decode.
+	std::vector<MGG_Texture*> textures;
+	std::vector<MGG_Texture*> planes;
+	mgint nextTexture = 0;
+	MGG_Texture* current = nullptr;
+	MGG_Texture* currentPlanes[3] = {};
+	bool started = false;
+	bool paced = true;
+	mgulong clockMS = 0;
+	std::chrono::steady_clock::time_point lastDecode;
+	std::atomic<mgulong> position { 0 };
+};
+
 
 // This seems like enough to detect most file formats.
 #define MGM_SIGNATURE char signature[16]
@@ -45,6 +154,121 @@ struct MGM_VideoDecoder
 void MGM_ReadSignature(mgbyte* filepath, MGM_SIGNATURE);
 
 
+/// <summary>
+/// Converts planar BT.601 YUV to RGBA using SIMD across several threads.
+/// </summary>
+/// <remarks>
+/// The shifts are how much the chroma planes are subsampled, so 4:2:0 is 1, 1.
+/// </remarks>
+void MGM_YUV_ToRGBA(
+	const mgbyte* y, mgint yStride,
+	const mgbyte* u, mgint uStride,
+	const mgbyte* v, mgint vStride,
+	mgint shiftX, mgint shiftY,
+	mgint width, mgint height,
+	mgbyte* rgba);
+
+
+#define MGM_MP4_TYPE(a, b, c, d) (((mguint)(a) << 24) | ((mguint)(b) << 16) | ((mguint)(c) << 8) | (mguint)(d))
+
+struct MGM_Mp4Sample
+{
+	mglong offset;
+	mguint size;
+	bool sync;
+
+	// In the track timescale and in decode order.
+	mgulong time;
+};
+
+struct MGM_Mp4Track
+{
+	// The handler is 'vide' or 'soun' and the
+	// format is the first sample entry type.
+	mguint handler = 0;
+	mguint format = 0;
+
+	mguint timescale = 0;
+	mgulong duration = 0;
+
+	// Only set for audio tracks.
+	mgint channels = 0;
+	mgint samplerate = 0;
+
+	// The MPEG-4 object type from the esds box.
+	mgint objectType = 0;
+
+	// The avcC box of H.264 tracks.
+	std::vector<mgbyte> config;
+
+	std::vector<MGM_Mp4Sample> samples;
+};
+
+/// <summary>
+/// Reads the sample tables of every track in an MP4 or QuickTime file.
+/// </summary>
+/// <remarks>
+/// Tracks with broken tables or samples outside the file are left out.
+/// Fragmented files are not supported.
+/// </remarks>
+bool MGM_Mp4_ReadTracks(const mgbyte* data, mglong length, std::vector<MGM_Mp4Track>& tracks);
+
+/// <summary>
+/// Returns a decoder for an MP3 track from an MP4 file or null if it can't be decoded.
+/// </summary>
+/// <remarks>
+/// The file data must stay mapped for the life of the decoder.
+/// </remarks>
+MGM_AudioDecoder* MGM_AudioDecoder_CreateMp4Mp3(const mgbyte* data, const MGM_Mp4Track& track, MGM_AudioDecoderInfo& info);
+
+
+struct MGM_SeekPoint
+{
+	mgulong sample;
+	mglong offset;
+};
+
+/// <summary>
+/// A sparse table of sample positions to byte offsets in a compressed file.
+/// </summary>
+/// <remarks>
+/// Decoders build it when first opening a file and it is saved to a sidecar
+/// file, so later opens can skip scanning the file.  Seeks then only need to
+/// decode from the point before the target.
+/// </remarks>
+struct MGM_SeekIndex
+{
+	mgint channels = 0;
+	mgint samplerate = 0;
+	mgulong samples = 0;
+
+	// The minimum samples between points.
+	mgulong spacing = 4096;
+
+	std::vector<MGM_SeekPoint> points;
+
+	// Called in order with the start of every frame.
+	void Add(mgulong sample, mglong offset);
+
+	// Returns the last point at or before the sample.
+	MGM_SeekPoint Find(mgulong sample) const;
+
+	// The data is the whole file which is used to check
+	// the sidecar was built from the same file.  Load checks
+	// the cache directory then next to the file, Save only
+	// writes when a cache directory is set.
+	bool Load(mgbyte* filepath, const mgbyte* data, mglong length);
+	bool LoadPath(const char* path, const mgbyte* data, mglong length);
+	void Save(mgbyte* filepath, const mgbyte* data, mglong length) const;
+};
+
+
+/// <summary>
+/// Adds a reference to a cached PCM block, released with MGM_PCMCache_Release.
+/// </summary>
+void MGM_PCMBlock_AddRef(MGM_PCMBlock* block, MGM_AudioDecoderInfo& info);
+
+
 // These are the common decoders supported on all platforms.
 // They all work via optimized software decoding.
 
@@ -0,0 +1,52 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#pragma once
+
+#include "mg_common.h"
+
+struct MG_Asset;
+
+
+/// <summary>
+/// Returns the file which holds the asset data and where the asset starts within it.
+/// This is null for compressed assets which must be read with MG_Asset_ReadAt.
+/// </summary>
+FILE* MG_Asset_GetFile(MG_Asset* handle, mglong& base, mglong& length);
+
+/// <summary>
+/// Reads from an absolute offset without moving the asset position, safe from any thread.
+/// </summary>
+mglong MG_Asset_ReadAt(MG_Asset* handle, mglong offset, mgbyte* buffer, mglong count);
+
+/// <summary>
+/// Like MG_Asset_Map, but compressed assets are decompressed whole.
+/// This is for decoders which need all of the asset in memory.
+/// </summary>
+mgbool MG_Asset_Load(MG_Asset* handle, mgbyte*& data);
+
+/// <summary>
+/// Reads the bytes as stored on disk, ignoring any compression, safe from any thread.
+/// </summary>
+mglong MG_Asset_ReadRaw(MG_Asset* handle, mglong offset, mgbyte* buffer, mglong count);
+
+
+struct MG_AssetChunks;
+
+/// <summary>
+/// Returns the chunk table when the stored asset is chunk compressed, else null.
+/// </summary>
+MG_AssetChunks* MG_AssetChunks_Open(MG_Asset* handle, mglong rawLength);
+
+void MG_AssetChunks_Destroy(MG_AssetChunks* chunks);
+
+/// <summary>
+/// Returns the decompressed length of the asset.
+/// </summary>
+mglong MG_AssetChunks_GetLength(MG_AssetChunks* chunks);
+
+/// <summary>
+/// Decompresses only the chunks overlapping the range, safe from any thread.
+/// </summary>
+mglong MG_AssetChunks_ReadAt(MG_AssetChunks* chunks, MG_Asset* handle, mglong offset, mgbyte* buffer, mglong count);
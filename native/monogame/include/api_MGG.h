@@ -23,6 +23,8 @@ struct MGG_Texture;
 struct MGG_SamplerState;
 struct MGG_Shader;
 struct MGG_InputLayout;
+struct MGG_Readback;
+struct MGG_Capture;
 struct MGG_OcclusionQuery;
 
 MG_EXPORT void MGG_EffectResource_GetBytecode(mgbyte* name, mgbyte*& bytecode, mgint& size);
@@ -71,6 +73,17 @@ MG_EXPORT MGG_Texture* MGG_RenderTarget_Create(MGG_GraphicsDevice* device, MGTex
 MG_EXPORT void MGG_Texture_Destroy(MGG_GraphicsDevice* device, MGG_Texture* texture);
 MG_EXPORT void MGG_Texture_SetData(MGG_GraphicsDevice* device, MGG_Texture* texture, mgint level, mgint slice, mgint x, mgint y, mgint z, mgint width, mgint height, mgint depth, mgbyte* data, mgint dataBytes);
 MG_EXPORT void MGG_Texture_GetData(MGG_GraphicsDevice* device, MGG_Texture* texture, mgint level, mgint slice, mgint x, mgint y, mgint z, mgint width, mgint height, mgint depth, mgbyte* data, mgint dataBytes);
+MG_EXPORT MGG_Readback* MGG_Readback_Create(MGG_GraphicsDevice* device, mgint dataBytes);
+MG_EXPORT void MGG_Readback_Destroy(MGG_GraphicsDevice* device, MGG_Readback* readback);
+MG_EXPORT void MGG_Readback_Queue(MGG_GraphicsDevice* device, MGG_Readback* readback, MGG_Texture* texture, mgint level, mgint slice, mgint x, mgint y, mgint width, mgint height);
+MG_EXPORT mgbyte MGG_Readback_GetData(MGG_GraphicsDevice* device, MGG_Readback* readback, mgbyte*& data, mgint& dataBytes, MGSurfaceFormat& format);
+MG_EXPORT MGG_Capture* MGG_Capture_Create(MGG_GraphicsDevice* device, MGCaptureFormat format, mgint quality, mgint maxPending);
+MG_EXPORT void MGG_Capture_Destroy(MGG_Capture* capture);
+MG_EXPORT void MGG_Capture_Request(MGG_Capture* capture, const char* path);
+MG_EXPORT void MGG_Capture_SetPeriodic(MGG_Capture* capture, mgfloat fps, const char* pathPattern);
+MG_EXPORT void MGG_Capture_Update(MGG_Capture* capture, MGG_Texture* texture, mgint width, mgint height, mgulong timeMS);
+MG_EXPORT mgbyte MGG_Capture_Poll(MGG_Capture* capture, MGG_Capture_Result& result);
+MG_EXPORT mgint MGG_Capture_GetDroppedCount(MGG_Capture* capture);
 MG_EXPORT MGG_InputLayout* MGG_InputLayout_Create(MGG_GraphicsDevice* device, MGG_Shader* vertexShader, mgint* strides, mgint streamCount, MGG_InputElement* elements, mgint elementCount);
 MG_EXPORT void MGG_InputLayout_Destroy(MGG_GraphicsDevice* device, MGG_InputLayout* layout);
 MG_EXPORT MGG_Shader* MGG_Shader_Create(MGG_GraphicsDevice* device, MGShaderStage stage, mgbyte* bytecode, mgint sizeInBytes);
@@ -12,7 +12,14 @@
 #include "api_structs.h"
 
 
+struct MGI_Encoder;
 
-MG_EXPORT void MGI_ReadRGBA(mgbyte* data, mgint dataBytes, mgbyte zeroTransparentPixels, mgint& width, mgint& height, mgbyte*& rgba);
+MG_EXPORT void MGI_ReadRGBA(mgbyte* data, mgint dataBytes, MGImageReadFlags flags, mgint& width, mgint& height, mgbyte*& rgba);
+MG_EXPORT void MGI_ReadRGBAScaled(mgbyte* data, mgint dataBytes, MGImageReadFlags flags, mgint scale, mgint& width, mgint& height, mgbyte*& rgba);
+MG_EXPORT mgbyte MGI_ReadContainer(mgbyte* data, mgint dataBytes, MGI_ContainerInfo& info, MGI_ContainerLevel* levels, mgint levelCount);
 MG_EXPORT void MGI_WriteJpg(mgbyte* data, mgint dataBytes, mgint width, mgint height, mgint quality, mgbyte*& jpg, mgint& jpgBytes);
 MG_EXPORT void MGI_WritePng(mgbyte* data, mgint dataBytes, mgint width, mgint height, mgbyte*& png, mgint& pngBytes);
+MG_EXPORT MGI_Encoder* MGI_Encoder_Create();
+MG_EXPORT void MGI_Encoder_Destroy(MGI_Encoder* encoder);
+MG_EXPORT void MGI_Encoder_WriteJpg(MGI_Encoder* encoder, mgbyte* data, mgint dataBytes, mgint width, mgint height, mgint quality, mgbyte*& jpg, mgint& jpgBytes);
+MG_EXPORT void MGI_Encoder_WritePng(MGI_Encoder* encoder, mgbyte* data, mgint dataBytes, mgint width, mgint height, mgbyte*& png, mgint& pngBytes);
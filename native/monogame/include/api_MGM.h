@@ -13,6 +13,8 @@
 
 
 struct MGM_AudioDecoder;
+struct MGM_AudioStream;
+struct MGM_PCMBlock;
 struct MGM_VideoDecoder;
 struct MGG_GraphicsDevice;
 struct MGG_Texture;
@@ -21,9 +23,27 @@ MG_EXPORT MGM_AudioDecoder* MGM_AudioDecoder_Create(mgbyte* filepath, MGM_AudioD
 MG_EXPORT void MGM_AudioDecoder_Destroy(MGM_AudioDecoder* decoder);
 MG_EXPORT void MGM_AudioDecoder_SetPosition(MGM_AudioDecoder* decoder, mgulong timeMS);
 MG_EXPORT mgbyte MGM_AudioDecoder_Decode(MGM_AudioDecoder* decoder, mgbyte*& buffer, mguint& size);
+MG_EXPORT MGM_AudioStream* MGM_AudioStream_Create(MGM_AudioDecoder* decoder, mgint samplerate, mgint channels, mgint latencyMS);
+MG_EXPORT void MGM_AudioStream_Destroy(MGM_AudioStream* stream);
+MG_EXPORT void MGM_AudioStream_Seek(MGM_AudioStream* stream, mgulong timeMS);
+MG_EXPORT mgbyte MGM_AudioStream_Acquire(MGM_AudioStream* stream, mgbyte*& buffer, mguint& size);
+MG_EXPORT void MGM_AudioStream_Release(MGM_AudioStream* stream, mguint size);
+MG_EXPORT mgbyte MGM_AudioStream_IsFinished(MGM_AudioStream* stream);
+MG_EXPORT void MGM_AudioStream_Starved(MGM_AudioStream* stream);
+MG_EXPORT mgint MGM_AudioStream_GetUnderruns(MGM_AudioStream* stream);
+MG_EXPORT void MGM_SeekIndex_SetCacheDirectory(mgbyte* directory);
+MG_EXPORT MGM_PCMBlock* MGM_PCMCache_Acquire(mgbyte* filepath, MGM_AudioDecoderInfo& info);
+MG_EXPORT void MGM_PCMCache_Release(MGM_PCMBlock* block);
+MG_EXPORT void MGM_PCMBlock_GetData(MGM_PCMBlock* block, mgbyte*& data, mguint& size);
+MG_EXPORT mgbyte MGM_PCMCache_Prefetch(mgbyte* filepath);
+MG_EXPORT mgbyte MGM_PCMCache_SetPinned(mgbyte* filepath, mgbyte pinned);
+MG_EXPORT void MGM_PCMCache_SetBudget(mgulong bytes);
+MG_EXPORT void MGM_PCMCache_GetStats(mgulong& bytes, mgulong& hits, mgulong& misses);
 MG_EXPORT MGM_VideoDecoder* MGM_VideoDecoder_Create(MGG_GraphicsDevice* device, mgbyte* filepath, MGM_VideoDecoderInfo& info);
 MG_EXPORT void MGM_VideoDecoder_Destroy(MGM_VideoDecoder* decoder);
 MG_EXPORT MGM_AudioDecoder* MGM_VideoDecoder_GetAudioDecoder(MGM_VideoDecoder* decoder, MGM_AudioDecoderInfo& info);
 MG_EXPORT mgulong MGM_VideoDecoder_GetPosition(MGM_VideoDecoder* decoder);
 MG_EXPORT void MGM_VideoDecoder_SetLooped(MGM_VideoDecoder* decoder, mgbyte looped);
+MG_EXPORT void MGM_VideoDecoder_SetPlanar(MGM_VideoDecoder* decoder, mgbyte planar);
+MG_EXPORT void MGM_VideoDecoder_GetPlanes(MGM_VideoDecoder* decoder, MGG_Texture*& y, MGG_Texture*& u, MGG_Texture*& v);
 MG_EXPORT MGG_Texture* MGM_VideoDecoder_Decode(MGM_VideoDecoder* decoder);
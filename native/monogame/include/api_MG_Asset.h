@@ -11,8 +11,99 @@
 #include "api_enums.h"
 
 struct MG_Asset;
+struct MG_AssetReader;
+struct MG_AssetScheduler;
 
+enum class MGAssetPriority : mgint
+{
+    Critical = 0,
+    High = 1,
+    Normal = 2,
+    Background = 3,
+};
+
+enum class MGAssetStatus : mgint
+{
+    Completed = 0,
+    Failed = 1,
+    Cancelled = 2,
+};
+
+struct MG_AssetRead
+{
+    MG_Asset* Asset;
+    mglong Offset;
+    mgbyte* Buffer;
+    mgint Length;
+    mgulong UserData;
+};
+
+struct MG_AssetReadResult
+{
+    mgulong UserData;
+    mgint BytesRead;
+};
+
+struct MG_AssetRequest
+{
+    MG_Asset* Asset;
+    mglong Offset;
+    mgbyte* Buffer;
+    mglong Length;
+    mgulong UserData;
+    MGAssetPriority Priority;
+    mgint DeadlineMS;
+};
+
+struct MG_AssetRequestResult
+{
+    mgulong UserData;
+    mglong BytesRead;
+    MGAssetStatus Status;
+    mgbool Late;
+};
+
+struct MG_AssetStats
+{
+    mglong Opens;
+    mglong FailedOpens;
+    mglong Reads;
+    mglong BytesRead;
+    mglong Seeks;
+    mglong Maps;
+    mglong OpenTimeNS;
+    mglong ReadTimeNS;
+    mglong ReadHistogram[16];
+};
+
+struct MG_AssetPathStats
+{
+    const char* Path;
+    MG_AssetStats Stats;
+};
+
+MG_EXPORT mgbool MG_Asset_Mount (const char* packPath, const char* mountPoint);
 MG_EXPORT mgbool MG_Asset_Open (const char* path, MG_Asset*& handle, mglong& length);
 MG_EXPORT mgint MG_Asset_Read (MG_Asset* handle,  mgbyte* buffer, mglong count);
 MG_EXPORT mglong MG_Asset_Seek (MG_Asset* handle, mglong offset, mgint whence);
-MG_EXPORT void MG_Asset_Close (MG_Asset* handle);
\ No newline at end of file
+MG_EXPORT mgbool MG_Asset_Map (MG_Asset* handle, mgbyte*& data);
+MG_EXPORT void MG_Asset_Unmap (MG_Asset* handle);
+MG_EXPORT void MG_Asset_Close (MG_Asset* handle);
+MG_EXPORT void MG_Asset_SetStatsEnabled (mgbool enabled, const char* dumpPath);
+MG_EXPORT void MG_Asset_GetStats (MG_AssetStats& stats);
+MG_EXPORT mgint MG_Asset_GetPathStats (MG_AssetPathStats* stats, mgint maxStats);
+MG_EXPORT void MG_Asset_ResetStats ();
+MG_EXPORT mgbool MG_Asset_WriteStats (const char* path);
+MG_EXPORT MG_AssetReader* MG_AssetReader_Create (mgint maxInFlight);
+MG_EXPORT void MG_AssetReader_Destroy (MG_AssetReader* reader);
+MG_EXPORT void MG_AssetReader_Submit (MG_AssetReader* reader, MG_AssetRead* reads, mgint count);
+MG_EXPORT mgint MG_AssetReader_Poll (MG_AssetReader* reader, MG_AssetReadResult* results, mgint maxResults);
+MG_EXPORT mgint MG_AssetReader_Wait (MG_AssetReader* reader, MG_AssetReadResult* results, mgint maxResults);
+MG_EXPORT MG_AssetScheduler* MG_AssetScheduler_Create (mgint workers);
+MG_EXPORT void MG_AssetScheduler_Destroy (MG_AssetScheduler* scheduler);
+MG_EXPORT void MG_AssetScheduler_SetBackgroundBandwidth (MG_AssetScheduler* scheduler, mglong bytesPerSecond);
+MG_EXPORT mgulong MG_AssetScheduler_Submit (MG_AssetScheduler* scheduler, MG_AssetRequest& request);
+MG_EXPORT mgbool MG_AssetScheduler_SetPriority (MG_AssetScheduler* scheduler, mgulong id, MGAssetPriority priority);
+MG_EXPORT mgbool MG_AssetScheduler_Cancel (MG_AssetScheduler* scheduler, mgulong id);
+MG_EXPORT mgint MG_AssetScheduler_Poll (MG_AssetScheduler* scheduler, MG_AssetRequestResult* results, mgint maxResults);
+MG_EXPORT mgint MG_AssetScheduler_Wait (MG_AssetScheduler* scheduler, MG_AssetRequestResult* results, mgint maxResults);
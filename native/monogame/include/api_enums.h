@@ -228,6 +228,12 @@ enum class MGRenderTargetUsage : mgint
     PlatformContents = 2,
 };
 
+enum class MGCaptureFormat : mgint
+{
+    Png = 0,
+    Jpg = 1,
+};
+
 enum class MGVertexElementUsage : mgint
 {
     Position = 0,
@@ -261,6 +267,14 @@ enum class MGVertexElementFormat : mgint
     HalfVector4 = 11,
 };
 
+enum class MGImageReadFlags : mgbyte
+{
+    None = 0,
+    ZeroTransparentPixels = 1,
+    PremultiplyAlpha = 2,
+    SwizzleBGRA = 4,
+};
+
 enum class MGGameRunBehavior : mgint
 {
     Asynchronous = 0,
@@ -147,6 +147,17 @@ struct MGG_SamplerState_Info
     MGCompareFunction ComparisonFunction;
 };
 
+struct MGG_Capture_Result
+{
+    mgulong Sequence;
+    mgulong TimeMS;
+    mgint Width;
+    mgint Height;
+    mgbyte* Data;
+    mgint DataBytes;
+    mgbyte Succeeded;
+};
+
 struct MGG_InputElement
 {
     MGVertexElementUsage SemanticUsage;
@@ -157,6 +168,29 @@ struct MGG_InputElement
     mguint InstanceDataStepRate;
 };
 
+struct MGI_ContainerInfo
+{
+    MGTextureType Type;
+    MGSurfaceFormat Format;
+    mgint Width;
+    mgint Height;
+    mgint Depth;
+    mgint Mipmaps;
+    mgint Slices;
+};
+
+struct MGI_ContainerLevel
+{
+    mgint Level;
+    mgint Slice;
+    mgint Width;
+    mgint Height;
+    mgint Depth;
+    mgint Offset;
+    mgbyte* Data;
+    mgint DataBytes;
+};
+
 struct MGM_AudioDecoderInfo
 {
     mgint samplerate;
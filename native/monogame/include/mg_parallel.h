@@ -0,0 +1,20 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#pragma once
+
+#include "mg_common.h"
+
+
+/// <summary>
+/// Calls the work once for each index from 0 to count, spread across
+/// a shared pool of worker threads and the calling thread.  Returns
+/// once all the work is done.
+/// </summary>
+/// <remarks>
+/// The workers are started the first time they are needed and are
+/// kept for the life of the process.  If another thread is already
+/// using the pool the work is all done on the calling thread.
+/// </remarks>
+void MG_ParallelFor(mgint count, const std::function<void(mgint)>& work);
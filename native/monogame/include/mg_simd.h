@@ -0,0 +1,66 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#pragma once
+
+// Detect the SIMD instruction sets we can rely on at compile time.
+//
+// SSE2 is part of the x64 baseline and NEON is part of the ARM64
+// baseline, so those are always used when available.  AVX2 is not
+// guaranteed and must be checked at runtime with MG_CPU_HasAVX2().
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define MG_SIMD_SSE2
+#include <emmintrin.h>
+#include <immintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__) || defined(__ARM_NEON)
+#define MG_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(MG_SIMD_SSE2)
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define MG_TARGET_AVX2
+#else
+#define MG_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+inline bool MG_CPU_DetectAVX2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	// The OS must have enabled the AVX register state.
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+		return false;
+	if ((_xgetbv(0) & 0x6) != 0x6)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+inline bool MG_CPU_HasAVX2()
+{
+	static const bool hasAVX2 = MG_CPU_DetectAVX2();
+	return hasAVX2;
+}
+
+#else
+
+inline bool MG_CPU_HasAVX2()
+{
+	return false;
+}
+
+#endif
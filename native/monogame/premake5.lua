@@ -2,6 +2,24 @@
 -- This file is subject to the terms and conditions defined in
 -- file 'LICENSE.txt', which is part of this source code package.
 
+newoption
+{
+   trigger = "with-libjpeg-turbo",
+   description = "Decode JPEG images with libjpeg-turbo instead of stb_image."
+}
+
+newoption
+{
+   trigger = "with-libspng",
+   description = "Decode PNG images with libspng instead of stb_image."
+}
+
+newoption
+{
+   trigger = "with-theora",
+   description = "Play Theora video using libtheora and libogg."
+}
+
 function common(project_name)
 
    platform_target_path = "../../Artifacts/monogame.native/%{cfg.system}/" .. project_name .. "/%{cfg.buildcfg}"
@@ -23,9 +41,47 @@ function common(project_name)
    includedirs 
    {
       "include",
+   }
+
+   images()
+   decoders()
+
+end
+
+-- The optional image decoders shared by the library and mgicompare.
+function images()
+
+   filter "options:with-libjpeg-turbo"
+      defines { "MG_LIBJPEG_TURBO" }
+      links { "turbojpeg" }
+
+   filter "options:with-libspng"
+      defines { "MG_LIBSPNG" }
+      links { "spng" }
+
+   filter {}
+
+end
+
+-- The media decoders shared by the library and the bench.
+function decoders()
+
+   includedirs 
+   {
       "../../external/stb",
+      "../../external/minimp3",
    }
 
+   filter "options:with-theora"
+      defines { "MG_THEORA" }
+      links { "theoradec", "ogg" }
+
+   -- OpenH264 is loaded at runtime if it is installed.
+   filter "system:linux"
+      links { "dl" }
+
+   filter {}
+
 end
 
 -- SDL is supported on all desktop platforms.
@@ -172,3 +228,54 @@ project "windowsdx"
    directx12()
    xaudio()
    configs()
+
+
+-- A headless tool that benchmarks and checks the media
+-- decoders against a corpus, see bench/make_corpus.sh.
+project "mgmbench"
+   kind "ConsoleApp"
+   language "C++"
+   architecture "x64"
+   cppdialect "C++17"
+   defines { "DLL_EXPORT" }
+   targetdir "../../Artifacts/monogame.native/%{cfg.system}/mgmbench/%{cfg.buildcfg}"
+
+   files
+   {
+      "bench/mgm_bench.cpp",
+      "common/MGM*.cpp",
+      "common/MG_Asset*.cpp",
+      "common/mg_hash.cpp",
+      "common/mg_parallel.cpp",
+   }
+   includedirs
+   {
+      "include",
+   }
+
+   decoders()
+   configs()
+
+-- Checks the optional image decoders against stb_image,
+-- build it with the same options as the library.
+project "mgicompare"
+   kind "ConsoleApp"
+   language "C++"
+   architecture "x64"
+   cppdialect "C++17"
+   defines { "DLL_EXPORT" }
+   targetdir "../../Artifacts/monogame.native/%{cfg.system}/mgicompare/%{cfg.buildcfg}"
+
+   files
+   {
+      "bench/mgi_compare.cpp",
+      "common/MGI.cpp",
+   }
+   includedirs
+   {
+      "include",
+      "../../external/stb",
+   }
+
+   images()
+   configs()
@@ -0,0 +1,72 @@
+// MonoGame - Copyright (C) The MonoGame Team
+// This file is subject to the terms and conditions defined in
+// file 'LICENSE.txt', which is part of this source code package.
+
+#include "MGA_common.h"
+
+#include <sdl.h>
+
+
+// Small enough to keep the latency around 10ms.
+static const mgint MGA_SDL_PeriodFrames = 512;
+
+struct MGA_Sink_SDL : MGA_Sink
+{
+	SDL_AudioDeviceID device = 0;
+	MGA_RenderCallback render = nullptr;
+	void* data = nullptr;
+
+	~MGA_Sink_SDL() override
+	{
+		// This waits for the callback to return.
+		if (device != 0)
+			SDL_CloseAudioDevice(device);
+
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+	}
+
+	void Start(MGA_RenderCallback callback, void* userdata) override
+	{
+		render = callback;
+		data = userdata;
+		SDL_PauseAudioDevice(device, 0);
+	}
+};
+
+static void SDLCALL MGA_SDL_Callback(void* userdata, Uint8* stream, int len)
+{
+	auto sink = (MGA_Sink_SDL*)userdata;
+	auto frames = len / (MGA_OUTPUT_CHANNELS * sizeof(mgfloat));
+	sink->render(sink->data, (mgfloat*)stream, (mgint)frames);
+}
+
+
+MGA_Sink* MGA_Sink_CreateSDL()
+{
+	if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0)
+		return nullptr;
+
+	auto sink = new MGA_Sink_SDL();
+
+	// The mixer works in float at whatever rate
+	// the device likes, so SDL never converts.
+	SDL_AudioSpec want;
+	SDL_zero(want);
+	want.freq = sink->sampleRate;
+	want.format = AUDIO_F32SYS;
+	want.channels = MGA_OUTPUT_CHANNELS;
+	want.samples = MGA_SDL_PeriodFrames;
+	want.callback = MGA_SDL_Callback;
+	want.userdata = sink;
+
+	SDL_AudioSpec have;
+	sink->device = SDL_OpenAudioDevice(nullptr, 0, &want, &have, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+	if (sink->device == 0)
+	{
+		delete sink;
+		return nullptr;
+	}
+
+	sink->sampleRate = have.freq;
+	return sink;
+}
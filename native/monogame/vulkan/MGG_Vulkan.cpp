@@ -372,6 +372,18 @@ struct MGG_OcclusionQuery
 	// TODO!
 };
 
+struct MGG_Readback
+{
+	FrameCounter frame = 0;
+	bool queued = false;
+
+	MGSurfaceFormat format = MGSurfaceFormat::Color;
+	mgint dataBytes = 0;
+	mgint copiedBytes = 0;
+
+	MGG_Buffer* buffer = nullptr;
+};
+
 struct MGG_GraphicsSystem
 {
 	VkInstance instance;
@@ -839,7 +851,7 @@ static MGG_Texture* CreateDepthTexture(MGG_GraphicsDevice* device, VkFormat form
 	return texture;
 }
 
-static VkImageView CreateImageView(MGG_GraphicsDevice* device, MGG_Texture* texture, uint32_t level_count)
+static VkImageView CreateImageView(MGG_GraphicsDevice* device, MGG_Texture* texture, uint32_t level_count, bool sampled)
 {
 	VkFormat format = texture->info.format;
 	uint32_t layer_count = texture->info.arrayLayers;
@@ -856,6 +868,17 @@ static VkImageView CreateImageView(MGG_GraphicsDevice* device, MGG_Texture* text
 	image_view_create_info.subresourceRange.baseArrayLayer = 0;
 	image_view_create_info.subresourceRange.layerCount = layer_count;
 
+	// Alpha8 is stored as R8, so shaders sampling it need the
+	// value in alpha like the other backends.  Render target
+	// views must keep the identity swizzle.
+	if (sampled && texture->format == MGSurfaceFormat::Alpha8)
+	{
+		image_view_create_info.components.r = VK_COMPONENT_SWIZZLE_ZERO;
+		image_view_create_info.components.g = VK_COMPONENT_SWIZZLE_ZERO;
+		image_view_create_info.components.b = VK_COMPONENT_SWIZZLE_ZERO;
+		image_view_create_info.components.a = VK_COMPONENT_SWIZZLE_R;
+	}
+
 	VkImageView view;
 	VkResult res = vkCreateImageView(device->device, &image_view_create_info, NULL, &view);
 	VK_CHECK_RESULT(res);
@@ -1345,7 +1368,7 @@ void MGVK_RecreateSwapChain(
 	create_info.imageColorSpace = VK_COLORSPACE_SRGB_NONLINEAR_KHR;
 	create_info.imageExtent = extent;
 	create_info.imageArrayLayers = 1;
-	create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 	create_info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
 	create_info.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
 	create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
@@ -1387,12 +1410,12 @@ void MGVK_RecreateSwapChain(
 		texture->image = swapchainImages[i];
 		texture->isSwapchain = texture->isTarget = true;
 
-		texture->target_view = CreateImageView(device, texture, 1);
+		texture->target_view = CreateImageView(device, texture, 1, false);
 
 		if (device->depthFormat != VK_FORMAT_UNDEFINED)
 		{
 			texture->depthTexture = CreateDepthTexture(device, device->depthFormat, texture->info.extent.width, texture->info.extent.height);
-			texture->depthTexture->target_view = CreateImageView(device, texture->depthTexture, 1);
+			texture->depthTexture->target_view = CreateImageView(device, texture->depthTexture, 1, false);
 		}
 
 		device->frames[i].swapchainTexture = texture;
@@ -3415,7 +3438,7 @@ MGG_Texture* MGG_Texture_Create(
 	
 	mggCreateImage(device, &create_info, texture);
 
-	texture->view = CreateImageView(device, texture, mipmaps);
+	texture->view = CreateImageView(device, texture, mipmaps, true);
 
 	texture->id = ++device->currentTextureId;
 
@@ -3475,8 +3498,8 @@ MGG_Texture* MGG_RenderTarget_Create(
 
 		mggCreateImage(device, &create_info, texture);
 
-		texture->view = CreateImageView(device, texture, mipmaps);
-		texture->target_view = CreateImageView(device, texture, 1);
+		texture->view = CreateImageView(device, texture, mipmaps, true);
+		texture->target_view = CreateImageView(device, texture, 1, false);
 
 		MGVK_TransitionImageLayout(device, texture, 0, texture->optimal_layout);
 	}
@@ -3484,7 +3507,7 @@ MGG_Texture* MGG_RenderTarget_Create(
 	if (depthFormat != MGDepthFormat::None)
 	{
 		texture->depthTexture = CreateDepthTexture(device, ToVkFormat(depthFormat), width, height);
-		texture->depthTexture->target_view = CreateImageView(device, texture->depthTexture, 1);
+		texture->depthTexture->target_view = CreateImageView(device, texture->depthTexture, 1, false);
 	}
 
 	texture->id = ++device->currentTextureId;
@@ -3728,6 +3751,173 @@ void MGG_Texture_GetData(MGG_GraphicsDevice* device, MGG_Texture* texture, mgint
 		MGVK_BeginFrame(cmd);
 }
 
+MGG_Readback* MGG_Readback_Create(MGG_GraphicsDevice* device, mgint dataBytes)
+{
+	assert(device != nullptr);
+	assert(dataBytes > 0);
+
+	auto readback = new MGG_Readback();
+	readback->dataBytes = dataBytes;
+
+	// The buffer stays mapped for its whole lifetime.
+	readback->buffer = new MGG_Buffer();
+	MGVK_BufferCreate(device, dataBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU, readback->buffer);
+	auto res = vmaMapMemory(device->allocator, readback->buffer->allocation, (void**)&readback->buffer->mapped);
+	VK_CHECK_RESULT(res);
+
+	return readback;
+}
+
+void MGG_Readback_Destroy(MGG_GraphicsDevice* device, MGG_Readback* readback)
+{
+	assert(device != nullptr);
+	assert(readback != nullptr);
+
+	vmaUnmapMemory(device->allocator, readback->buffer->allocation);
+	readback->buffer->mapped = nullptr;
+
+	// The copy could still be in flight, so let the
+	// frame cleanup release the buffer later.
+	readback->buffer->frame = device->frame;
+	device->destroyBuffers.push(readback->buffer);
+
+	delete readback;
+}
+
+void MGG_Readback_Queue(MGG_GraphicsDevice* device, MGG_Readback* readback, MGG_Texture* texture, mgint level, mgint slice, mgint x, mgint y, mgint width, mgint height)
+{
+	assert(device != nullptr);
+	assert(readback != nullptr);
+
+	const FrameCounter currentFrame = device->frame;
+	const FrameCounter frameIndex = currentFrame % kConcurrentFrameCount;
+	MGVK_FrameState& frame = device->frames[frameIndex];
+	MGVK_CmdBuffer& cmd = frame.commandBuffer;
+	assert(frame.is_recording);
+
+	// A null texture means the current backbuffer.
+	VkImageLayout layout;
+	if (texture == nullptr)
+	{
+		texture = frame.swapchainTexture;
+		layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+		switch (device->colorFormat)
+		{
+		case VK_FORMAT_B8G8R8A8_UNORM:
+			readback->format = MGSurfaceFormat::Bgra32;
+			break;
+		case VK_FORMAT_B8G8R8A8_SRGB:
+			readback->format = MGSurfaceFormat::Bgra32SRgb;
+			break;
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			readback->format = MGSurfaceFormat::ColorSRgb;
+			break;
+		default:
+			readback->format = MGSurfaceFormat::Color;
+			break;
+		}
+	}
+	else
+	{
+		layout = texture->layout;
+		readback->format = texture->format;
+	}
+
+	assert(texture != nullptr);
+	assert(level >= 0 && level < texture->info.mipLevels);
+	assert(slice >= 0 && slice < texture->info.arrayLayers);
+	assert(x >= 0 && x + width <= texture->info.extent.width);
+	assert(y >= 0 && y + height <= texture->info.extent.height);
+
+	// Copies are not allowed inside a render pass.  It will be
+	// restarted on the next draw, so this is best done after all
+	// drawing to the texture for this frame is finished.
+	if (device->inRenderPass)
+	{
+		vkCmdEndRenderPass(cmd.buffer);
+		device->inRenderPass = false;
+		device->renderTargetDirty = true;
+	}
+
+	VkImageMemoryBarrier barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+	barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	barrier.oldLayout = layout;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = texture->image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = level;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = slice;
+	barrier.subresourceRange.layerCount = 1;
+
+	vkCmdPipelineBarrier(cmd.buffer,
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &barrier);
+
+	VkBufferImageCopy region = {};
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = level;
+	region.imageSubresource.baseArrayLayer = slice;
+	region.imageSubresource.layerCount = 1;
+	region.imageOffset = { x, y, 0 };
+	region.imageExtent = { (uint32_t)width, (uint32_t)height, 1 };
+
+	vkCmdCopyImageToBuffer(cmd.buffer, texture->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback->buffer->buffer, 1, &region);
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barrier.newLayout = layout;
+
+	vkCmdPipelineBarrier(cmd.buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &barrier);
+
+	readback->frame = currentFrame;
+	readback->queued = true;
+	readback->copiedBytes = width * height * 4;
+	if (readback->copiedBytes > readback->dataBytes)
+		readback->copiedBytes = readback->dataBytes;
+}
+
+mgbyte MGG_Readback_GetData(MGG_GraphicsDevice* device, MGG_Readback* readback, mgbyte*& data, mgint& dataBytes, MGSurfaceFormat& format)
+{
+	assert(device != nullptr);
+	assert(readback != nullptr);
+
+	data = nullptr;
+	dataBytes = 0;
+	format = readback->format;
+
+	if (!readback->queued)
+		return false;
+
+	// The copy is part of the frame's command buffer so it
+	// isn't even submitted until that frame is presented.
+	auto elapsed = device->frame - readback->frame;
+	if (elapsed == 0)
+		return false;
+
+	// Once the frame slot has been reused its fence has been
+	// waited on, else we can just check the fence itself.
+	if (elapsed <= kConcurrentFrameCount)
+	{
+		auto& cmd = device->frames[readback->frame % kConcurrentFrameCount].commandBuffer;
+		if (vkGetFenceStatus(device->device, cmd.completedFence) != VK_SUCCESS)
+			return false;
+	}
+
+	vmaInvalidateAllocation(device->allocator, readback->buffer->allocation, 0, VK_WHOLE_SIZE);
+
+	data = readback->buffer->mapped;
+	dataBytes = readback->copiedBytes;
+	return true;
+}
+
 MGG_InputLayout* MGG_InputLayout_Create(
 	MGG_GraphicsDevice* device,
 	MGG_Shader* vertexShader,
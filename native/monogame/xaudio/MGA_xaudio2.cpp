@@ -3,8 +3,10 @@
 // file 'LICENSE.txt', which is part of this source code package.
 
 #include "api_MGA.h"
+#include "api_MGM.h"
 
 #include "mg_common.h"
+#include "MGM_common.h"
 
 #include <vector>
 
@@ -30,6 +32,10 @@ struct MGA_Buffer
 	XAUDIO2_BUFFER_WMA* wmaBuffer = nullptr;
 	uint8_t* data = nullptr;
 	uint32_t length = 0;
+
+	// Cached PCM is played in place instead of copied to data.
+	MGM_PCMBlock* block = nullptr;
+	MGM_AudioDecoderInfo blockInfo;
 };
 
 struct MGA_Voice
@@ -153,6 +159,23 @@ void MGA_System_SetReverbSettings(MGA_System* system, ReverbSettings& settings)
 	assert(err >= S_OK);
 }
 
+void MGA_System_SetVoiceBudget(MGA_System* system, mgint voices)
+{
+	assert(system != nullptr);
+
+	// XAudio2 mixes every voice itself.
+}
+
+void MGA_System_GetVoiceStats(MGA_System* system, mgint& playing, mgint& mixed)
+{
+	assert(system != nullptr);
+
+	XAUDIO2_PERFORMANCE_DATA data;
+	system->audio->GetPerformanceData(&data);
+	playing = data.ActiveSourceVoiceCount;
+	mixed = data.ActiveSourceVoiceCount;
+}
+
 MGA_Buffer* MGA_Buffer_Create(MGA_System* system)
 {
 	assert(system != nullptr);
@@ -167,6 +190,9 @@ void MGA_Buffer_Destroy(MGA_Buffer* buffer)
 	free(buffer->data);
 	free(buffer->format);
 
+	if (buffer->block)
+		MGM_PCMCache_Release(buffer->block);
+
 	if (buffer->wmaBuffer != nullptr)
 	{
 		free((void*)buffer->wmaBuffer->pDecodedPacketCumulativeBytes);
@@ -275,6 +301,41 @@ void MGA_Buffer_InitializePCM(MGA_Buffer* buffer, mgbyte* waveData, mgint offset
 	buffer->buffer.pContext = nullptr;
 }
 
+void MGA_Buffer_InitializeCached(MGA_Buffer* buffer, MGM_PCMBlock* block)
+{
+	assert(buffer != nullptr);
+	assert(block != nullptr);
+	assert(buffer->block == nullptr);
+
+	MGM_PCMBlock_AddRef(block, buffer->blockInfo);
+	buffer->block = block;
+
+	mgbyte* data;
+	mguint size;
+	MGM_PCMBlock_GetData(block, data, size);
+
+	auto& info = buffer->blockInfo;
+
+	auto format = (WAVEFORMATEX*)malloc(sizeof(WAVEFORMATEX));
+	memset(format, 0, sizeof(WAVEFORMATEX));
+	format->wFormatTag = WAVE_FORMAT_PCM;
+	format->nSamplesPerSec = info.samplerate;
+	format->nChannels = (WORD)info.channels;
+	format->nBlockAlign = (WORD)info.channels * 2;
+	format->wBitsPerSample = 16;
+	format->nAvgBytesPerSec = format->nSamplesPerSec * format->nBlockAlign;
+	format->cbSize = 0;
+	buffer->format = format;
+
+	// The block never changes while we hold a
+	// reference, so XAudio2 can read it directly.
+	buffer->length = size;
+
+	memset(&buffer->buffer, 0, sizeof(XAUDIO2_BUFFER));
+	buffer->buffer.pAudioData = data;
+	buffer->buffer.AudioBytes = size;
+}
+
 void MGA_Buffer_InitializeXact(MGA_Buffer* buffer, mguint codec, mgbyte* waveData, mgint length, mgint sampleRate, mgint blockAlignment, mgint channels, mgint loopStart, mgint loopLength)
 {
 	assert(buffer != nullptr);
@@ -628,6 +689,13 @@ void MGA_Voice_SetVolume(MGA_Voice* voice, mgfloat volume)
 	voice->voice->SetVolume(volume);
 }
 
+void MGA_Voice_SetPriority(MGA_Voice* voice, mgfloat priority)
+{
+	assert(voice != nullptr);
+
+	// XAudio2 mixes every voice itself.
+}
+
 void MGA_Voice_SetReverbMix(MGA_Voice* voice, mgfloat mix)
 {
 	assert(voice != nullptr);
@@ -764,3 +832,14 @@ void MGA_Voice_Apply3D(MGA_Voice* voice, Listener& listener, Emitter& emitter, m
 	voice->voice->SetFrequencyRatio(dsp.DopplerFactor);
 }
 
+
+void MGA_Voice_Apply3DBatch(MGA_Voice** voices, Emitter* emitters, mgint count, Listener& listener, mgfloat distanceScale)
+{
+	assert(voices != nullptr || count == 0);
+	assert(emitters != nullptr || count == 0);
+
+	// X3DAudio only works out one emitter at a time, but this
+	// still saves a call into native code for each voice.
+	for (mgint i = 0; i < count; i++)
+		MGA_Voice_Apply3D(voices[i], listener, emitters[i], distanceScale);
+}